@@ -0,0 +1,424 @@
+/****************************************************************************
+ Module
+   ADCScheduler.c
+
+ Description
+   Owns ADC0 so any module can sample analog inputs without blocking
+   conversions or setting the ADC up again. A module registers an input
+   (AIN number) with the rate it wants and gets a channel back, then reads
+   the latest reading or a block of unread readings from that channel's
+   ring whenever it likes.
+   Timer 2A triggers sample sequencer 0 ADC_TICK_RATE times a second, the
+   sequencer converts every registered input in turn, the ADC averages 16
+   conversions in hardware for each reading, and the uDMA moves the
+   readings into two buffers, ping-pong. Each time a buffer fills the ISR
+   hands its readings out to the channels' rings, averaging down to each
+   channel's rate.
+
+ Notes
+   ADCSchedISR must be installed as the ADC0 Sequence 0 handler in the
+   vector table of the startup file. It only runs when the uDMA has filled
+   a buffer (the sequencer's own interrupt stays masked), every
+   ADC_BUFFER_TICKS mS, so that is how old the latest reading can be.
+   Registering stops sampling for a moment to re-program the sequencer and
+   the uDMA, do it from Init functions. Inputs registered in the same Init
+   start on the same tick.
+   A ring's head is written only by the ISR and its tail only by the
+   reader. A reader that falls more than ADC_RING_SIZE readings behind
+   loses the oldest ones, they are counted as overruns.
+   This replaces the set up AccSampler (and ADMulti before it) did.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_adc.h"
+#include "inc/hw_timer.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/gpio.h"
+#include "driverlib/udma.h"
+
+#include "BITDEFS.H"
+#include "ADCScheduler.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define TICKS_PER_SEC 40000000  // the system clock
+
+// ticks of readings in each ping-pong buffer
+#define ADC_BUFFER_TICKS 8
+
+#define NUM_INPUTS   12             // AIN0 to AIN11
+
+#define SS0          BIT0HI         // sequencer 0 bit in ACTSS, ISC
+#define ADC0_INT_EN  BIT14HI        // ADC0 sequence 0 is interrupt 14, bit 14 of EN0
+
+#define EMUX_EM0_TIMER 0x0005       // start sequencer 0 on the timer trigger
+#define SAC_AVG_16X    0x4          // hardware average of 16 conversions
+
+#define RING_MASK (ADC_RING_SIZE - 1)
+
+#if (ADC_RING_SIZE & RING_MASK) != 0
+#error ADC_RING_SIZE must be a power of 2
+#endif
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct {
+	uint8_t Input;                  // AIN number
+	uint16_t Divider;               // ticks averaged into each reading
+	uint32_t Sum;                   // of the ticks so far, ISR only
+	uint16_t NumSummed;             // ticks in Sum, ISR only
+	uint16_t Ring[ADC_RING_SIZE];
+	volatile uint16_t Head;         // readings written, ISR only, wraps
+	volatile bool HasReading;       // set by the ISR after the first reading
+	uint16_t Tail;                  // readings taken, reader only
+	uint16_t Overruns;
+} ADCChannel_t;
+
+// where an analog input is
+typedef struct {
+	uint32_t PortBase;
+	uint8_t PortBit;                // bit in RCGCGPIO
+	uint8_t Pin;
+} InputPin_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void StartHardware ( void );
+static void Restart ( void );
+static void Arm ( uint8_t Half );
+static void Distribute ( const uint16_t *pBuffer );
+
+/*---------------------------- Module Variables ---------------------------*/
+static const InputPin_t InputPins[NUM_INPUTS] = {
+	{ GPIO_PORTE_BASE, BIT4HI, GPIO_PIN_3 },  // AIN0
+	{ GPIO_PORTE_BASE, BIT4HI, GPIO_PIN_2 },  // AIN1
+	{ GPIO_PORTE_BASE, BIT4HI, GPIO_PIN_1 },  // AIN2
+	{ GPIO_PORTE_BASE, BIT4HI, GPIO_PIN_0 },  // AIN3
+	{ GPIO_PORTD_BASE, BIT3HI, GPIO_PIN_3 },  // AIN4
+	{ GPIO_PORTD_BASE, BIT3HI, GPIO_PIN_2 },  // AIN5
+	{ GPIO_PORTD_BASE, BIT3HI, GPIO_PIN_1 },  // AIN6
+	{ GPIO_PORTD_BASE, BIT3HI, GPIO_PIN_0 },  // AIN7
+	{ GPIO_PORTE_BASE, BIT4HI, GPIO_PIN_5 },  // AIN8
+	{ GPIO_PORTE_BASE, BIT4HI, GPIO_PIN_4 },  // AIN9
+	{ GPIO_PORTB_BASE, BIT1HI, GPIO_PIN_4 },  // AIN10
+	{ GPIO_PORTB_BASE, BIT1HI, GPIO_PIN_5 }   // AIN11
+};
+
+// primary and alternate uDMA structure, for each half of the ping-pong
+static const uint32_t HalfSelect[2] = { UDMA_PRI_SELECT, UDMA_ALT_SELECT };
+
+static ADCChannel_t Channels[ADC_MAX_CHANNELS];
+static uint8_t NumChannels;
+static bool HardwareStarted = false;
+
+// the ping-pong buffers, a tick is one reading of each channel in turn
+static uint16_t Buffer[2][ADC_MAX_CHANNELS * ADC_BUFFER_TICKS];
+static uint8_t NextHalf;                // the half that fills next
+
+// the uDMA channel control table, it has to be 1024 byte aligned
+static uint8_t ControlTable[1024] __attribute__ ((aligned(1024)));
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ADCSched_Register
+
+ Parameters
+     uint8_t Input : the analog input, AIN0 to AIN11
+     uint16_t Rate : readings per second wanted, it has to divide
+                     ADC_TICK_RATE
+
+ Returns
+     uint8_t, the channel to read the input with, ADC_NO_CHANNEL if the
+     input or rate is bad or all the channels are taken
+
+ Description
+     Makes the input's pin analog and adds it to the sequence, each reading
+     on the channel is the average of ADC_TICK_RATE / Rate ticks
+****************************************************************************/
+uint8_t ADCSched_Register ( uint8_t Input, uint16_t Rate )
+{
+	const InputPin_t *pPin;
+	ADCChannel_t *pChannel;
+
+	if ( (Input >= NUM_INPUTS) || (NumChannels >= ADC_MAX_CHANNELS) ||
+	     (Rate == 0) || (Rate > ADC_TICK_RATE) || ((ADC_TICK_RATE % Rate) != 0) ) {
+		return ADC_NO_CHANNEL;
+	}
+	if ( !HardwareStarted ) {
+		StartHardware();
+	}
+
+	//the input's pin to analog
+	pPin = &InputPins[Input];
+	HWREG(SYSCTL_RCGCGPIO) |= pPin->PortBit;
+	while( (HWREG(SYSCTL_PRGPIO) & pPin->PortBit) != pPin->PortBit );
+	HWREG(pPin->PortBase+GPIO_O_DIR) &= ~pPin->Pin;
+	HWREG(pPin->PortBase+GPIO_O_AFSEL) |= pPin->Pin;
+	HWREG(pPin->PortBase+GPIO_O_DEN) &= ~pPin->Pin;
+	HWREG(pPin->PortBase+GPIO_O_AMSEL) |= pPin->Pin;
+
+	pChannel = &Channels[NumChannels];
+	pChannel->Input = Input;
+	pChannel->Divider = ADC_TICK_RATE / Rate;
+	pChannel->Sum = 0;
+	pChannel->NumSummed = 0;
+	pChannel->Head = 0;
+	pChannel->HasReading = false;
+	pChannel->Tail = 0;
+	pChannel->Overruns = 0;
+	NumChannels++;
+
+	Restart();
+	return NumChannels - 1;
+}
+
+/****************************************************************************
+ Function
+     ADCSched_ReadLatest
+
+ Returns
+     uint16_t, the newest reading on the channel, read or not (0 before the
+     first one)
+****************************************************************************/
+uint16_t ADCSched_ReadLatest ( uint8_t Channel )
+{
+	ADCChannel_t *pChannel = &Channels[Channel];
+	uint16_t Head;
+
+	//not Head == 0, Head wraps and is 0 again after every 65536 readings
+	if ( !pChannel->HasReading ) {
+		return 0;
+	}
+	Head = pChannel->Head;
+	return pChannel->Ring[(Head - 1) & RING_MASK];
+}
+
+/****************************************************************************
+ Function
+     ADCSched_QueryUnread
+
+ Returns
+     uint16_t, readings waiting on the channel, at most ADC_RING_SIZE
+****************************************************************************/
+uint16_t ADCSched_QueryUnread ( uint8_t Channel )
+{
+	ADCChannel_t *pChannel = &Channels[Channel];
+	uint16_t Unread = pChannel->Head - pChannel->Tail;
+
+	return ( Unread > ADC_RING_SIZE ) ? ADC_RING_SIZE : Unread;
+}
+
+/****************************************************************************
+ Function
+     ADCSched_ReadBlock
+
+ Parameters
+     uint8_t Channel : from ADCSched_Register
+     uint16_t *pDest : where the readings go
+     uint16_t Count : most readings to take
+
+ Returns
+     uint16_t, readings taken
+
+ Description
+     Takes the oldest unread readings on the channel, in order
+****************************************************************************/
+uint16_t ADCSched_ReadBlock ( uint8_t Channel, uint16_t *pDest, uint16_t Count )
+{
+	ADCChannel_t *pChannel = &Channels[Channel];
+	uint16_t Head = pChannel->Head;
+	uint16_t Unread = Head - pChannel->Tail;
+	uint16_t i;
+
+	//readings the ISR has already written over are gone
+	if ( Unread > ADC_RING_SIZE ) {
+		pChannel->Overruns += Unread - ADC_RING_SIZE;
+		pChannel->Tail = Head - ADC_RING_SIZE;
+		Unread = ADC_RING_SIZE;
+	}
+	if ( Count > Unread ) {
+		Count = Unread;
+	}
+	for ( i = 0; i < Count; i++ ) {
+		pDest[i] = pChannel->Ring[(pChannel->Tail + i) & RING_MASK];
+	}
+	pChannel->Tail += Count;
+	return Count;
+}
+
+/****************************************************************************
+ Function
+     ADCSched_QueryOverruns
+
+ Returns
+     uint16_t, readings on the channel written over before they were read
+****************************************************************************/
+uint16_t ADCSched_QueryOverruns ( uint8_t Channel )
+{
+	return Channels[Channel].Overruns;
+}
+
+/****************************************************************************
+ Function
+     ADCSchedISR
+
+ Description
+     ADC0 sequence 0 interrupt response, runs when the uDMA has filled a
+     buffer. Hands the buffer out to the rings and re-arms its half of the
+     ping-pong, in the order the halves fill.
+****************************************************************************/
+void ADCSchedISR ( void )
+{
+	HWREG(ADC0_BASE+ADC_O_ISC) = SS0;
+
+	while ( uDMAChannelModeGet( UDMA_CHANNEL_ADC0 | HalfSelect[NextHalf] ) == UDMA_MODE_STOP ) {
+		Distribute( Buffer[NextHalf] );
+		Arm( NextHalf );
+		NextHalf ^= 1;
+	}
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     StartHardware
+
+ Description
+     Clocks ADC0, the uDMA and timer 2, and sets up what doesn't depend on
+     the channels: hardware averaging, the uDMA transfers and the timer
+****************************************************************************/
+static void StartHardware ( void )
+{
+	HWREG(SYSCTL_RCGCADC) |= SYSCTL_RCGCADC_R0;
+	HWREG(SYSCTL_RCGCDMA) |= SYSCTL_RCGCDMA_R0;
+	HWREG(SYSCTL_RCGCTIMER) |= SYSCTL_RCGCTIMER_R2;
+	while( (HWREG(SYSCTL_PRADC) & SYSCTL_PRADC_R0) != SYSCTL_PRADC_R0 );
+	while( (HWREG(SYSCTL_PRDMA) & SYSCTL_PRDMA_R0) != SYSCTL_PRDMA_R0 );
+	while( (HWREG(SYSCTL_PRTIMER) & SYSCTL_PRTIMER_R2) != SYSCTL_PRTIMER_R2 );
+
+	//sequencer 0 starts on the timer trigger, each reading averaged 16 times
+	HWREG(ADC0_BASE+ADC_O_ACTSS) &= ~SS0;
+	HWREG(ADC0_BASE+ADC_O_EMUX) = (HWREG(ADC0_BASE+ADC_O_EMUX) & ~ADC_EMUX_EM0_M) |
+	                              EMUX_EM0_TIMER;
+	HWREG(ADC0_BASE+ADC_O_SAC) = SAC_AVG_16X;
+	//the sequencer's own interrupt stays masked, only the uDMA done one is used
+	HWREG(ADC0_BASE+ADC_O_IM) &= ~SS0;
+
+	//uDMA: 16 bit readings from the FIFO into the buffers, one per request,
+	//primary into Buffer[0] and alternate into Buffer[1]
+	uDMAEnable();
+	uDMAControlBaseSet( ControlTable );
+	uDMAChannelAttributeDisable( UDMA_CHANNEL_ADC0, UDMA_ATTR_ALTSELECT |
+	                             UDMA_ATTR_HIGH_PRIORITY | UDMA_ATTR_REQMASK );
+	uDMAChannelControlSet( UDMA_CHANNEL_ADC0 | UDMA_PRI_SELECT,
+	                       UDMA_SIZE_16 | UDMA_SRC_INC_NONE | UDMA_DST_INC_16 | UDMA_ARB_1 );
+	uDMAChannelControlSet( UDMA_CHANNEL_ADC0 | UDMA_ALT_SELECT,
+	                       UDMA_SIZE_16 | UDMA_SRC_INC_NONE | UDMA_DST_INC_16 | UDMA_ARB_1 );
+
+	//timer 2A: 32 bit periodic, triggering the ADC at ADC_TICK_RATE
+	HWREG(TIMER2_BASE+TIMER_O_CTL) &= ~TIMER_CTL_TAEN;
+	HWREG(TIMER2_BASE+TIMER_O_CFG) = TIMER_CFG_32_BIT_TIMER;
+	HWREG(TIMER2_BASE+TIMER_O_TAMR) = TIMER_TAMR_TAMR_PERIOD;
+	HWREG(TIMER2_BASE+TIMER_O_TAILR) = (TICKS_PER_SEC / ADC_TICK_RATE) - 1;
+	HWREG(TIMER2_BASE+TIMER_O_CTL) |= TIMER_CTL_TAOTE | TIMER_CTL_TASTALL;
+
+	HWREG(NVIC_EN0) |= ADC0_INT_EN;
+	HardwareStarted = true;
+}
+
+/****************************************************************************
+ Function
+     Restart
+
+ Description
+     Stops sampling, programs the sequence for the registered channels,
+     re-arms the ping-pong for a tick of that many readings and starts
+     sampling again
+****************************************************************************/
+static void Restart ( void )
+{
+	uint32_t Mux = 0;
+	uint8_t i;
+
+	HWREG(TIMER2_BASE+TIMER_O_CTL) &= ~TIMER_CTL_TAEN;
+	HWREG(ADC0_BASE+ADC_O_ACTSS) &= ~SS0;
+	uDMAChannelDisable( UDMA_CHANNEL_ADC0 );
+	//throw away anything left from the old sequence
+	while ( (HWREG(ADC0_BASE+ADC_O_SSFSTAT0) & ADC_SSFSTAT0_EMPTY) == 0 ) {
+		(void)HWREG(ADC0_BASE+ADC_O_SSFIFO0);
+	}
+	HWREG(ADC0_BASE+ADC_O_ISC) = SS0;
+
+	//one step per channel, the last one ends the sequence
+	for ( i = 0; i < NumChannels; i++ ) {
+		Mux |= (uint32_t)Channels[i].Input << (4 * i);
+	}
+	HWREG(ADC0_BASE+ADC_O_SSMUX0) = Mux;
+	HWREG(ADC0_BASE+ADC_O_SSCTL0) = (ADC_SSCTL0_IE0 | ADC_SSCTL0_END0) << (4 * (NumChannels - 1));
+
+	//the channels' partial averages started on the old sequence
+	for ( i = 0; i < NumChannels; i++ ) {
+		Channels[i].Sum = 0;
+		Channels[i].NumSummed = 0;
+	}
+	NextHalf = 0;
+	Arm( 0 );
+	Arm( 1 );
+	uDMAChannelEnable( UDMA_CHANNEL_ADC0 );
+
+	HWREG(ADC0_BASE+ADC_O_ACTSS) |= SS0;
+	HWREG(TIMER2_BASE+TIMER_O_CTL) |= TIMER_CTL_TAEN;
+}
+
+/****************************************************************************
+ Function
+     Arm
+
+ Description
+     Sets one half of the ping-pong up to take the next ADC_BUFFER_TICKS
+     ticks of readings from the sequencer 0 FIFO
+****************************************************************************/
+static void Arm ( uint8_t Half )
+{
+	uDMAChannelTransferSet( UDMA_CHANNEL_ADC0 | HalfSelect[Half], UDMA_MODE_PINGPONG,
+	                        (void *)(ADC0_BASE + ADC_O_SSFIFO0), Buffer[Half],
+	                        NumChannels * ADC_BUFFER_TICKS );
+}
+
+/****************************************************************************
+ Function
+     Distribute
+
+ Description
+     Adds a full buffer's readings to the channels, every Divider ticks a
+     channel gets their average in its ring
+****************************************************************************/
+static void Distribute ( const uint16_t *pBuffer )
+{
+	ADCChannel_t *pChannel;
+	uint8_t Tick, i;
+
+	for ( Tick = 0; Tick < ADC_BUFFER_TICKS; Tick++ ) {
+		for ( i = 0; i < NumChannels; i++ ) {
+			pChannel = &Channels[i];
+			pChannel->Sum += *pBuffer++;
+			if ( ++pChannel->NumSummed == pChannel->Divider ) {
+				pChannel->Ring[pChannel->Head & RING_MASK] = pChannel->Sum / pChannel->Divider;
+				pChannel->Head++;
+				pChannel->HasReading = true;
+				pChannel->Sum = 0;
+				pChannel->NumSummed = 0;
+			}
+		}
+	}
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,32 @@
+/****************************************************************************
+
+  Header file for ADCScheduler (shared, timer triggered sampling of the
+  analog inputs into per channel rings)
+
+ ****************************************************************************/
+
+#ifndef ADCScheduler_H
+#define ADCScheduler_H
+
+#include "ES_Types.h"     /* gets bool type for returns */
+
+// every registered input is converted this many times a second, a
+// channel's rate has to divide it
+#define ADC_TICK_RATE 1000
+// inputs that can be registered, the steps of sample sequencer 0
+#define ADC_MAX_CHANNELS 8
+// readings each channel's ring holds, a power of 2
+#define ADC_RING_SIZE 128
+
+// returned by ADCSched_Register when the input can't be added
+#define ADC_NO_CHANNEL 0xff
+
+// Public Function Prototypes
+uint8_t ADCSched_Register ( uint8_t Input, uint16_t Rate );
+uint16_t ADCSched_ReadLatest ( uint8_t Channel );
+uint16_t ADCSched_QueryUnread ( uint8_t Channel );
+uint16_t ADCSched_ReadBlock ( uint8_t Channel, uint16_t *pDest, uint16_t Count );
+uint16_t ADCSched_QueryOverruns ( uint8_t Channel );
+void ADCSchedISR ( void );
+
+#endif /* ADCScheduler_H */
@@ -0,0 +1,109 @@
+/****************************************************************************
+ Module
+   AccSampler.c
+
+ Description
+   Samples the water bucket accelerometer's X (AIN1, PE2), Y (AIN2, PE1)
+   and Z (AIN0, PE3) axes ACC_SAMPLE_RATE times a second through the ADC
+   scheduler, and hands them to the main loop in blocks of ACC_BLOCK_SIZE
+   samples with AccSampler_TakeBlock.
+
+ Notes
+   The ADC scheduler does the sampling (timer triggered, hardware averaged,
+   moved by the uDMA) and keeps each axis in its own ring. The three axes
+   are registered together, so the same tick of each lines up, and a block
+   is ready once every axis has ACC_BLOCK_SIZE unread readings. A block is
+   the axes interleaved, sample by sample, the way the sequencer used to
+   leave them.
+   The rings hold ADC_RING_SIZE readings, a block that isn't taken within
+   that many mS is lost and counted as an overrun.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+
+#include "ADCScheduler.h"
+#include "AccSampler.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define X_INPUT      1              // PE2 is AIN1
+#define Y_INPUT      2              // PE1 is AIN2
+#define Z_INPUT      0              // PE3 is AIN0
+
+/*---------------------------- Module Variables ---------------------------*/
+// the scheduler channel of each axis
+static uint8_t Channels[ACC_AXES];
+// the block handed over, and one axis of it on the way in
+static uint16_t Block[ACC_BLOCK_SIZE * ACC_AXES];
+static uint16_t Axis[ACC_BLOCK_SIZE];
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     AccSampler_Init
+
+ Description
+     Registers the three axes with the ADC scheduler, which starts sampling
+     them. Called from the water bucket service's Init.
+****************************************************************************/
+void AccSampler_Init ( void )
+{
+	Channels[ACC_X] = ADCSched_Register( X_INPUT, ACC_SAMPLE_RATE );
+	Channels[ACC_Y] = ADCSched_Register( Y_INPUT, ACC_SAMPLE_RATE );
+	Channels[ACC_Z] = ADCSched_Register( Z_INPUT, ACC_SAMPLE_RATE );
+	#if DEBUG_ACC
+	if ( (Channels[ACC_X] == ADC_NO_CHANNEL) || (Channels[ACC_Y] == ADC_NO_CHANNEL) ||
+	     (Channels[ACC_Z] == ADC_NO_CHANNEL) ) {
+		printf("Acc: no ADC channel\n\r");
+	}
+	#endif
+}
+
+/****************************************************************************
+ Function
+     AccSampler_TakeBlock
+
+ Parameters
+     const uint16_t **ppBlock : gets the oldest full block, if there is one
+
+ Returns
+     bool, true if a block was waiting
+
+ Description
+     Hands over a block of ACC_BLOCK_SIZE samples of ACC_AXES readings
+     each, oldest first (see ACC_X, ACC_Y, ACC_Z). It stays good until the
+     next take.
+****************************************************************************/
+bool AccSampler_TakeBlock ( const uint16_t **ppBlock )
+{
+	uint8_t i, j;
+
+	for ( j = 0; j < ACC_AXES; j++ ) {
+		if ( ADCSched_QueryUnread( Channels[j] ) < ACC_BLOCK_SIZE ) {
+			return false;
+		}
+	}
+	for ( j = 0; j < ACC_AXES; j++ ) {
+		ADCSched_ReadBlock( Channels[j], Axis, ACC_BLOCK_SIZE );
+		for ( i = 0; i < ACC_BLOCK_SIZE; i++ ) {
+			Block[i * ACC_AXES + j] = Axis[i];
+		}
+	}
+	*ppBlock = Block;
+	return true;
+}
+
+/****************************************************************************
+ Function
+     AccSampler_QueryOverruns
+
+ Returns
+     uint16_t, number of samples lost before they were taken
+****************************************************************************/
+uint16_t AccSampler_QueryOverruns ( void )
+{
+	return ADCSched_QueryOverruns( Channels[ACC_Z] );
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
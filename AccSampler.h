@@ -0,0 +1,30 @@
+/****************************************************************************
+
+  Header file for AccSampler (blocks of the water bucket accelerometer's
+  three axes, from the ADC scheduler)
+
+ ****************************************************************************/
+
+#ifndef AccSampler_H
+#define AccSampler_H
+
+#include "ES_Types.h"     /* gets bool type for returns */
+
+// samples per second, each one the hardware average of 16 conversions
+#define ACC_SAMPLE_RATE 1000
+// samples per block, a block is handed over every ACC_BLOCK_SIZE mS
+#define ACC_BLOCK_SIZE 32
+
+// each sample is a reading of every axis, in this order, so axis A of
+// sample i is pBlock[i * ACC_AXES + A]
+#define ACC_X    0
+#define ACC_Y    1
+#define ACC_Z    2
+#define ACC_AXES 3
+
+// Public Function Prototypes
+void AccSampler_Init ( void );
+bool AccSampler_TakeBlock ( const uint16_t **ppBlock );
+uint16_t AccSampler_QueryOverruns ( void );
+
+#endif /* AccSampler_H */
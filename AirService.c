@@ -24,6 +24,9 @@
 */
 #include "ES_Configure.h"
 #include "ES_Framework.h"
+#include "ES_Broadcast.h"
+#include "ES_QueueStats.h"
+#include "ES_TableFSM.h"
 #include "TemplateService.h"
 
 // include the PWM library
@@ -47,20 +50,12 @@
 #include "Flipbook3Service.h"
 #include "MainStoryService.h"
 #include "LEDService.h"
+#include "IRCapture.h"
 
 /*----------------------------- Module Defines ----------------------------*/
 #define ALL_BITS (0xff<<2)
-#define PORT_A    BIT0HI      // for IR
 #define PORT_C    BIT2HI      // for LEDs
 
-#define IR1_PIN   GPIO_PIN_4  //PA4
-#define IR1_HI    BIT4HI
-#define IR1_LO    BIT4LO
-
-#define IR2_PIN   GPIO_PIN_5  //PA5
-#define IR2_HI    BIT5HI
-#define IR2_LO    BIT5LO
-
 #define LED1_PIN  GPIO_PIN_6  //PC6
 #define LED1_HI   BIT6HI
 #define LED1_LO   BIT6LO
@@ -71,21 +66,78 @@
 
 #define THRESHOLD 10
 
+// distance between the IR1 and IR2 beams, measure it on the machine
+#define IR_SPACING_MM 150
+
+// each wave moves the smoothed period 1/2^WAVE_EWMA_SHIFT of the way to
+// the new one, 2 follows a change of pace in about 4 waves
+#define WAVE_EWMA_SHIFT 2
+// smoothed periods at and past these are WAVE_INTENSITY_MAX and 0
+#define WAVE_PERIOD_FAST_US 200000UL
+#define WAVE_PERIOD_SLOW_US 1500000UL
+
+// superstate of the running states, handles ES_RESET for all of them
+#define AirRunning (Wait4CelebrationIR + 1)
+#define NUM_AIR_STATES (AirRunning + 1)
+
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this service.They should be functions
    relevant to the behavior of this service
 */
-static uint8_t UpdateIR1State ( void );
-static uint8_t UpdateIR2State ( void );
+static ES_Event HandleAirEvent ( ES_Event ThisEvent );
+static uint8_t QueryState ( void );
+static bool IsNewWave ( ES_Event ThisEvent );
+static bool IsLastWave ( ES_Event ThisEvent );
+static void AirLEDsOff ( ES_Event ThisEvent );
+static void StartHarvesting ( ES_Event ThisEvent );
+static void SwitchToIR1 ( ES_Event ThisEvent );
+static void SwitchToIR2 ( ES_Event ThisEvent );
+static void FinishHarvest ( ES_Event ThisEvent );
+static void ResetAir ( ES_Event ThisEvent );
+static void RecordWave ( ES_Event ThisEvent );
 
 /*---------------------------- Module Variables ---------------------------*/
 // with the introduction of Gen2, we need a module level Priority variable
 static uint8_t MyPriority;
 static AirState_t CurrentState;
-static uint8_t LastIR1State;
-static uint8_t LastIR2State;
 static ES_EventTyp_t PrevEvent;
 static uint8_t IR_Count;
+// the counted waves from one beam to the other, smoothed (0 until there
+// is one)
+static uint32_t WavePeriod;   // uS
+static uint16_t HandSpeed;    // mm/S
+static uint8_t WaveIntensity; // 0 to WAVE_INTENSITY_MAX
+
+// the transitions of each state, the last wave has to be tried before the
+// plain new wave row
+static const ES_FSMRow_t InitRows[] = {
+	{ ES_INIT,          ES_FSM_ANY_PARAM, 0,          AirLEDsOff,      Wait4HarvestingIR }
+};
+static const ES_FSMRow_t Wait4HarvestingRows[] = {
+	{ ES_START_HARVEST, ES_FSM_ANY_PARAM, 0,          StartHarvesting, Harvesting_IR1 }
+};
+static const ES_FSMRow_t HarvestingIR1Rows[] = {
+	{ ES_IR1_HI,        ES_FSM_ANY_PARAM, IsLastWave, FinishHarvest,   Wait4CelebrationIR },
+	{ ES_IR1_HI,        ES_FSM_ANY_PARAM, IsNewWave,  SwitchToIR2,     Harvesting_IR2 }
+};
+static const ES_FSMRow_t HarvestingIR2Rows[] = {
+	{ ES_IR2_HI,        ES_FSM_ANY_PARAM, IsLastWave, FinishHarvest,   Wait4CelebrationIR },
+	{ ES_IR2_HI,        ES_FSM_ANY_PARAM, IsNewWave,  SwitchToIR1,     Harvesting_IR1 }
+};
+static const ES_FSMRow_t RunningRows[] = {
+	{ ES_RESET,         ES_FSM_ANY_PARAM, 0,          ResetAir,        InitAir }
+};
+
+// the machine, indexed by AirState_t (plus the AirRunning superstate)
+static const ES_FSMState_t AirStates[NUM_AIR_STATES] = {
+	/* InitAir */            ES_FSM_STATE( ES_FSM_NO_PARENT, InitRows ),
+	/* Wait4HarvestingIR */  ES_FSM_STATE( AirRunning, Wait4HarvestingRows ),
+	/* Harvesting_IR1 */     ES_FSM_STATE( AirRunning, HarvestingIR1Rows ),
+	/* Harvesting_IR2 */     ES_FSM_STATE( AirRunning, HarvestingIR2Rows ),
+	/* Wait4CelebrationIR */ ES_FSM_EMPTY_STATE( AirRunning ),
+	/* AirRunning */         ES_FSM_STATE( ES_FSM_NO_PARENT, RunningRows )
+};
+static const ES_FSM_t AirMachine = { AirStates, NUM_AIR_STATES };
 
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
@@ -112,20 +164,9 @@ bool InitAirService ( uint8_t Priority )
 	//Initialize the MyPriority variable with the passed in parameter.
   MyPriority = Priority;
 	
-	//Initialize the port line to sense the IR
-  HWREG(SYSCTL_RCGCGPIO) |= PORT_A;   // enable port A  
-	// wait for the port to be ready
-	while( (HWREG(SYSCTL_PRGPIO) & PORT_A) != PORT_A );  
-	
-	// enable IR1 pin and set as input
-	HWREG(GPIO_PORTA_BASE + GPIO_O_DEN ) |= ( IR1_HI );
-	HWREG( GPIO_PORTA_BASE + GPIO_O_DIR ) &= ( IR1_LO );
-	LastIR1State = UpdateIR1State();
-	
-	// enable IR2 pin and set as input
-	HWREG(GPIO_PORTA_BASE + GPIO_O_DEN ) |= ( IR2_HI );
-	HWREG( GPIO_PORTA_BASE + GPIO_O_DIR ) &= ( IR2_LO );
-	LastIR2State = UpdateIR2State();
+	//Start the time stamped edge capture on the IR pins, it posts the
+	//ES_IR1_HI and ES_IR2_HI events to us
+	IRCapture_Init( PostAirService );
 	
 	//Initialize the port line to control the Air LEDs 
   HWREG(SYSCTL_RCGCGPIO) |= PORT_C;   // enable portA    
@@ -149,7 +190,7 @@ bool InitAirService ( uint8_t Priority )
 	
 	//Post Event ES_Init to AirService queue (this service)
   ThisEvent.EventType = ES_INIT;
-  if (ES_PostToService( MyPriority, ThisEvent) == true)
+  if (ES_QueueStatsPost( MyPriority, ThisEvent) == true)
   {
       return true;
   }else
@@ -175,7 +216,7 @@ bool InitAirService ( uint8_t Priority )
 ****************************************************************************/
 bool PostAirService( ES_Event ThisEvent )
 {
-  return ES_PostToService( MyPriority, ThisEvent);
+  return ES_QueueStatsPost( MyPriority, ThisEvent);
 }
 
 /****************************************************************************
@@ -186,179 +227,62 @@ bool PostAirService( ES_Event ThisEvent )
    ES_Event : the event to process
 
  Returns
-   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
+   ES_Event, whatever HandleAirEvent returns
 
  Description
+   Runs ThisEvent through HandleAirEvent by way of ES_QueueStatsRun
+****************************************************************************/
+ES_Event RunAirService( ES_Event ThisEvent )
+{
+	return ES_QueueStatsRun( MyPriority, ThisEvent, HandleAirEvent, QueryState );
+}
+
+/****************************************************************************
+ Function
+    HandleAirEvent
+
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
 
+ Description
+   Runs the event through the Air state table. Each new hand wave over the
+   lit IR sensor counts, and after THRESHOLD of them the harvest is done.
+ Notes
+   ES_RESET is handled by the AirRunning superstate for every state after
+   Init
  Author
 	A. Siu
 ****************************************************************************/
-ES_Event RunAirService( ES_Event ThisEvent )
+static ES_Event HandleAirEvent( ES_Event ThisEvent )
 {
   ES_Event ReturnEvent;
   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
-  AirState_t NextState = CurrentState;
-  switch ( CurrentState )
-  {
-		case InitAir:
-			if ( ThisEvent.EventType == ES_INIT ) {
-				// set all LEDs lo
-				HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED1_LO;
-				HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED2_LO;
-				NextState = Wait4HarvestingIR;
-				#if DEBUG_AIR
-				printf("AS: Init starting.\n\r\n");
-				#endif
-			}
-			break;
-		
-		//CurrentState is Wait4Harvesting
-		case Wait4HarvestingIR:
-			//if ThisEvent is ES_START_HARVEST
-			if ( ThisEvent.EventType == ES_START_HARVEST ) {
-				#if DEBUG_AIR
-				printf("AS: Start harvesting\n\r\n");
-				#endif
-				//Turn on LED corresponding to IR1
-				HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) |= LED1_HI;
-				// save the PrevEvent as IR2
-				PrevEvent = ES_IR2_HI;
-				IR_Count = 0;
-				//Set NextState to Harvesting
-				NextState = Harvesting_IR1;
-			} 
-			if ( ThisEvent.EventType == ES_RESET ) {
-				// turn off all the LEDs
-				HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED1_LO;
-				HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED2_LO;
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Set NextState to InitAirService
-				NextState = InitAir;
-			}
-		break;
-		
-	//CurrentState is Harvesting_IR1
-		case Harvesting_IR1:
-			//if ThisEvent is IR1_HI, and this is a new event
-			if ( (ThisEvent.EventType == ES_IR1_HI) && (PrevEvent != ThisEvent.EventType) ) {
-				//Increment IR_Count
-				IR_Count++;
-				#if DEBUG_AIR
-				printf("AS: Count so far %u\n\r\n", IR_Count);
-				#endif
-				//Save the event type to PrevEvent
-				PrevEvent = ThisEvent.EventType;
-				// check if this is the end of harvesting
-				if ( IR_Count >= THRESHOLD ) {
-					// turn off all the LEDs
-					HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED1_LO;
-					HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED2_LO;
-					#if DEBUG_AIR
-					printf("AS: posting ES_DONE_HARVEST to FS3\n\r\n");
-					#endif
-					//Post ES_DONE_HARVEST event to Flipbook3Service and LED Service
-					ES_Event Event2Post;
-					Event2Post.EventType = ES_DONE_HARVEST;
-					PostFlip3Service( Event2Post );
-					PostLEDService( Event2Post );
-					//Set NextState to Wait4Celebration
-					NextState = Wait4CelebrationIR;
-				// else continue to toggle the LEDs
-				} else {
-					//Turn off the LED corresponding to IR1
-					HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED1_LO;
-					//Turn on the LED corresponding to IR2
-					HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) |= LED2_HI;
-					//Set NextState to Harvesting_IR2
-					NextState = Harvesting_IR2;
-				}
-			} else if ( ThisEvent.EventType == ES_RESET ) {
-				// turn off all the LEDs
-				HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED1_LO;
-				HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED2_LO;
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Set NextState to InitAirService
-				NextState = InitAir;
-			}
-			break;
-			
-		case Harvesting_IR2:
-			//if ThisEvent is IR2_HI, and this is a new event
-			if ( (ThisEvent.EventType == ES_IR2_HI) && (PrevEvent != ThisEvent.EventType) ) {
-				//Increment IR_Count
-				IR_Count++;
-				#if DEBUG_AIR
-				printf("AS: Count so far %u\n\r\n", IR_Count);
-				#endif
-				//Save the event type to PrevEvent
-				PrevEvent = ThisEvent.EventType;
-				// check if this is the end of harvesting
-				if ( IR_Count >= THRESHOLD ) {
-					// turn off all the LEDs
-					HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED1_LO;
-					HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED2_LO;
-					#if DEBUG_AIR
-					printf("AS: harvesting done\n\r\n");
-					printf("AS: posting ES_DONE_HARVEST to FS3\n\r\n");
-					#endif
-					//Post ES_DONE_HARVEST event to Flipbook3Service and LED Service
-					ES_Event Event2Post;
-					Event2Post.EventType = ES_DONE_HARVEST;
-					PostFlip3Service( Event2Post );
-					PostLEDService( Event2Post );
-					//Set NextState to Wait4Celebration
-					NextState = Wait4CelebrationIR;
-				// else continue to toggle the LEDs
-				} else {
-					//Turn off the LED corresponding to IR2
-					HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED2_LO;
-					//Turn on the LED corresponding to IR1
-					HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) |= LED1_HI;
-					//Set NextState to Harvesting_IR1
-					NextState = Harvesting_IR1;
-				}
-			} else if ( ThisEvent.EventType == ES_RESET ) {
-				// turn off all the LEDs
-				HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED1_LO;
-				HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED2_LO;
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Set NextState to InitAirService
-				NextState = InitAir;
-			}
-			break;
-		
-		case Wait4CelebrationIR:
-			if ( ThisEvent.EventType == ES_RESET ) {
-				// turn off all the LEDs
-				HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED1_LO;
-				HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED2_LO;
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Set NextState to InitAirService
-				NextState = InitAir;
-			}
-		break;
-			
-		default :
-	  	;
-	
-	} // end SM 
-	
-	CurrentState = NextState;
+	//Broadcasts (ES_RESET, ES_CELEBRATION) come through the broadcast ring,
+	//swap in the next one
+	if ( ThisEvent.EventType == ES_BROADCAST ) {
+		ThisEvent = ES_BroadcastFetch( MyPriority );
+	}
+
+	//Look the event up in the state table, it runs the action and gives us
+	//the next state
+	CurrentState = (AirState_t)ES_FSM_Dispatch( &AirMachine, CurrentState, ThisEvent );
   return ReturnEvent;
 }
 
+/****************************************************************************
+ Function
+     QueryState
+
+ Returns
+     uint8_t, the current state, for the trace kept by ES_QueueStatsRun
+****************************************************************************/
+static uint8_t QueryState ( void )
+{
+	return CurrentState;
+}
 
 /****************************************************************************
  Function
@@ -384,79 +308,41 @@ AirState_t QueryAirService ( void )
 
 /****************************************************************************
  Function
-    Check4IR_1
-
- Parameters
-	 None
+     QueryAirWavePeriod
 
  Returns
-	 Returns true if hand was detected. Posts an ES_IR1_HI event.
-
- Author
-	A. Siu
+     uint32_t, uS the counted waves take from one beam to the other,
+     smoothed, 0 if there hasn't been one timed yet
 ****************************************************************************/
-bool Check4IR_1 ( void ) {
-	
-	bool ReturnVal = false;
-	//Set CurrentIR_1State to state read from port pin
-	uint8_t CurrentIR1State = UpdateIR1State();
-	
-	//If the CurrentIR_1State is different from LastIR_1State
-	if ( CurrentIR1State != LastIR1State ) {
-		ES_Event ThisEvent;
-		ReturnVal = true;
-		//If CurrentIR_1State is Hi (hand is there)
-		if ( CurrentIR1State == IR1_HI ) {
-			#if DEBUG_IR
-				printf("IR1 change detected\n\r\n");
-			#endif
-			//Post ES_IR1_HI to AirService
-			ThisEvent.EventType = ES_IR1_HI;
-			PostAirService( ThisEvent );
-		}
-	}
-	//Set LastAccState to the CurrentAccState
-	LastIR1State = CurrentIR1State;
-
-	return ReturnVal;
+uint32_t QueryAirWavePeriod ( void )
+{
+	return WavePeriod;
 }
 
 /****************************************************************************
  Function
-    Check4IR_2
-
- Parameters
-		None
+     QueryAirHandSpeed
 
  Returns
-		Returns true if hand was detected. Posts an ES_IR2_HI event.
-
- Author
+     uint16_t, mm/S the hand moves across the beams at the smoothed wave
+     period, 0 if there hasn't been one timed yet
 ****************************************************************************/
-bool Check4IR_2 ( void ) {
-	
-	bool ReturnVal = false;
-	//Set CurrentIR_1State to state read from port pin
-	uint8_t CurrentIR2State = UpdateIR2State();
-	
-	//If the CurrentIR_2State is different from LastIR_2State
-	if ( CurrentIR2State != LastIR2State ) {
-		ES_Event ThisEvent;
-		ReturnVal = true;
-		//If CurrentIR_1State is Hi (hand is there)
-		if ( CurrentIR2State == IR2_HI ) {
-			#if DEBUG_IR
-				printf("IR2 change detected\n\r\n");
-			#endif
-			//Post ES_IR1_HI to AirService
-			ThisEvent.EventType = ES_IR2_HI;
-			PostAirService( ThisEvent );
-		}
-	}
-	//Set LastAccState to the CurrentAccState
-	LastIR2State = CurrentIR2State;
+uint16_t QueryAirHandSpeed ( void )
+{
+	return HandSpeed;
+}
+
+/****************************************************************************
+ Function
+     QueryAirWaveIntensity
 
-	return ReturnVal;
+ Returns
+     uint8_t, how hard the visitor is waving, 0 (slow or not timed yet) to
+     WAVE_INTENSITY_MAX, the ES_WAVE_RATE parameter
+****************************************************************************/
+uint8_t QueryAirWaveIntensity ( void )
+{
+	return WaveIntensity;
 }
 
 /***************************************************************************
@@ -464,41 +350,225 @@ bool Check4IR_2 ( void ) {
  ***************************************************************************/
 /****************************************************************************
  Function
-     UpdateIR1State
+     IsNewWave
 
- Parameters
-     None
+ Returns
+     bool, true if this IR event is not a repeat of the last one counted
+****************************************************************************/
+static bool IsNewWave ( ES_Event ThisEvent )
+{
+	return ( PrevEvent != ThisEvent.EventType );
+}
+
+/****************************************************************************
+ Function
+     IsLastWave
 
  Returns
-	Return the current state of the IR1 pin
+     bool, true if this IR event is a new wave that reaches THRESHOLD
+****************************************************************************/
+static bool IsLastWave ( ES_Event ThisEvent )
+{
+	return ( IsNewWave( ThisEvent ) && ((IR_Count + 1) >= THRESHOLD) );
+}
 
- Author
-     A. Siu, 11/03/16
+/****************************************************************************
+ Function
+     AirLEDsOff
+
+ Description
+     InitAir on ES_INIT: turns both air LEDs off
 ****************************************************************************/
-static uint8_t UpdateIR1State ( void )
+static void AirLEDsOff ( ES_Event ThisEvent )
 {
-	return ( HWREG( GPIO_PORTA_BASE + ( GPIO_O_DATA + ALL_BITS )) &= IR1_PIN );
+	// set all LEDs lo
+	HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED1_LO;
+	HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED2_LO;
+	#if DEBUG_AIR
+	printf("AS: Init starting.\n\r\n");
+	#endif
 }
 
+/****************************************************************************
+ Function
+     StartHarvesting
+
+ Description
+     Wait4HarvestingIR on ES_START_HARVEST: lights the IR1 LED and starts
+     the count
+****************************************************************************/
+static void StartHarvesting ( ES_Event ThisEvent )
+{
+	#if DEBUG_AIR
+	printf("AS: Start harvesting\n\r\n");
+	#endif
+	//Turn on LED corresponding to IR1
+	HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) |= LED1_HI;
+	// save the PrevEvent as IR2
+	PrevEvent = ES_IR2_HI;
+	IR_Count = 0;
+	WavePeriod = 0;
+	HandSpeed = 0;
+	WaveIntensity = 0;
+}
 
 /****************************************************************************
  Function
-     UpdateIR2State
+     SwitchToIR1
 
- Parameters
-     None
+ Description
+     Harvesting_IR2 on a new ES_IR2_HI: counts it and moves the light over
+     to the IR1 LED
+****************************************************************************/
+static void SwitchToIR1 ( ES_Event ThisEvent )
+{
+	//Time the wave
+	RecordWave( ThisEvent );
+	//Increment IR_Count
+	IR_Count++;
+	#if DEBUG_AIR
+	printf("AS: Count so far %u\n\r\n", IR_Count);
+	#endif
+	//Save the event type to PrevEvent
+	PrevEvent = ThisEvent.EventType;
+	//Turn off the LED corresponding to IR2
+	HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED2_LO;
+	//Turn on the LED corresponding to IR1
+	HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) |= LED1_HI;
+}
 
- Returns
-	Return the current state of the IR2 pin
+/****************************************************************************
+ Function
+     SwitchToIR2
 
- Author
-     A. Siu, 11/03/16
+ Description
+     Harvesting_IR1 on a new ES_IR1_HI: counts it and moves the light over
+     to the IR2 LED
 ****************************************************************************/
-static uint8_t UpdateIR2State ( void )
+static void SwitchToIR2 ( ES_Event ThisEvent )
 {
-	return ( HWREG( GPIO_PORTA_BASE + ( GPIO_O_DATA + ALL_BITS )) &= IR2_PIN );
+	//Time the wave
+	RecordWave( ThisEvent );
+	//Increment IR_Count
+	IR_Count++;
+	#if DEBUG_AIR
+	printf("AS: Count so far %u\n\r\n", IR_Count);
+	#endif
+	//Save the event type to PrevEvent
+	PrevEvent = ThisEvent.EventType;
+	//Turn off the LED corresponding to IR1
+	HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED1_LO;
+	//Turn on the LED corresponding to IR2
+	HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) |= LED2_HI;
 }
 
+/****************************************************************************
+ Function
+     FinishHarvest
+
+ Description
+     Harvesting_IR1/2 on the last wave: counts it, turns the LEDs off and
+     posts ES_DONE_HARVEST to Flipbook3Service and LEDService
+****************************************************************************/
+static void FinishHarvest ( ES_Event ThisEvent )
+{
+	ES_Event Event2Post;
+
+	//Time the wave
+	RecordWave( ThisEvent );
+	//Increment IR_Count
+	IR_Count++;
+	//Save the event type to PrevEvent
+	PrevEvent = ThisEvent.EventType;
+	// turn off all the LEDs
+	HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED1_LO;
+	HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED2_LO;
+	#if DEBUG_AIR
+	printf("AS: harvesting done\n\r\n");
+	printf("AS: posting ES_DONE_HARVEST to FS3\n\r\n");
+	#endif
+	//Post ES_DONE_HARVEST event to Flipbook3Service and LED Service, with
+	//how hard they waved
+	Event2Post.EventType = ES_DONE_HARVEST;
+	Event2Post.EventParam = WaveIntensity;
+	PostFlip3Service( Event2Post );
+	PostLEDService( Event2Post );
+}
+
+/****************************************************************************
+ Function
+     ResetAir
+
+ Description
+     AirRunning on ES_RESET: turns the LEDs off and tells MainStoryService
+     the air stage is reset
+****************************************************************************/
+static void ResetAir ( ES_Event ThisEvent )
+{
+	ES_Event Event2Post;
+
+	// turn off all the LEDs
+	HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED1_LO;
+	HWREG( GPIO_PORTC_BASE + ( GPIO_O_DATA + ALL_BITS )) &= LED2_LO;
+	// post an ES_DONE_INIT to the MainService
+	Event2Post.EventType = ES_DONE_INIT;
+	PostMainService( Event2Post );
+}
+
+/****************************************************************************
+ Function
+     RecordWave
+
+ Description
+     Folds the period of a counted wave, the time since the other beam's
+     last edge that IRCapture puts in the event parameter, into the
+     exponentially weighted WavePeriod, works out the hand speed and
+     intensity from it and posts ES_WAVE_RATE to LEDService. A wave with no
+     interval (the first one, or a pause of more than 6.5 S) leaves the
+     last values alone.
+****************************************************************************/
+static void RecordWave ( ES_Event ThisEvent )
+{
+	ES_Event Event2Post;
+	uint32_t Period;
+	uint32_t Speed;
+
+	if ( ThisEvent.EventParam == IR_NO_INTERVAL ) {
+		return;
+	}
+	//the interval is rounded down to IR_INTERVAL_US, take the middle
+	Period = (uint32_t)ThisEvent.EventParam * IR_INTERVAL_US + IR_INTERVAL_US / 2;
+	//the first wave seeds the average, after that each one moves it part way
+	if ( WavePeriod == 0 ) {
+		WavePeriod = Period;
+	} else if ( Period > WavePeriod ) {
+		WavePeriod += (Period - WavePeriod) >> WAVE_EWMA_SHIFT;
+	} else {
+		WavePeriod -= (WavePeriod - Period) >> WAVE_EWMA_SHIFT;
+	}
+
+	Speed = ((uint32_t)IR_SPACING_MM * 1000000UL) / WavePeriod;
+	HandSpeed = ( Speed > 0xffff ) ? 0xffff : (uint16_t)Speed;
+
+	//faster waving (a shorter period) is a higher intensity
+	if ( WavePeriod >= WAVE_PERIOD_SLOW_US ) {
+		WaveIntensity = 0;
+	} else if ( WavePeriod <= WAVE_PERIOD_FAST_US ) {
+		WaveIntensity = WAVE_INTENSITY_MAX;
+	} else {
+		WaveIntensity = (uint8_t)(((WAVE_PERIOD_SLOW_US - WavePeriod) * WAVE_INTENSITY_MAX) /
+		                          (WAVE_PERIOD_SLOW_US - WAVE_PERIOD_FAST_US));
+	}
+	#if DEBUG_AIR
+	printf("AS: wave %luuS, avg %luuS, %umm/S, intensity %u\n\r\n", Period,
+	       WavePeriod, HandSpeed, WaveIntensity);
+	#endif
+
+	//Post ES_WAVE_RATE to LED Service so it can follow the waving
+	Event2Post.EventType = ES_WAVE_RATE;
+	Event2Post.EventParam = WaveIntensity;
+	PostLEDService( Event2Post );
+}
 
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
@@ -15,15 +15,21 @@
 typedef enum { InitAir, Wait4HarvestingIR, Harvesting_IR1, 
 							 Harvesting_IR2, Wait4CelebrationIR } AirState_t ;
 
+// top of the wave intensity scale (ES_WAVE_RATE and ES_DONE_HARVEST
+// parameters), the fastest waving
+#define WAVE_INTENSITY_MAX 255
+
 // Public Function Prototypes
 bool InitAirService ( uint8_t Priority );
 bool PostAirService ( ES_Event ThisEvent );
 ES_Event RunAirService ( ES_Event ThisEvent );
 AirState_t QueryAirService ( void );
+uint32_t QueryAirWavePeriod ( void );
+uint16_t QueryAirHandSpeed ( void );
+uint8_t QueryAirWaveIntensity ( void );
 
 //Event checkers
-bool Check4IR_1 ( void );
-bool Check4IR_2 ( void );
+#include "IRCapture.h"   /* CheckIREdges */
 
 #endif /* AIR_SERV_H */
 
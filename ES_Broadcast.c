@@ -0,0 +1,249 @@
+/****************************************************************************
+ Module
+     ES_Broadcast.c
+
+ Description
+     Multicast posting for the Events and Services framework. A broadcast
+     list is a bitmask of the subscribing service priorities. Posting to it
+     copies the event once into a ring shared by all services and marks the
+     slot unread for each subscriber, instead of copying the event into
+     every subscriber's queue. Each subscriber reads the ring in order
+     through its own cursor.
+
+ Notes
+     The framework only runs a service when its queue is not empty, so each
+     subscriber is woken with an ES_BROADCAST event, the doorbell. A
+     subscriber has at most one doorbell in its queue at a time, however
+     many broadcasts are waiting for it, so the only per subscriber work of
+     a post is setting its bit in the slot and ringing the doorbell if it
+     is not already ringing.
+     The subscriber MUST call ES_BroadcastFetch every time ES_BROADCAST
+     comes out of its queue, in every state, and handle the event it gets
+     back. The simplest way is to do the fetch at the top of the Run
+     function, the same as the mailbox fetch. If more broadcasts are
+     waiting the fetch rings the doorbell again.
+     A slot is freed once every subscriber it was posted to has fetched it.
+     If the oldest slot is still unread when the ring is full the post is
+     refused, and the subscriber holding it up is recorded as the lagging
+     one (see ES_BroadcastQueryLagging).
+     BROADCAST_RING_SIZE must be a power of 2, 64 or less.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_QueueStats.h"
+#include "ES_Broadcast.h"
+#include "ES_Trace.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define RING_MASK (BROADCAST_RING_SIZE - 1)
+
+/*---------------------------- Module Functions ---------------------------*/
+static bool RingDoorbell ( uint8_t Priority );
+
+/*---------------------------- Module Variables ---------------------------*/
+// the broadcast events, and for each slot the subscribers that have not
+// fetched it yet
+static ES_Event Ring[BROADCAST_RING_SIZE];
+static uint16_t Unread[BROADCAST_RING_SIZE];
+
+// free running counts, Head is the next slot to write and Tail the oldest
+// slot still in use, slot number = count & RING_MASK
+static uint8_t Head;
+static uint8_t Tail;
+
+// next slot each subscriber reads, and how many broadcasts wait for it
+static uint8_t Cursor[MAX_NUM_SERVICES];
+static uint8_t Backlog[MAX_NUM_SERVICES];
+
+// bit n set means the service at priority n has ES_BROADCAST in its queue
+static uint16_t Doorbell;
+
+// who held up the last refused post, and how often each subscriber has
+static uint8_t Lagging = BROADCAST_NO_SUBSCRIBER;
+static uint16_t NumOverflows[MAX_NUM_SERVICES];
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_BroadcastPost
+
+ Parameters
+     uint16_t Subscribers : the broadcast list, bit n for service priority n
+     ES_Event ThisEvent : the event to post
+
+ Returns
+     bool, false if the ring is full or a doorbell could not be posted,
+     true otherwise
+
+ Description
+     Puts one copy of ThisEvent in the ring, marks it unread for every
+     subscriber and rings the doorbell of the ones that are idle.
+****************************************************************************/
+bool ES_BroadcastPost ( uint16_t Subscribers, ES_Event ThisEvent )
+{
+	bool ReturnVal = true;
+	uint16_t Remaining;
+	uint8_t Priority;
+	uint8_t Slot;
+
+	//free the slots that everyone has read
+	while ( (Tail != Head) && (Unread[Tail & RING_MASK] == 0) ) {
+		Tail++;
+	}
+
+	//if the ring is full, blame the first subscriber that has not read the
+	//oldest slot
+	if ( (uint8_t)(Head - Tail) >= BROADCAST_RING_SIZE ) {
+		Remaining = Unread[Tail & RING_MASK];
+		for ( Priority = 0; (Remaining & 1) == 0; Priority++, Remaining >>= 1 ) {
+		}
+		Lagging = Priority;
+		NumOverflows[Priority]++;
+		#if DEBUG_BROADCAST
+		printf("BC: ring full, service %u is lagging\n\r", Priority);
+		#endif
+		return false;
+	}
+
+	//one copy of the event for everybody
+	Slot = Head & RING_MASK;
+	Ring[Slot] = ThisEvent;
+	Unread[Slot] = Subscribers;
+	Head++;
+
+	//walk the subscriber bits
+	Remaining = Subscribers;
+	for ( Priority = 0; Remaining != 0; Priority++, Remaining >>= 1 ) {
+		if ( (Remaining & 1) == 0 ) {
+			continue;
+		}
+		//a subscriber with nothing waiting starts reading at this slot
+		if ( Backlog[Priority] == 0 ) {
+			Cursor[Priority] = Head - 1;
+		}
+		Backlog[Priority]++;
+		//only a subscriber without a doorbell waiting needs a new one
+		if ( (Doorbell & (1u << Priority)) == 0 ) {
+			if ( RingDoorbell( Priority ) == false ) {
+				ReturnVal = false;
+			}
+		}
+	}
+	return ReturnVal;
+}
+
+/****************************************************************************
+ Function
+     ES_BroadcastFetch
+
+ Parameters
+     uint8_t Priority : the priority of the calling service
+
+ Returns
+     ES_Event, the oldest broadcast this service has not read yet, or
+     ES_NO_EVENT if there is none
+
+ Description
+     Called by a subscriber when ES_BROADCAST is dequeued. Moves its cursor
+     past the event it returns and rings the doorbell again if more are
+     waiting.
+****************************************************************************/
+ES_Event ES_BroadcastFetch ( uint8_t Priority )
+{
+	ES_Event ReturnEvent;
+	uint16_t MyBit = (1u << Priority);
+	uint8_t Slot;
+
+	ReturnEvent.EventType = ES_NO_EVENT;
+	if ( Priority >= MAX_NUM_SERVICES ) {
+		return ReturnEvent;
+	}
+	Doorbell &= ~MyBit;
+
+	//slots before Tail have been read by everybody and may already hold
+	//newer posts, so never read from behind it
+	if ( (uint8_t)(Head - Cursor[Priority]) > (uint8_t)(Head - Tail) ) {
+		Cursor[Priority] = Tail;
+	}
+
+	//skip over the slots that were posted to other lists
+	while ( Cursor[Priority] != Head ) {
+		Slot = Cursor[Priority] & RING_MASK;
+		Cursor[Priority]++;
+		if ( (Unread[Slot] & MyBit) != 0 ) {
+			Unread[Slot] &= ~MyBit;
+			Backlog[Priority]--;
+			ReturnEvent = Ring[Slot];
+			#if ES_TRACE
+			ES_TraceRecord( TRACE_FETCH, Priority, ReturnEvent.EventType, ReturnEvent.EventParam );
+			#endif
+			break;
+		}
+	}
+
+	//more waiting, keep the doorbell ringing
+	if ( Backlog[Priority] != 0 ) {
+		RingDoorbell( Priority );
+	}
+	return ReturnEvent;
+}
+
+/****************************************************************************
+ Function
+     ES_BroadcastQueryLagging
+
+ Returns
+     uint8_t, the priority of the subscriber that held up the last refused
+     post, BROADCAST_NO_SUBSCRIBER if no post has been refused
+****************************************************************************/
+uint8_t ES_BroadcastQueryLagging ( void )
+{
+	return Lagging;
+}
+
+/****************************************************************************
+ Function
+     ES_BroadcastQueryOverflows
+
+ Parameters
+     uint8_t Priority : the subscriber to query
+
+ Returns
+     uint16_t, number of posts refused because this subscriber had not read
+     the oldest slot
+****************************************************************************/
+uint16_t ES_BroadcastQueryOverflows ( uint8_t Priority )
+{
+	if ( Priority >= MAX_NUM_SERVICES ) {
+		return 0;
+	}
+	return NumOverflows[Priority];
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     RingDoorbell
+
+ Description
+     Posts ES_BROADCAST to the subscriber. If its queue is full the bit is
+     left clear so the next post or fetch tries again.
+****************************************************************************/
+static bool RingDoorbell ( uint8_t Priority )
+{
+	ES_Event Bell;
+
+	Bell.EventType = ES_BROADCAST;
+	Bell.EventParam = 0;
+	if ( ES_QueueStatsPost( Priority, Bell ) == true ) {
+		Doorbell |= (1u << Priority);
+		return true;
+	}
+	return false;
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,23 @@
+/****************************************************************************
+
+  Header file for the broadcast ring (one copy multicast posting)
+
+ ****************************************************************************/
+
+#ifndef ES_BROADCAST_H
+#define ES_BROADCAST_H
+
+#include "ES_Configure.h" /* gets us the broadcast lists and ring size */
+#include "ES_Types.h"     /* gets bool type for returns */
+#include "ES_Events.h"
+
+// returned by ES_BroadcastQueryLagging when no subscriber has held up a post
+#define BROADCAST_NO_SUBSCRIBER 0xff
+
+// Public Function Prototypes
+bool ES_BroadcastPost ( uint16_t Subscribers, ES_Event ThisEvent );
+ES_Event ES_BroadcastFetch ( uint8_t Priority );
+uint8_t ES_BroadcastQueryLagging ( void );
+uint16_t ES_BroadcastQueryOverflows ( uint8_t Priority );
+
+#endif /* ES_BROADCAST_H */
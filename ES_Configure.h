@@ -24,19 +24,22 @@
 
 #define DEBUG_MAIN  1
 #define DEBUG_F1    0
-#define DEBUG_SEED  0  // flipbook1 + seed service
 #define DEBUG_F2    0  // flipbook2 service
 #define DEBUG_WATER 0  // water service checkers only
 #define DEBUG_F3    0
 #define DEBUG_AIR   0  // flipbook3 + air service
-#define DEBUG_IR    0  // IR event checkers only
-#define DEBUG_FLIP1SWITCH 0 //flipbook1 switch
-#define DEBUG_FLIP2SWITCH 0 //flipbook1 switch
-#define DEBUG_FLIP3SWITCH 0 //flipbook1 switch
+#define DEBUG_IR    0  // IR edge capture only
+#define DEBUG_SWITCHES 0 //seed, flipbook and fruit switch debouncing
 #define DEBUG_LED   0
 #define DEBUG_FRUIT 0  //Fruit Dispensing motor
-#define DEBUG_FRUIT_SWITCH   0  // debug fruit switch
+#define DEBUG_PWM   0  // batched PWM group setup
 #define DEBUG_ACC   0  // debug accelerometer readings
+#define DEBUG_BROADCAST 0 // broadcast ring overflows
+#define DEBUG_QUEUES 0 // dump service queue depth/peak/rejects after a reset
+#define ES_PROFILE 0 // time the run functions and event checkers (ES_Profile.c)
+#define ES_TRACE 0  // binary trace of posts, events, states and timers (ES_Trace.c)
+#define BENCH_TILT_FILTER 0 // time the Q15 tilt filter against the old double one at init, needs ES_PROFILE
+#define BENCH_TILT_SCALE 0  // time TiltCal_Scale against a divide at init, needs ES_PROFILE
 
 /****************************************************************************/
 // The maximum number of services sets an upper bound on the number of 
@@ -47,7 +50,7 @@
 /****************************************************************************/
 // This macro determines that nuber of services that are *actually* used in
 // a particular application. It will vary in value from 1 to MAX_NUM_SERVICES
-#define NUM_SERVICES 13
+#define NUM_SERVICES 9
 
 /****************************************************************************/
 // These are the definitions for Service 0, the lowest priority service.
@@ -84,11 +87,11 @@
 // These are the definitions for Service 2
 #if NUM_SERVICES > 2
 // the header file with the public function prototypes
-#define SERV_2_HEADER "SeedService.h"
+#define SERV_2_HEADER "SwitchDebounceService.h"
 // the name of the Init function
-#define SERV_2_INIT InitSeedService
+#define SERV_2_INIT InitSwitchDebounceService
 // the name of the run function
-#define SERV_2_RUN RunSeedService
+#define SERV_2_RUN RunSwitchDebounceService
 // How big should this services Queue be?
 #define SERV_2_QUEUE_SIZE 3
 #endif
@@ -149,24 +152,24 @@
 // These are the definitions for Service 7
 #if NUM_SERVICES > 7
 // the header file with the public function prototypes
-#define SERV_7_HEADER "Flipbook1Switch.h"
+#define SERV_7_HEADER "LEDService.h"
 // the name of the Init function
-#define SERV_7_INIT InitFlip1Switch
+#define SERV_7_INIT InitLEDService
 // the name of the run function
-#define SERV_7_RUN RunFlip1Switch
+#define SERV_7_RUN RunLEDService
 // How big should this services Queue be?
-#define SERV_7_QUEUE_SIZE 3
+#define SERV_7_QUEUE_SIZE 5
 #endif
 
 /****************************************************************************/
 // These are the definitions for Service 8
 #if NUM_SERVICES > 8
 // the header file with the public function prototypes
-#define SERV_8_HEADER "Flipbook2Switch.h"
+#define SERV_8_HEADER "FruitDispenseService.h"
 // the name of the Init function
-#define SERV_8_INIT InitFlip2Switch
+#define SERV_8_INIT InitFruitService
 // the name of the run function
-#define SERV_8_RUN RunFlip2Switch
+#define SERV_8_RUN RunFruitService
 // How big should this services Queue be?
 #define SERV_8_QUEUE_SIZE 3
 #endif
@@ -175,11 +178,11 @@
 // These are the definitions for Service 9
 #if NUM_SERVICES > 9
 // the header file with the public function prototypes
-#define SERV_9_HEADER "Flipbook3Switch.h"
+#define SERV_9_HEADER "TestHarnessService9.h"
 // the name of the Init function
-#define SERV_9_INIT InitFlip3Switch
+#define SERV_9_INIT InitTestHarnessService9
 // the name of the run function
-#define SERV_9_RUN RunFlip3Switch
+#define SERV_9_RUN RunTestHarnessService9
 // How big should this services Queue be?
 #define SERV_9_QUEUE_SIZE 3
 #endif
@@ -188,24 +191,24 @@
 // These are the definitions for Service 10
 #if NUM_SERVICES > 10
 // the header file with the public function prototypes
-#define SERV_10_HEADER "LEDService.h"
+#define SERV_10_HEADER "TestHarnessService10.h"
 // the name of the Init function
-#define SERV_10_INIT InitLEDService
+#define SERV_10_INIT InitTestHarnessService10
 // the name of the run function
-#define SERV_10_RUN RunLEDService
+#define SERV_10_RUN RunTestHarnessService10
 // How big should this services Queue be?
-#define SERV_10_QUEUE_SIZE 5
+#define SERV_10_QUEUE_SIZE 3
 #endif
 
 /****************************************************************************/
 // These are the definitions for Service 11
 #if NUM_SERVICES > 11
 // the header file with the public function prototypes
-#define SERV_11_HEADER "FruitDispenseService.h"
+#define SERV_11_HEADER "TestHarnessService11.h"
 // the name of the Init function
-#define SERV_11_INIT InitFruitService
+#define SERV_11_INIT InitTestHarnessService11
 // the name of the run function
-#define SERV_11_RUN RunFruitService
+#define SERV_11_RUN RunTestHarnessService11
 // How big should this services Queue be?
 #define SERV_11_QUEUE_SIZE 3
 #endif
@@ -214,11 +217,11 @@
 // These are the definitions for Service 12
 #if NUM_SERVICES > 12
 // the header file with the public function prototypes
-#define SERV_12_HEADER "FruitSwitch.h"
+#define SERV_12_HEADER "TestHarnessService12.h"
 // the name of the Init function
-#define SERV_12_INIT InitFruitSwitch
+#define SERV_12_INIT InitTestHarnessService12
 // the name of the run function
-#define SERV_12_RUN RunFruitSwitch
+#define SERV_12_RUN RunTestHarnessService12
 // How big should this services Queue be?
 #define SERV_12_QUEUE_SIZE 3
 #endif
@@ -273,31 +276,25 @@ typedef enum {  ES_NO_EVENT = 0,
                 ES_SHORT_TIMEOUT, /* signals that a short timer has expired */
                 /* User-defined events start here */
 								ES_RESET,
-								ES_SeedSwitchDown,
-								ES_SeedSwitchUp,
 								ES_SEED_DETECTED,
 								ES_F1_DONE,
-								ES_Flipbook1SwitchDown,
-								ES_Flipbook1SwitchUp,
 								ES_WATER,
 								ES_NO_WATER,
+								ES_TILT_ENTER, // the bucket tipped past the water threshold
+								ES_TILT_EXIT,  // the bucket came back up past the hysteresis
 								ES_F2_DONE,
-								ES_Flipbook2SwitchDown,
-								ES_Flipbook2SwitchUp,
 								ES_F3_DONE,
-								ES_Flipbook3SwitchDown,
-								ES_Flipbook3SwitchUp,
 								ES_IR1_HI, 
 								ES_IR2_HI,
+								ES_WAVE_RATE,  // param: smoothed wave intensity, 0 to WAVE_INTENSITY_MAX
 								ES_AIR,
 								ES_NO_AIR,
 								ES_START_HARVEST,
 								ES_DONE_HARVEST,
 								ES_FR_DISP_DONE,
-								ES_FruitSwitchUp,
-								ES_FruitSwitchDown,
 								ES_CELEBRATION,
 								ES_DONE_INIT,  // services post this when they're ready to start
+								ES_BROADCAST,  // doorbell, fetch the event with ES_BroadcastFetch
                 ES_NEW_KEY /* signals a new key received from terminal */
                 } ES_EventTyp_t ;
 
@@ -305,11 +302,12 @@ typedef enum {  ES_NO_EVENT = 0,
 // These are the definitions for the Distribution lists. Each definition
 // should be a comma separated list of post functions to indicate which
 // services are on that distribution list. Summary:
-//    ES_PostList00  --> RESET list
-//    ES_PostList01  --> Celebration list
+//    ES_PostList00  --> RESET list (unused, ES_RESET goes to RESET_BROADCAST)
+//    ES_PostList01  --> Celebration list (unused, ES_CELEBRATION goes to
+//                       CELEBRATION_BROADCAST)
 //    ES_PostList02  --> F1 Done list
 //    ES_PostList03  --> Seed list
-//    ES_PostList04  --> Water list
+//    ES_PostList04  --> Water list (unused, ES_WATER goes to WATER_MAILBOX)
 //    ES_PostList05  --> F2 done list
 //    ES_PostList06  --> F3 done list
 //    ES_PostList07  --> Unused      
@@ -346,13 +344,65 @@ typedef enum {  ES_NO_EVENT = 0,
 #define DIST_LIST7 PostTemplateFSM
 #endif
 
+/****************************************************************************/
+// These are the definitions for the broadcast lists. A broadcast list is a
+// bitmask of the priorities (service numbers) of its subscribers, posting to
+// it with ES_BroadcastPost puts one copy of the event in a shared ring and
+// wakes each subscriber with an ES_BROADCAST event. Subscribers must call
+// ES_BroadcastFetch whenever ES_BROADCAST comes out of their queue.
+// BROADCAST_RING_SIZE is how many broadcasts can be waiting for the slowest
+// subscriber, it must be a power of 2, 64 or less.
+#define BROADCAST_RING_SIZE 8
+
+// RESET list: Air(0), Flip3(1), Flip1(3), Main(4), Water(5), Flip2(6),
+// LED(7), Fruit(8)
+#define RESET_BROADCAST ( (1u<<0) | (1u<<1) | (1u<<3) | (1u<<4) | \
+                          (1u<<5) | (1u<<6) | (1u<<7) | (1u<<8) )
+// CELEBRATION list: the same services
+#define CELEBRATION_BROADCAST RESET_BROADCAST
+// TILT list (ES_TILT_ENTER, ES_TILT_EXIT): Water(5), LED(7)
+#define TILT_BROADCAST ( (1u<<5) | (1u<<7) )
+
+/****************************************************************************/
+// Size of the event trace ring (ES_Trace) in 8 byte records, a power of 2.
+// Only used when ES_TRACE is set.
+#define TRACE_RING_SIZE 256
+
+/****************************************************************************/
+// These are the definitions for the state mailboxes. A mailbox only holds the
+// latest event posted to it: posting while a subscriber still has an
+// unfetched copy in its queue overwrites the value instead of queuing another
+// event. Use these for sampled values where only the freshest one matters.
+// Subscribers call ES_MailboxSubscribe in their Init function and must call
+// ES_MailboxFetch whenever the mailbox event comes out of their queue.
+#define NUM_MAILBOXES 1
+
+// Give the mailboxes symbolic names
+// WATER_MAILBOX: ES_WATER tilt samples, read by Flipbook2Service and
+//                LEDService. Only posted when the tilt moves more than
+//                WATER_DELTA (WaterBucketService.c)
+#define WATER_MAILBOX 0
+
 /****************************************************************************/
 // This are the name of the Event checking funcion header file. 
-#define EVENT_CHECK_HEADER "AllEventCheckers.h"
+#define USER_CHECK_HEADER "AllEventCheckers.h"
 
 /****************************************************************************/
 // This is the list of event checking functions 
-#define EVENT_CHECK_LIST Check4Keystroke, Check4IR_1, Check4IR_2, CheckSeedSwitchEvents, Check4Water, CheckFlip1SwitchEvents,CheckFlip2SwitchEvents, CheckFlip3SwitchEvents, CheckFruitSwitchEvents
+// (the switches are sampled by SwitchDebounceService on its own timer,
+// Check4SoftTimers posts the timeouts of the soft timers, and the keystrokes
+// go to WaterBucketService for the tilt calibration)
+#define USER_CHECK_LIST Check4CalibrationKey, CheckIREdges, Check4Water, Check4SoftTimers
+
+// When profiling, the framework only sees ES_ProfileCheckEvents, which times
+// and calls the checkers above
+#if ES_PROFILE
+#define EVENT_CHECK_HEADER "ES_Profile.h"
+#define EVENT_CHECK_LIST ES_ProfileCheckEvents
+#else
+#define EVENT_CHECK_HEADER USER_CHECK_HEADER
+#define EVENT_CHECK_LIST USER_CHECK_LIST
+#endif
 
 /****************************************************************************/
 // These are the definitions for the post functions to be executed when the
@@ -360,46 +410,61 @@ typedef enum {  ES_NO_EVENT = 0,
 // a timer, then you should use TIMER_UNUSED
 // Unlike services, any combination of timers may be used and there is no
 // priority in servicing them
+// All of the services use the soft timers below, so the 16 framework timers
+// are free
 #define TIMER_UNUSED ((pPostFunc)0)
-#define TIMER0_RESP_FUNC PostSeedService
-#define TIMER1_RESP_FUNC PostFlip3Service
-#define TIMER2_RESP_FUNC PostMainService
-#define TIMER3_RESP_FUNC PostMainService
-#define TIMER4_RESP_FUNC PostFlip1Switch
-#define TIMER5_RESP_FUNC PostFlip2Switch
-#define TIMER6_RESP_FUNC PostFlip3Switch
-#define TIMER7_RESP_FUNC PostLEDService
-#define TIMER8_RESP_FUNC PostLEDService
-#define TIMER9_RESP_FUNC PostLEDService
-#define TIMER10_RESP_FUNC PostLEDService
-#define TIMER11_RESP_FUNC PostLEDService
-#define TIMER12_RESP_FUNC PostLEDService
-#define TIMER13_RESP_FUNC PostLEDService
-#define TIMER14_RESP_FUNC PostFruitSwitch
-#define TIMER15_RESP_FUNC PostLEDService
+#define TIMER0_RESP_FUNC TIMER_UNUSED
+#define TIMER1_RESP_FUNC TIMER_UNUSED
+#define TIMER2_RESP_FUNC TIMER_UNUSED
+#define TIMER3_RESP_FUNC TIMER_UNUSED
+#define TIMER4_RESP_FUNC TIMER_UNUSED
+#define TIMER5_RESP_FUNC TIMER_UNUSED
+#define TIMER6_RESP_FUNC TIMER_UNUSED
+#define TIMER7_RESP_FUNC TIMER_UNUSED
+#define TIMER8_RESP_FUNC TIMER_UNUSED
+#define TIMER9_RESP_FUNC TIMER_UNUSED
+#define TIMER10_RESP_FUNC TIMER_UNUSED
+#define TIMER11_RESP_FUNC TIMER_UNUSED
+#define TIMER12_RESP_FUNC TIMER_UNUSED
+#define TIMER13_RESP_FUNC TIMER_UNUSED
+#define TIMER14_RESP_FUNC TIMER_UNUSED
+#define TIMER15_RESP_FUNC TIMER_UNUSED
 
 /****************************************************************************/
-// Give the timer numbers symbolc names to make it easier to move them
-// to different timers if the need arises. Keep these definitions close to the
-// definitions for the response functions to make it easier to check that
-// the timer number matches where the timer event will be routed
-// These symbolic names should be changed to be relevant to your application 
-
-#define SEED_TIMER             0
-#define FLIPBOOK3_INIT_TIMER   1   //timer for briefly starting the flipbook
-#define GAME_TIMER             2
-#define CELEB_TIMER            3
-#define FLIPBOOK1_SWITCH_TIMER 4
-#define FLIPBOOK2_SWITCH_TIMER 5
-#define FLIPBOOK3_SWITCH_TIMER 6
-#define SEED_LED_TIMER    		 7
-#define RampF1LEDS_TIMER       8
-#define RampF2LEDS_TIMER       9 
-#define RampF3LEDS_TIMER      10
-#define RampWaterLEDS_TIMER   11
-#define BlinkAllLEDS_TIMER    12
-#define BlinkWaterLEDS_TIMER  13
-#define FRUIT_SWITCH_TIMER		14
-#define BlinkSeedLEDS_TIMER   15
+// These are the definitions for the soft timers (ES_SoftTimers). There is no
+// fixed number of them: each service lists the timers it owns as
+// SOFT_TIMER( Name, PostFunction ) in its SERV_n_SOFT_TIMERS list, and
+// SOFT_TIMER_LIST collects the lists of all of the services. When a timer
+// expires ES_TIMEOUT is posted to the PostFunction with the Name in
+// EventParam. Start them with ES_SoftTimer_InitTimer (one shot) or
+// ES_SoftTimer_InitPeriodic.
+
+// Service 1, Flipbook3Service
+#define SERV_1_SOFT_TIMERS \
+	SOFT_TIMER( FLIPBOOK3_INIT_TIMER, PostFlip3Service ) /* briefly starting the flipbook */
+
+// Service 2, SwitchDebounceService
+#define SERV_2_SOFT_TIMERS \
+	SOFT_TIMER( DEBOUNCE_TIMER, PostSwitchDebounceService ) /* switch sample tick */
+
+// Service 4, MainStoryService
+#define SERV_4_SOFT_TIMERS \
+	SOFT_TIMER( GAME_TIMER, PostMainService ) \
+	SOFT_TIMER( CELEB_TIMER, PostMainService )
+
+// Service 7, LEDService, has none: its blinks, ramps and fades run on the
+// LEDAnimator timer interrupt
+
+#define SOFT_TIMER_LIST SERV_1_SOFT_TIMERS SERV_2_SOFT_TIMERS SERV_4_SOFT_TIMERS
+
+// Give the soft timers their numbers. They start after the 16 framework
+// timers so the two kinds of ES_TIMEOUT can not be confused.
+#define SOFT_TIMER( Name, PostFunc ) Name,
+typedef enum { SOFT_TIMER_BEFORE_FIRST = 15,
+               SOFT_TIMER_LIST
+               SOFT_TIMER_AFTER_LAST } ES_SoftTimerName_t;
+#undef SOFT_TIMER
+#define FIRST_SOFT_TIMER (SOFT_TIMER_BEFORE_FIRST + 1)
+#define NUM_SOFT_TIMERS (SOFT_TIMER_AFTER_LAST - FIRST_SOFT_TIMER)
 
 #endif /* CONFIGURE_H */
@@ -0,0 +1,190 @@
+/****************************************************************************
+ Module
+     ES_Mailbox.c
+
+ Description
+     Latest-value ("state mailbox") posting for the Events and Services
+     framework. A mailbox holds a single event. Posting to it overwrites the
+     stored event and only enqueues a copy to a subscriber that does not
+     already have one waiting in its queue, so a subscriber's queue never
+     holds more than one event from a given mailbox and, when that event is
+     dequeued, the subscriber fetches the freshest value posted so far.
+
+ Notes
+     Subscribers are identified by their service priority (the same number
+     used with ES_PostToService), so a mailbox can have up to
+     MAX_NUM_SERVICES subscribers.
+     The subscriber MUST call ES_MailboxFetch every time the mailbox event
+     comes out of its queue, in every state, otherwise the mailbox will
+     consider the sample still pending and never post to it again. The
+     simplest way is to do the fetch at the top of the Run function, before
+     the switch on CurrentState.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_QueueStats.h"
+#include "ES_Mailbox.h"
+#include "ES_Trace.h"
+
+/*---------------------------- Module Variables ---------------------------*/
+// the most recent event posted to each mailbox
+static ES_Event Latest[NUM_MAILBOXES];
+// bit n set means the service at priority n subscribes to the mailbox
+static uint16_t Subscribers[NUM_MAILBOXES];
+// bit n set means the service at priority n has the mailbox event in its
+// queue and has not fetched it yet
+static uint16_t Pending[NUM_MAILBOXES];
+// per subscriber counts of samples handed over vs. overwritten while pending
+static uint32_t NumDelivered[NUM_MAILBOXES][MAX_NUM_SERVICES];
+static uint32_t NumCoalesced[NUM_MAILBOXES][MAX_NUM_SERVICES];
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_MailboxSubscribe
+
+ Parameters
+     uint8_t WhichBox : the mailbox to subscribe to
+     uint8_t Priority : the priority of the subscribing service
+
+ Returns
+     bool, false if either parameter is out of range, true otherwise
+
+ Description
+     Adds the service to the mailbox's subscriber list. Normally called
+     from the service's Init function.
+****************************************************************************/
+bool ES_MailboxSubscribe ( uint8_t WhichBox, uint8_t Priority )
+{
+	if ( (WhichBox >= NUM_MAILBOXES) || (Priority >= MAX_NUM_SERVICES) ) {
+		return false;
+	}
+	Subscribers[WhichBox] |= (1u << Priority);
+	Pending[WhichBox] &= ~(1u << Priority);
+	return true;
+}
+
+/****************************************************************************
+ Function
+     ES_MailboxPost
+
+ Parameters
+     uint8_t WhichBox : the mailbox to post to
+     ES_Event ThisEvent : the event to post
+
+ Returns
+     bool, false if the mailbox number is out of range or a subscriber's
+     queue rejected the event, true otherwise
+
+ Description
+     Stores ThisEvent as the mailbox's latest value. Subscribers that already
+     have the mailbox event waiting in their queue just have their sample
+     overwritten (coalesced), the others get the event posted to them.
+****************************************************************************/
+bool ES_MailboxPost ( uint8_t WhichBox, ES_Event ThisEvent )
+{
+	bool ReturnVal = true;
+	uint16_t Remaining;
+	uint8_t Priority;
+
+	if ( WhichBox >= NUM_MAILBOXES ) {
+		return false;
+	}
+
+	// overwrite the stored sample, this is what every subscriber will fetch
+	Latest[WhichBox] = ThisEvent;
+
+	// walk the subscriber bits
+	Remaining = Subscribers[WhichBox];
+	for ( Priority = 0; Remaining != 0; Priority++, Remaining >>= 1 ) {
+		if ( (Remaining & 1) == 0 ) {
+			continue;
+		}
+		// if the subscriber still has an unfetched sample, just coalesce
+		if ( (Pending[WhichBox] & (1u << Priority)) != 0 ) {
+			NumCoalesced[WhichBox][Priority]++;
+		}
+		// else post a copy and remember that one is now waiting
+		else if ( ES_QueueStatsPost( Priority, ThisEvent ) == true ) {
+			Pending[WhichBox] |= (1u << Priority);
+		} else {
+			// queue full, leave it not-pending so the next sample retries
+			ReturnVal = false;
+		}
+	}
+	return ReturnVal;
+}
+
+/****************************************************************************
+ Function
+     ES_MailboxFetch
+
+ Parameters
+     uint8_t WhichBox : the mailbox to read
+     uint8_t Priority : the priority of the calling service
+
+ Returns
+     ES_Event, the latest event posted to the mailbox
+
+ Description
+     Called by a subscriber when the mailbox event is dequeued. Returns the
+     freshest sample and re-arms posting to this subscriber.
+****************************************************************************/
+ES_Event ES_MailboxFetch ( uint8_t WhichBox, uint8_t Priority )
+{
+	ES_Event ReturnEvent;
+
+	if ( (WhichBox >= NUM_MAILBOXES) || (Priority >= MAX_NUM_SERVICES) ) {
+		ReturnEvent.EventType = ES_NO_EVENT;
+		return ReturnEvent;
+	}
+	Pending[WhichBox] &= ~(1u << Priority);
+	NumDelivered[WhichBox][Priority]++;
+	#if ES_TRACE
+	ES_TraceRecord( TRACE_FETCH, Priority, Latest[WhichBox].EventType, Latest[WhichBox].EventParam );
+	#endif
+	return Latest[WhichBox];
+}
+
+/****************************************************************************
+ Function
+     ES_MailboxQueryDelivered
+
+ Parameters
+     uint8_t WhichBox : the mailbox to query
+     uint8_t Priority : the subscriber to query
+
+ Returns
+     uint32_t, number of samples the subscriber has fetched since boot
+****************************************************************************/
+uint32_t ES_MailboxQueryDelivered ( uint8_t WhichBox, uint8_t Priority )
+{
+	if ( (WhichBox >= NUM_MAILBOXES) || (Priority >= MAX_NUM_SERVICES) ) {
+		return 0;
+	}
+	return NumDelivered[WhichBox][Priority];
+}
+
+/****************************************************************************
+ Function
+     ES_MailboxQueryCoalesced
+
+ Parameters
+     uint8_t WhichBox : the mailbox to query
+     uint8_t Priority : the subscriber to query
+
+ Returns
+     uint32_t, number of samples that were overwritten before the subscriber
+     fetched them
+****************************************************************************/
+uint32_t ES_MailboxQueryCoalesced ( uint8_t WhichBox, uint8_t Priority )
+{
+	if ( (WhichBox >= NUM_MAILBOXES) || (Priority >= MAX_NUM_SERVICES) ) {
+		return 0;
+	}
+	return NumCoalesced[WhichBox][Priority];
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
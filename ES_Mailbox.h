@@ -0,0 +1,21 @@
+/****************************************************************************
+
+  Header file for the state mailboxes (latest-value posting)
+
+ ****************************************************************************/
+
+#ifndef ES_MAILBOX_H
+#define ES_MAILBOX_H
+
+#include "ES_Configure.h" /* gets us NUM_MAILBOXES and the mailbox names */
+#include "ES_Types.h"     /* gets bool type for returns */
+#include "ES_Events.h"
+
+// Public Function Prototypes
+bool ES_MailboxSubscribe ( uint8_t WhichBox, uint8_t Priority );
+bool ES_MailboxPost ( uint8_t WhichBox, ES_Event ThisEvent );
+ES_Event ES_MailboxFetch ( uint8_t WhichBox, uint8_t Priority );
+uint32_t ES_MailboxQueryDelivered ( uint8_t WhichBox, uint8_t Priority );
+uint32_t ES_MailboxQueryCoalesced ( uint8_t WhichBox, uint8_t Priority );
+
+#endif /* ES_MAILBOX_H */
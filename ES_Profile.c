@@ -0,0 +1,339 @@
+/****************************************************************************
+ Module
+     ES_Profile.c
+
+ Description
+     Run time profiler for the services and event checkers. Every call of a
+     service's Run function and of each function in the event checker list
+     is timed in CPU cycles, and for each of them the profiler keeps the
+     number of calls, the min, max and mean time and a histogram with one
+     bin per power of 2 cycles, so a rare slow call stands out from the
+     usual ones.
+
+ Notes
+     Only compiled in when ES_PROFILE is set in ES_Configure.h.
+     On the TM4C the time is the DWT cycle counter (CYCCNT), which counts
+     every core clock and wraps every 107s at 40MHz; one call never takes
+     that long, so the unsigned difference of two reads is always right.
+     Anywhere else (a simulated build on the PC) clock() stands in for it,
+     scaled to ES_PROFILE_CPU_HZ, so the numbers are in the same units but
+     only as fine as the host clock.
+     The framework's event checking loop is not part of this project, so
+     with ES_PROFILE set ES_Configure.h hands it ES_ProfileCheckEvents as the
+     only checker. It calls USER_CHECK_LIST in order and stops at the first
+     one that finds an event, the same as the framework does.
+     The Run functions are timed by ES_QueueStatsRun, which every service's
+     Run function goes through: it calls ES_ProfileRunStart before the
+     service's handler and ES_ProfileRunEnd after it returns. Run functions
+     never call each other, so one start time is enough.
+     ES_ProfileDump prints the tables to the serial port.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Profile.h"
+
+#if ES_PROFILE
+
+#include USER_CHECK_HEADER
+#include "ES_SoftTimers.h"
+
+#if defined(__arm__) || defined(__ARMCC_VERSION)
+#include "inc/hw_types.h"
+#define ON_TARGET 1
+#else
+#include <time.h>
+#define ON_TARGET 0
+#endif
+
+/*----------------------------- Module Defines ----------------------------*/
+// the core clock, only used to scale the stand in clock
+#define ES_PROFILE_CPU_HZ 40000000UL
+
+// Cortex-M debug registers for the cycle counter
+#define DEMCR       0xE000EDFC
+#define DEMCR_TRCENA 0x01000000
+#define DWT_CTRL    0xE0001000
+#define DWT_CYCCNTENA 0x00000001
+#define DWT_CYCCNT  0xE0001004
+
+#define STRINGIFY(...) #__VA_ARGS__
+#define LIST_TO_STRING(...) STRINGIFY(__VA_ARGS__)
+
+/*---------------------------- Module Types -------------------------------*/
+typedef bool CheckFunc_t( void );
+
+typedef struct {
+	uint32_t Count;
+	uint32_t Min;
+	uint32_t Max;
+	uint64_t Sum;
+	uint16_t Hist[ES_PROFILE_BINS];
+} ProfileStats_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void Record ( ProfileStats_t *pStats, uint32_t Cycles );
+static void ClearStats ( ProfileStats_t *pStats );
+static void PrintStats ( char Kind, uint8_t Index, const ProfileStats_t *pStats );
+
+/*---------------------------- Module Variables ---------------------------*/
+static CheckFunc_t * const Checkers[] = { USER_CHECK_LIST };
+#define NUM_CHECKERS (sizeof(Checkers)/sizeof(Checkers[0]))
+
+static ProfileStats_t RunStats[NUM_SERVICES];
+static ProfileStats_t CheckStats[NUM_CHECKERS];
+
+// cycle count when the current Run function was entered
+static uint32_t RunStart;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_ProfileInit
+
+ Description
+     Starts the cycle counter and clears the statistics. Call it once,
+     before the framework starts running the services.
+****************************************************************************/
+void ES_ProfileInit ( void )
+{
+#if ON_TARGET
+	//turn on the trace block, then zero and start the cycle counter
+	HWREG(DEMCR) |= DEMCR_TRCENA;
+	HWREG(DWT_CYCCNT) = 0;
+	HWREG(DWT_CTRL) |= DWT_CYCCNTENA;
+#endif
+	ES_ProfileClear();
+}
+
+/****************************************************************************
+ Function
+     ES_ProfileGetCycles
+
+ Returns
+     uint32_t, the cycle counter, or the stand in clock off the target, for
+     timing code by hand
+****************************************************************************/
+uint32_t ES_ProfileGetCycles ( void )
+{
+#if ON_TARGET
+	return HWREG(DWT_CYCCNT);
+#else
+	return (uint32_t)( (uint64_t)clock() * ES_PROFILE_CPU_HZ / CLOCKS_PER_SEC );
+#endif
+}
+
+/****************************************************************************
+ Function
+     ES_ProfileRunStart
+
+ Description
+     Called by ES_QueueStatsRun before a service's handler, notes the time
+****************************************************************************/
+void ES_ProfileRunStart ( void )
+{
+	RunStart = ES_ProfileGetCycles();
+}
+
+/****************************************************************************
+ Function
+     ES_ProfileRunEnd
+
+ Parameters
+     uint8_t Priority : the priority of the service whose Run is returning
+
+ Description
+     Called by ES_QueueStatsRun after the handler returns, records how long
+     it took
+****************************************************************************/
+void ES_ProfileRunEnd ( uint8_t Priority )
+{
+	uint32_t Cycles = ES_ProfileGetCycles() - RunStart;
+
+	if ( Priority < NUM_SERVICES ) {
+		Record( &RunStats[Priority], Cycles );
+	}
+}
+
+/****************************************************************************
+ Function
+     ES_ProfileQueryRunMin, ES_ProfileQueryRunMax, ES_ProfileQueryRunMean
+
+ Returns
+     uint32_t, the shortest, longest and mean Run time of the service in
+     cycles, 0 if it has not run
+****************************************************************************/
+uint32_t ES_ProfileQueryRunMin ( uint8_t Priority )
+{
+	if ( (Priority >= NUM_SERVICES) || (RunStats[Priority].Count == 0) ) {
+		return 0;
+	}
+	return RunStats[Priority].Min;
+}
+
+uint32_t ES_ProfileQueryRunMax ( uint8_t Priority )
+{
+	if ( Priority >= NUM_SERVICES ) {
+		return 0;
+	}
+	return RunStats[Priority].Max;
+}
+
+uint32_t ES_ProfileQueryRunMean ( uint8_t Priority )
+{
+	if ( (Priority >= NUM_SERVICES) || (RunStats[Priority].Count == 0) ) {
+		return 0;
+	}
+	return (uint32_t)(RunStats[Priority].Sum / RunStats[Priority].Count);
+}
+
+/****************************************************************************
+ Function
+     ES_ProfileCheckEvents
+
+ Returns
+     bool, true if one of the event checkers found an event
+
+ Description
+     Runs the event checkers in USER_CHECK_LIST in order, timing each one,
+     and stops at the first one that returns true
+****************************************************************************/
+bool ES_ProfileCheckEvents ( void )
+{
+	uint8_t i;
+	uint32_t Start;
+	bool Found;
+
+	for ( i = 0; i < NUM_CHECKERS; i++ ) {
+		Start = ES_ProfileGetCycles();
+		Found = Checkers[i]();
+		Record( &CheckStats[i], ES_ProfileGetCycles() - Start );
+		if ( Found == true ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/****************************************************************************
+ Function
+     ES_ProfileClear
+
+ Description
+     Starts all the statistics over
+****************************************************************************/
+void ES_ProfileClear ( void )
+{
+	uint8_t i;
+
+	for ( i = 0; i < NUM_SERVICES; i++ ) {
+		ClearStats( &RunStats[i] );
+	}
+	for ( i = 0; i < NUM_CHECKERS; i++ ) {
+		ClearStats( &CheckStats[i] );
+	}
+}
+
+/****************************************************************************
+ Function
+     ES_ProfileDump
+
+ Description
+     Prints a line per service (S<priority>) and per event checker
+     (C<index in USER_CHECK_LIST>): calls, min, mean and max cycles, then
+     the histogram as bin:count for the bins that are not empty
+****************************************************************************/
+void ES_ProfileDump ( void )
+{
+	uint8_t i;
+
+	printf("Profile (cycles), checkers: %s\n\r", LIST_TO_STRING(USER_CHECK_LIST));
+	printf("      calls     min    mean     max  log2 histogram\n\r");
+	for ( i = 0; i < NUM_SERVICES; i++ ) {
+		PrintStats( 'S', i, &RunStats[i] );
+	}
+	for ( i = 0; i < NUM_CHECKERS; i++ ) {
+		PrintStats( 'C', i, &CheckStats[i] );
+	}
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     Record
+
+ Description
+     Adds one timed call to the statistics
+****************************************************************************/
+static void Record ( ProfileStats_t *pStats, uint32_t Cycles )
+{
+	uint8_t Bin = 0;
+	uint32_t Rest = Cycles;
+
+	pStats->Count++;
+	pStats->Sum += Cycles;
+	if ( Cycles < pStats->Min ) {
+		pStats->Min = Cycles;
+	}
+	if ( Cycles > pStats->Max ) {
+		pStats->Max = Cycles;
+	}
+
+	//bin is the position of the highest set bit (0 and 1 cycle share bin 0)
+	while ( Rest > 1 ) {
+		Rest >>= 1;
+		Bin++;
+	}
+	//stop counting at the top rather than wrap back to 0
+	if ( pStats->Hist[Bin] != 0xffff ) {
+		pStats->Hist[Bin]++;
+	}
+}
+
+/****************************************************************************
+ Function
+     ClearStats
+****************************************************************************/
+static void ClearStats ( ProfileStats_t *pStats )
+{
+	uint8_t Bin;
+
+	pStats->Count = 0;
+	pStats->Min = 0xffffffff;
+	pStats->Max = 0;
+	pStats->Sum = 0;
+	for ( Bin = 0; Bin < ES_PROFILE_BINS; Bin++ ) {
+		pStats->Hist[Bin] = 0;
+	}
+}
+
+/****************************************************************************
+ Function
+     PrintStats
+****************************************************************************/
+static void PrintStats ( char Kind, uint8_t Index, const ProfileStats_t *pStats )
+{
+	uint8_t Bin;
+
+	if ( pStats->Count == 0 ) {
+		printf("%c%-2u %8u       -       -       -\n\r", Kind, Index, 0u);
+		return;
+	}
+	printf("%c%-2u %8lu %7lu %7lu %7lu ", Kind, Index,
+	       (unsigned long)pStats->Count, (unsigned long)pStats->Min,
+	       (unsigned long)(pStats->Sum / pStats->Count),
+	       (unsigned long)pStats->Max);
+	for ( Bin = 0; Bin < ES_PROFILE_BINS; Bin++ ) {
+		if ( pStats->Hist[Bin] != 0 ) {
+			printf(" %u:%u", Bin, pStats->Hist[Bin]);
+		}
+	}
+	printf("\n\r");
+}
+
+#endif /* ES_PROFILE */
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
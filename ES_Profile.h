@@ -0,0 +1,31 @@
+/****************************************************************************
+
+  Header file for the run time profiler
+
+ ****************************************************************************/
+
+#ifndef ES_PROFILE_H
+#define ES_PROFILE_H
+
+#include "ES_Configure.h" /* gets us ES_PROFILE and the event checker list */
+#include "ES_Types.h"     /* gets bool type for returns */
+
+// one histogram bin per power of 2 cycles, bin n counts n.0 <= log2 < n+1
+#define ES_PROFILE_BINS 32
+
+// Public Function Prototypes
+void ES_ProfileInit ( void );
+uint32_t ES_ProfileGetCycles ( void );
+void ES_ProfileRunStart ( void );
+void ES_ProfileRunEnd ( uint8_t Priority );
+uint32_t ES_ProfileQueryRunMin ( uint8_t Priority );
+uint32_t ES_ProfileQueryRunMax ( uint8_t Priority );
+uint32_t ES_ProfileQueryRunMean ( uint8_t Priority );
+void ES_ProfileClear ( void );
+void ES_ProfileDump ( void );
+
+//Event checkers
+// stands in for the whole EVENT_CHECK_LIST when ES_PROFILE is set
+bool ES_ProfileCheckEvents ( void );
+
+#endif /* ES_PROFILE_H */
@@ -0,0 +1,265 @@
+/****************************************************************************
+ Module
+     ES_QueueStats.c
+
+ Description
+     Load statistics for the service queues: for every service the number
+     of events in its queue now, the most there have been since boot (or the
+     last ES_QueueStatsClear) and how many posts its full queue turned away.
+     Use the peaks to size SERV_n_QUEUE_SIZE from the load actually seen,
+     and the rejects to catch events lost in the field.
+
+ Notes
+     The framework's queues are not part of this project, so the counts are
+     kept from the outside: every post goes through ES_QueueStatsPost instead
+     of ES_PostToService, and every service's Run function hands the event
+     to ES_QueueStatsRun, which counts it out of the queue before calling
+     the service's own handler, since the framework calls Run once per
+     event it takes out of the queue.
+     The counts are only updated from the main loop (services and event
+     checkers), never from interrupts.
+     ES_QueueStatsDump prints the table to the serial port.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_QueueStats.h"
+#include "ES_Profile.h"
+#include "ES_Trace.h"
+
+/*---------------------------- Module Variables ---------------------------*/
+// the queue sizes from ES_Configure.h, for the dump
+static const uint8_t QueueSize[NUM_SERVICES] = {
+	SERV_0_QUEUE_SIZE,
+#if NUM_SERVICES > 1
+	SERV_1_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 2
+	SERV_2_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 3
+	SERV_3_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 4
+	SERV_4_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 5
+	SERV_5_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 6
+	SERV_6_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 7
+	SERV_7_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 8
+	SERV_8_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 9
+	SERV_9_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 10
+	SERV_10_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 11
+	SERV_11_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 12
+	SERV_12_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 13
+	SERV_13_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 14
+	SERV_14_QUEUE_SIZE,
+#endif
+#if NUM_SERVICES > 15
+	SERV_15_QUEUE_SIZE,
+#endif
+};
+
+static uint8_t Depth[NUM_SERVICES];
+static uint8_t Peak[NUM_SERVICES];
+static uint16_t Rejects[NUM_SERVICES];
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_QueueStatsPost
+
+ Parameters
+     uint8_t Priority : the service to post to
+     ES_Event ThisEvent : the event to post
+
+ Returns
+     bool, what ES_PostToService returned
+
+ Description
+     ES_PostToService, counting the event in the service's depth and peak
+     if it was taken and as a reject if it was not.
+****************************************************************************/
+bool ES_QueueStatsPost ( uint8_t Priority, ES_Event ThisEvent )
+{
+	if ( ES_PostToService( Priority, ThisEvent ) == true ) {
+		#if ES_TRACE
+		ES_TraceRecord( TRACE_POST, Priority, ThisEvent.EventType, ThisEvent.EventParam );
+		#endif
+		if ( Priority < NUM_SERVICES ) {
+			Depth[Priority]++;
+			if ( Depth[Priority] > Peak[Priority] ) {
+				Peak[Priority] = Depth[Priority];
+			}
+		}
+		return true;
+	}
+
+	#if ES_TRACE
+	ES_TraceRecord( TRACE_REJECT, Priority, ThisEvent.EventType, ThisEvent.EventParam );
+	#endif
+	if ( Priority < NUM_SERVICES ) {
+		Rejects[Priority]++;
+	}
+	return false;
+}
+
+/****************************************************************************
+ Function
+     ES_QueueStatsRun
+
+ Parameters
+     uint8_t Priority : the service whose Run function was just called
+     ES_Event ThisEvent : the event the framework took out of its queue
+     pServiceRun Run : the service's own event handler
+     pServiceState QueryState : the service's current state; a service
+         with no states gives one that returns 0
+
+ Returns
+     ES_Event, whatever Run returns
+
+ Description
+     The one place an event is dispatched to a service: counts it out of
+     the service's queue and then calls the service's handler, timed for
+     the profiler and traced with the state before and after. A service's
+     public Run function is just a call to this.
+****************************************************************************/
+ES_Event ES_QueueStatsRun ( uint8_t Priority, ES_Event ThisEvent, pServiceRun Run,
+                            pServiceState QueryState )
+{
+	ES_QueueStatsDequeued( Priority );
+	#if ES_PROFILE
+	ES_ProfileRunStart();
+	#endif
+	#if ES_TRACE
+	ES_TraceDequeue( Priority, ThisEvent, QueryState() );
+	#endif
+	ThisEvent = Run( ThisEvent );
+	#if ES_TRACE
+	ES_TraceState( Priority, QueryState() );
+	#endif
+	#if ES_PROFILE
+	ES_ProfileRunEnd( Priority );
+	#endif
+	return ThisEvent;
+}
+
+/****************************************************************************
+ Function
+     ES_QueueStatsDequeued
+
+ Parameters
+     uint8_t Priority : the service whose Run function was just called
+
+ Description
+     Counts one event out of the service's queue
+****************************************************************************/
+void ES_QueueStatsDequeued ( uint8_t Priority )
+{
+	if ( (Priority < NUM_SERVICES) && (Depth[Priority] > 0) ) {
+		Depth[Priority]--;
+	}
+}
+
+/****************************************************************************
+ Function
+     ES_QueueStatsQueryDepth
+
+ Returns
+     uint8_t, events in the service's queue now
+****************************************************************************/
+uint8_t ES_QueueStatsQueryDepth ( uint8_t Priority )
+{
+	if ( Priority >= NUM_SERVICES ) {
+		return 0;
+	}
+	return Depth[Priority];
+}
+
+/****************************************************************************
+ Function
+     ES_QueueStatsQueryPeak
+
+ Returns
+     uint8_t, the most events the service's queue has held
+****************************************************************************/
+uint8_t ES_QueueStatsQueryPeak ( uint8_t Priority )
+{
+	if ( Priority >= NUM_SERVICES ) {
+		return 0;
+	}
+	return Peak[Priority];
+}
+
+/****************************************************************************
+ Function
+     ES_QueueStatsQueryRejects
+
+ Returns
+     uint16_t, number of posts the service's queue was too full to take
+****************************************************************************/
+uint16_t ES_QueueStatsQueryRejects ( uint8_t Priority )
+{
+	if ( Priority >= NUM_SERVICES ) {
+		return 0;
+	}
+	return Rejects[Priority];
+}
+
+/****************************************************************************
+ Function
+     ES_QueueStatsClear
+
+ Description
+     Starts the peaks and rejects over, the depths are left alone since the
+     events are still in the queues
+****************************************************************************/
+void ES_QueueStatsClear ( void )
+{
+	uint8_t Priority;
+
+	for ( Priority = 0; Priority < NUM_SERVICES; Priority++ ) {
+		Peak[Priority] = Depth[Priority];
+		Rejects[Priority] = 0;
+	}
+}
+
+/****************************************************************************
+ Function
+     ES_QueueStatsDump
+
+ Description
+     Prints one line per service: size, depth, peak and rejects
+****************************************************************************/
+void ES_QueueStatsDump ( void )
+{
+	uint8_t Priority;
+
+	printf("Queue size depth peak rejects\n\r");
+	for ( Priority = 0; Priority < NUM_SERVICES; Priority++ ) {
+		printf("%5u %4u %5u %4u %7u%s\n\r", Priority, QueueSize[Priority],
+		       Depth[Priority], Peak[Priority], Rejects[Priority],
+		       (Peak[Priority] >= QueueSize[Priority]) ? " FULL" : "");
+	}
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
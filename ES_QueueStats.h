@@ -0,0 +1,30 @@
+/****************************************************************************
+
+  Header file for the service queue statistics
+
+ ****************************************************************************/
+
+#ifndef ES_QUEUE_STATS_H
+#define ES_QUEUE_STATS_H
+
+#include "ES_Configure.h" /* gets us NUM_SERVICES and the queue sizes */
+#include "ES_Types.h"     /* gets bool type for returns */
+#include "ES_Events.h"
+
+// a service's own event handling, and its current state for the trace,
+// called through ES_QueueStatsRun
+typedef ES_Event (*pServiceRun)( ES_Event ThisEvent );
+typedef uint8_t (*pServiceState)( void );
+
+// Public Function Prototypes
+bool ES_QueueStatsPost ( uint8_t Priority, ES_Event ThisEvent );
+ES_Event ES_QueueStatsRun ( uint8_t Priority, ES_Event ThisEvent, pServiceRun Run,
+                            pServiceState QueryState );
+void ES_QueueStatsDequeued ( uint8_t Priority );
+uint8_t ES_QueueStatsQueryDepth ( uint8_t Priority );
+uint8_t ES_QueueStatsQueryPeak ( uint8_t Priority );
+uint16_t ES_QueueStatsQueryRejects ( uint8_t Priority );
+void ES_QueueStatsClear ( void );
+void ES_QueueStatsDump ( void );
+
+#endif /* ES_QUEUE_STATS_H */
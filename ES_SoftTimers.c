@@ -0,0 +1,460 @@
+/****************************************************************************
+ Module
+     ES_SoftTimers.c
+
+ Description
+     Software timers for the Events and Services framework, kept in a
+     hierarchical timing wheel so there can be any number of them. The
+     timers are declared per service with SOFT_TIMER( Name, PostFunc ) in
+     ES_Configure.h. When a timer expires ES_TIMEOUT, with the timer Name in
+     EventParam, is posted to the post function it was declared with.
+     A timer runs either once (ES_SoftTimer_InitTimer) or periodically
+     (ES_SoftTimer_InitPeriodic) until it is stopped.
+
+ Notes
+     The wheel has 3 levels of 64 slots. Level 0 holds the timers due in the
+     next 64 ticks, one slot per tick, level 1 the ones due in the next 4096
+     ticks, 64 ticks per slot, and level 2 the rest, 4096 ticks per slot.
+     Every 64 ticks the next level 1 slot is moved down into level 0 (and
+     every 4096 ticks the next level 2 slot into level 1). Each slot is a
+     doubly linked list, so starting, stopping and expiring a timer are all
+     constant time no matter how many timers there are, and the cost of a
+     tick is one slot plus the timers actually due in it.
+     The tick is the framework's 1mS time (ES_Timer_GetTime). The tick
+     interrupt is not touched at all: Check4SoftTimers works out how many
+     ticks went by since it last ran and advances the wheel that many slots,
+     so it has to be in EVENT_CHECK_LIST.
+     Periodic reloads are drift free (the next deadline is the previous one
+     plus the period). For every timer the lateness of the last and worst
+     expiry, in ticks, is kept, along with the number of periods skipped
+     because the checker fell a whole period behind.
+     The timer Names are numbered from 16 up so a timeout from a soft timer
+     can never be mistaken for one from a framework timer.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_ServiceHeaders.h"  /* gets the post functions for the owner table */
+#include "ES_SoftTimers.h"
+#include "ES_Trace.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define SLOT_BITS   6
+#define NUM_SLOTS   (1u << SLOT_BITS)
+#define SLOT_MASK   (NUM_SLOTS - 1)
+#define NUM_LEVELS  3
+
+// list links hold the timer index + 1 so that 0 (the zeroed start-up value)
+// means the end of the list
+#define NIL 0
+
+// first slot of each level in Slots[]
+#define LEVEL0 0
+#define LEVEL1 NUM_SLOTS
+#define LEVEL2 (2*NUM_SLOTS)
+
+/*---------------------------- Module Functions ---------------------------*/
+static void Link ( uint16_t Index );
+static void Unlink ( uint16_t Index );
+static uint8_t Cascade ( uint16_t FirstSlot, uint8_t Slot );
+static bool RunSlot ( uint8_t Slot, uint32_t Now );
+static uint32_t CurrentTick ( void );
+
+/*---------------------------- Module Variables ---------------------------*/
+// who gets each timer's timeouts, straight from the SOFT_TIMER declarations
+#define SOFT_TIMER( Name, PostFunc ) PostFunc,
+static pPostFunc const OwnerPostFunc[NUM_SOFT_TIMERS] = { SOFT_TIMER_LIST };
+#undef SOFT_TIMER
+
+// the wheel, head of the list for every slot of every level
+static uint16_t Slots[NUM_LEVELS*NUM_SLOTS];
+
+// the timers, by index (Name - FIRST_SOFT_TIMER)
+static uint16_t Next[NUM_SOFT_TIMERS];
+static uint16_t Prev[NUM_SOFT_TIMERS];
+static uint8_t  InSlot[NUM_SOFT_TIMERS];   // which list the timer is on
+static bool     IsActive[NUM_SOFT_TIMERS];
+static uint32_t Expires[NUM_SOFT_TIMERS];  // tick the timer is due
+static uint16_t Period[NUM_SOFT_TIMERS];   // 0 for a one shot timer
+
+// jitter statistics, in ticks
+static uint16_t LastLateness[NUM_SOFT_TIMERS];
+static uint16_t MaxLateness[NUM_SOFT_TIMERS];
+static uint16_t NumMissed[NUM_SOFT_TIMERS];
+
+// the tick the wheel has been advanced to, and the framework time then
+static uint32_t WheelTime;
+static uint16_t LastTime;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_SoftTimer_InitTimer
+
+ Parameters
+     uint16_t Num : the soft timer to start
+     uint16_t NewTime : ticks until it expires
+
+ Returns
+     ES_Timer_ERR if the timer or time is not valid, ES_Timer_OK otherwise
+
+ Description
+     Starts (or restarts) the timer as a one shot
+****************************************************************************/
+ES_TimerReturn_t ES_SoftTimer_InitTimer ( uint16_t Num, uint16_t NewTime )
+{
+	uint16_t Index = Num - FIRST_SOFT_TIMER;
+
+	if ( (Num < FIRST_SOFT_TIMER) || (Index >= NUM_SOFT_TIMERS) || (NewTime == 0) ) {
+		return ES_Timer_ERR;
+	}
+	if ( IsActive[Index] == true ) {
+		Unlink( Index );
+	}
+	Expires[Index] = CurrentTick() + NewTime;
+	Period[Index] = 0;
+	IsActive[Index] = true;
+	Link( Index );
+	return ES_Timer_OK;
+}
+
+/****************************************************************************
+ Function
+     ES_SoftTimer_InitPeriodic
+
+ Parameters
+     uint16_t Num : the soft timer to start
+     uint16_t NewPeriod : ticks between timeouts
+
+ Returns
+     ES_Timer_ERR if the timer or period is not valid, ES_Timer_OK otherwise
+
+ Description
+     Starts (or restarts) the timer so it times out every NewPeriod ticks,
+     the first time one period from now
+****************************************************************************/
+ES_TimerReturn_t ES_SoftTimer_InitPeriodic ( uint16_t Num, uint16_t NewPeriod )
+{
+	uint16_t Index = Num - FIRST_SOFT_TIMER;
+
+	if ( (Num < FIRST_SOFT_TIMER) || (Index >= NUM_SOFT_TIMERS) || (NewPeriod == 0) ) {
+		return ES_Timer_ERR;
+	}
+	if ( IsActive[Index] == true ) {
+		Unlink( Index );
+	}
+	Expires[Index] = CurrentTick() + NewPeriod;
+	Period[Index] = NewPeriod;
+	IsActive[Index] = true;
+	Link( Index );
+	return ES_Timer_OK;
+}
+
+/****************************************************************************
+ Function
+     ES_SoftTimer_StopTimer
+
+ Parameters
+     uint16_t Num : the soft timer to stop
+
+ Returns
+     ES_Timer_ERR if the timer is not valid, ES_Timer_OK otherwise
+
+ Description
+     Stops the timer. A timeout that is already in the owner's queue is not
+     taken back.
+****************************************************************************/
+ES_TimerReturn_t ES_SoftTimer_StopTimer ( uint16_t Num )
+{
+	uint16_t Index = Num - FIRST_SOFT_TIMER;
+
+	if ( (Num < FIRST_SOFT_TIMER) || (Index >= NUM_SOFT_TIMERS) ) {
+		return ES_Timer_ERR;
+	}
+	if ( IsActive[Index] == true ) {
+		Unlink( Index );
+		IsActive[Index] = false;
+	}
+	return ES_Timer_OK;
+}
+
+/****************************************************************************
+ Function
+     ES_SoftTimer_IsActive
+
+ Returns
+     bool, true if the timer is running
+****************************************************************************/
+bool ES_SoftTimer_IsActive ( uint16_t Num )
+{
+	uint16_t Index = Num - FIRST_SOFT_TIMER;
+
+	if ( (Num < FIRST_SOFT_TIMER) || (Index >= NUM_SOFT_TIMERS) ) {
+		return false;
+	}
+	return IsActive[Index];
+}
+
+/****************************************************************************
+ Function
+     ES_SoftTimer_QueryLastLateness
+
+ Returns
+     uint16_t, ticks between the last deadline and when it was noticed
+****************************************************************************/
+uint16_t ES_SoftTimer_QueryLastLateness ( uint16_t Num )
+{
+	uint16_t Index = Num - FIRST_SOFT_TIMER;
+
+	if ( (Num < FIRST_SOFT_TIMER) || (Index >= NUM_SOFT_TIMERS) ) {
+		return 0;
+	}
+	return LastLateness[Index];
+}
+
+/****************************************************************************
+ Function
+     ES_SoftTimer_QueryMaxLateness
+
+ Returns
+     uint16_t, the worst lateness since the last ES_SoftTimer_ClearStats
+****************************************************************************/
+uint16_t ES_SoftTimer_QueryMaxLateness ( uint16_t Num )
+{
+	uint16_t Index = Num - FIRST_SOFT_TIMER;
+
+	if ( (Num < FIRST_SOFT_TIMER) || (Index >= NUM_SOFT_TIMERS) ) {
+		return 0;
+	}
+	return MaxLateness[Index];
+}
+
+/****************************************************************************
+ Function
+     ES_SoftTimer_QueryMissed
+
+ Returns
+     uint16_t, number of periods of a periodic timer that were skipped
+     because they were noticed a whole period or more late
+****************************************************************************/
+uint16_t ES_SoftTimer_QueryMissed ( uint16_t Num )
+{
+	uint16_t Index = Num - FIRST_SOFT_TIMER;
+
+	if ( (Num < FIRST_SOFT_TIMER) || (Index >= NUM_SOFT_TIMERS) ) {
+		return 0;
+	}
+	return NumMissed[Index];
+}
+
+/****************************************************************************
+ Function
+     ES_SoftTimer_ClearStats
+
+ Description
+     Zeroes the jitter statistics of the timer
+****************************************************************************/
+void ES_SoftTimer_ClearStats ( uint16_t Num )
+{
+	uint16_t Index = Num - FIRST_SOFT_TIMER;
+
+	if ( (Num < FIRST_SOFT_TIMER) || (Index >= NUM_SOFT_TIMERS) ) {
+		return;
+	}
+	LastLateness[Index] = 0;
+	MaxLateness[Index] = 0;
+	NumMissed[Index] = 0;
+}
+
+/****************************************************************************
+ Function
+     Check4SoftTimers
+
+ Parameters
+     Takes no parameters
+
+ Returns
+     bool, returns True if an event posted, false otherwise
+
+ Description
+     Event checker. Advances the wheel one slot for every tick since the
+     last call, moving timers down a level at the level boundaries and
+     posting the timeouts of the timers in each slot.
+****************************************************************************/
+bool Check4SoftTimers ( void )
+{
+	bool ReturnVal = false;
+	uint16_t Time;
+	uint32_t Now;
+	uint8_t Slot;
+
+	//how many ticks have gone by since the last pass
+	Time = ES_Timer_GetTime();
+	Now = WheelTime + (uint16_t)(Time - LastTime);
+	LastTime = Time;
+
+	while ( WheelTime != Now ) {
+		WheelTime++;
+		Slot = WheelTime & SLOT_MASK;
+		//at the start of a lap of level 0 bring down the next level 1 slot,
+		//and at the start of a lap of level 1 also the next level 2 slot
+		if ( Slot == 0 ) {
+			if ( Cascade( LEVEL1, (WheelTime >> SLOT_BITS) & SLOT_MASK ) == 0 ) {
+				Cascade( LEVEL2, (WheelTime >> (2*SLOT_BITS)) & SLOT_MASK );
+			}
+		}
+		if ( RunSlot( Slot, Now ) == true ) {
+			ReturnVal = true;
+		}
+	}
+	return ReturnVal;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     CurrentTick
+
+ Description
+     The wheel time plus the ticks that have gone by since the wheel was
+     last advanced, so timers started between passes are timed from now.
+****************************************************************************/
+static uint32_t CurrentTick ( void )
+{
+	return WheelTime + (uint16_t)(ES_Timer_GetTime() - LastTime);
+}
+
+/****************************************************************************
+ Function
+     Link
+
+ Description
+     Puts the timer on the list for its expiry time: level 0 if it is due
+     within 64 ticks of the wheel time, level 1 within 4096, else level 2.
+****************************************************************************/
+static void Link ( uint16_t Index )
+{
+	uint32_t Due = Expires[Index];
+	uint32_t Delta = Due - WheelTime;
+	uint16_t Slot;
+
+	if ( (int32_t)Delta <= 0 ) {
+		//due now, only happens to a timer cascading down into the slot that
+		//is about to be run
+		Slot = LEVEL0 + (WheelTime & SLOT_MASK);
+	} else if ( Delta < NUM_SLOTS ) {
+		Slot = LEVEL0 + (Due & SLOT_MASK);
+	} else if ( Delta < (NUM_SLOTS*NUM_SLOTS) ) {
+		Slot = LEVEL1 + ((Due >> SLOT_BITS) & SLOT_MASK);
+	} else {
+		Slot = LEVEL2 + ((Due >> (2*SLOT_BITS)) & SLOT_MASK);
+	}
+
+	//push on the front of the slot's list
+	InSlot[Index] = Slot;
+	Prev[Index] = NIL;
+	Next[Index] = Slots[Slot];
+	if ( Slots[Slot] != NIL ) {
+		Prev[Slots[Slot] - 1] = Index + 1;
+	}
+	Slots[Slot] = Index + 1;
+}
+
+/****************************************************************************
+ Function
+     Unlink
+
+ Description
+     Takes the timer off whichever list it is on
+****************************************************************************/
+static void Unlink ( uint16_t Index )
+{
+	if ( Prev[Index] != NIL ) {
+		Next[Prev[Index] - 1] = Next[Index];
+	} else {
+		Slots[InSlot[Index]] = Next[Index];
+	}
+	if ( Next[Index] != NIL ) {
+		Prev[Next[Index] - 1] = Prev[Index];
+	}
+}
+
+/****************************************************************************
+ Function
+     Cascade
+
+ Description
+     Empties one slot of an upper level, re-linking each of its timers, which
+     moves them down a level now that they are close enough. Returns the slot
+     number so the caller can tell when the level has wrapped.
+****************************************************************************/
+static uint8_t Cascade ( uint16_t FirstSlot, uint8_t Slot )
+{
+	uint16_t Entry = Slots[FirstSlot + Slot];
+	uint16_t Index;
+
+	Slots[FirstSlot + Slot] = NIL;
+	while ( Entry != NIL ) {
+		Index = Entry - 1;
+		Entry = Next[Index];
+		Link( Index );
+	}
+	return Slot;
+}
+
+/****************************************************************************
+ Function
+     RunSlot
+
+ Description
+     Expires every timer on a level 0 slot: posts its timeout and, if it is
+     periodic, re-links it one period after its deadline.
+****************************************************************************/
+static bool RunSlot ( uint8_t Slot, uint32_t Now )
+{
+	bool Posted = false;
+	uint16_t Entry = Slots[LEVEL0 + Slot];
+	uint16_t Index;
+	uint32_t Late;
+	ES_Event ThisEvent;
+
+	//take the whole list, anything re-linked goes in a later slot
+	Slots[LEVEL0 + Slot] = NIL;
+	while ( Entry != NIL ) {
+		Index = Entry - 1;
+		Entry = Next[Index];
+
+		Late = Now - Expires[Index];
+		LastLateness[Index] = (Late > 0xffff) ? 0xffff : (uint16_t)Late;
+		if ( LastLateness[Index] > MaxLateness[Index] ) {
+			MaxLateness[Index] = LastLateness[Index];
+		}
+
+		if ( Period[Index] != 0 ) {
+			//reload from the deadline, skipping whole periods we fell behind
+			Expires[Index] += Period[Index];
+			while ( (int32_t)(Expires[Index] - Now) <= 0 ) {
+				Expires[Index] += Period[Index];
+				NumMissed[Index]++;
+			}
+			Link( Index );
+		} else {
+			IsActive[Index] = false;
+		}
+
+		#if ES_TRACE
+		ES_TraceRecord( TRACE_TIMER, TRACE_NO_SERVICE, Index + FIRST_SOFT_TIMER,
+		                LastLateness[Index] );
+		#endif
+		ThisEvent.EventType = ES_TIMEOUT;
+		ThisEvent.EventParam = Index + FIRST_SOFT_TIMER;
+		OwnerPostFunc[Index]( ThisEvent );
+		Posted = true;
+	}
+	return Posted;
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
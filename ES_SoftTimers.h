@@ -0,0 +1,27 @@
+/****************************************************************************
+
+  Header file for the software timers (hierarchical timing wheel)
+
+ ****************************************************************************/
+
+#ifndef ES_SOFT_TIMERS_H
+#define ES_SOFT_TIMERS_H
+
+#include "ES_Configure.h" /* gets us the soft timer names and NUM_SOFT_TIMERS */
+#include "ES_Types.h"     /* gets bool type for returns */
+#include "ES_Framework.h" /* gets ES_TimerReturn_t */
+
+// Public Function Prototypes
+ES_TimerReturn_t ES_SoftTimer_InitTimer ( uint16_t Num, uint16_t NewTime );
+ES_TimerReturn_t ES_SoftTimer_InitPeriodic ( uint16_t Num, uint16_t NewPeriod );
+ES_TimerReturn_t ES_SoftTimer_StopTimer ( uint16_t Num );
+bool ES_SoftTimer_IsActive ( uint16_t Num );
+uint16_t ES_SoftTimer_QueryLastLateness ( uint16_t Num );
+uint16_t ES_SoftTimer_QueryMaxLateness ( uint16_t Num );
+uint16_t ES_SoftTimer_QueryMissed ( uint16_t Num );
+void ES_SoftTimer_ClearStats ( uint16_t Num );
+
+//Event checkers
+bool Check4SoftTimers ( void );
+
+#endif /* ES_SOFT_TIMERS_H */
@@ -0,0 +1,86 @@
+/****************************************************************************
+ Module
+     ES_TableFSM.c
+
+ Description
+     Table driven engine for flat state machines with superstates. A machine
+     is a const table (so it lives in flash) of states, each with the rows
+     of transitions it handles and a parent state. An event is looked up in
+     the rows of the current state; if none of them take it the parent's
+     rows are tried, then the grandparent's, and so on. So a transition that
+     many states share, like going back to Init on ES_RESET, is written
+     once in a superstate instead of in every state.
+
+ Notes
+     A superstate is just a state number that is a parent but never the
+     current state. The state is found by indexing the table, and only the
+     handful of rows of that state (and its parents) are compared, so the
+     cost of a dispatch does not grow with the number of states.
+     Rows are tried in order and the first match wins, so a row with a
+     guard has to come before a row for the same event without one.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_TableFSM.h"
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_FSM_Dispatch
+
+ Parameters
+     const ES_FSM_t *pMachine : the machine's state table
+     uint8_t CurrentState : the state the machine is in
+     ES_Event ThisEvent : the event to process
+
+ Returns
+     uint8_t, the state to be in after the event
+
+ Description
+     Finds the first row of the current state, or failing that of its
+     nearest superstate, that matches the event, runs its action and
+     returns its NextState. Events no state handles are dropped and the
+     machine stays where it is.
+****************************************************************************/
+uint8_t ES_FSM_Dispatch ( const ES_FSM_t *pMachine, uint8_t CurrentState,
+                          ES_Event ThisEvent )
+{
+	uint8_t State = CurrentState;
+	const ES_FSMRow_t *pRow;
+	uint8_t RowsLeft;
+
+	//walk out from the current state until a row takes the event, a state
+	//number past the end of the table (ES_FSM_NO_PARENT) ends the walk
+	while ( State < pMachine->NumStates ) {
+		pRow = pMachine->States[State].Rows;
+		for ( RowsLeft = pMachine->States[State].NumRows; RowsLeft != 0; RowsLeft--, pRow++ ) {
+			if ( pRow->EventType != ThisEvent.EventType ) {
+				continue;
+			}
+			if ( (pRow->EventParam != ES_FSM_ANY_PARAM) &&
+			     (pRow->EventParam != ThisEvent.EventParam) ) {
+				continue;
+			}
+			if ( (pRow->Guard != (ES_FSMGuard_t)0) && (pRow->Guard( ThisEvent ) == false) ) {
+				continue;
+			}
+
+			//found it, take the transition
+			if ( pRow->Action != (ES_FSMAction_t)0 ) {
+				pRow->Action( ThisEvent );
+			}
+			if ( pRow->NextState == ES_FSM_NO_CHANGE ) {
+				return CurrentState;
+			}
+			return pRow->NextState;
+		}
+		State = pMachine->States[State].Parent;
+	}
+
+	//nobody wanted it
+	return CurrentState;
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,58 @@
+/****************************************************************************
+
+  Header file for the table driven state machine engine
+
+ ****************************************************************************/
+
+#ifndef ES_TABLE_FSM_H
+#define ES_TABLE_FSM_H
+
+#include "ES_Configure.h" /* gets us event definitions */
+#include "ES_Types.h"     /* gets bool type for returns */
+
+// Parent of a top level state
+#define ES_FSM_NO_PARENT 0xff
+// NextState of a row that does not change state
+#define ES_FSM_NO_CHANGE 0xff
+// EventParam of a row that matches any parameter
+#define ES_FSM_ANY_PARAM 0xffff
+
+// a guard returns true if the row may be taken for this event
+typedef bool (*ES_FSMGuard_t)( ES_Event ThisEvent );
+// an action is run when its row is taken
+typedef void (*ES_FSMAction_t)( ES_Event ThisEvent );
+
+// one transition: when the event (and parameter) matches and the guard
+// passes, run the action and go to NextState
+typedef struct {
+	ES_EventTyp_t EventType;
+	uint16_t EventParam;     // or ES_FSM_ANY_PARAM
+	ES_FSMGuard_t Guard;     // or (ES_FSMGuard_t)0 for no guard
+	ES_FSMAction_t Action;   // or (ES_FSMAction_t)0 for no action
+	uint8_t NextState;       // or ES_FSM_NO_CHANGE
+} ES_FSMRow_t;
+
+// one state: its transitions and the superstate that handles anything the
+// state itself does not
+typedef struct {
+	uint8_t Parent;          // or ES_FSM_NO_PARENT
+	const ES_FSMRow_t *Rows;
+	uint8_t NumRows;
+} ES_FSMState_t;
+
+typedef struct {
+	const ES_FSMState_t *States; // indexed by state number
+	uint8_t NumStates;
+} ES_FSM_t;
+
+// fill in an ES_FSMState_t from a row array, or for a state with no rows
+#define ES_FSM_STATE( Parent, RowArray ) \
+	{ (Parent), (RowArray), (uint8_t)(sizeof(RowArray)/sizeof((RowArray)[0])) }
+#define ES_FSM_EMPTY_STATE( Parent ) \
+	{ (Parent), (const ES_FSMRow_t *)0, 0 }
+
+// Public Function Prototypes
+uint8_t ES_FSM_Dispatch ( const ES_FSM_t *pMachine, uint8_t CurrentState,
+                          ES_Event ThisEvent );
+
+#endif /* ES_TABLE_FSM_H */
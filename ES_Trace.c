@@ -0,0 +1,168 @@
+/****************************************************************************
+ Module
+     ES_Trace.c
+
+ Description
+     Binary event trace. Every post (and refused post), every event a Run
+     function gets, every event swapped in by a broadcast or mailbox fetch,
+     every state change, every soft timer expiry and every flipbook
+     revolution timed by SpinControl is written as an 8 byte record into a
+     ring in RAM: the time in ms, what happened, the service and the event
+     type and parameter. Writing a record is a handful of
+     stores, so unlike the DEBUG_ printfs turning the trace on does not
+     change the timing of what it is watching.
+
+ Notes
+     Only compiled in when ES_TRACE is set in ES_Configure.h.
+     The ring keeps the last TRACE_RING_SIZE records (a power of 2), older
+     ones are overwritten. ES_TraceFreeze( true ) stops recording so the
+     records leading up to a problem can be dumped without being pushed out.
+     ES_TraceDump prints the ring as hex, oldest first, between a TRACE and
+     an END TRACE line. Save the serial output to a file and run
+         python tools/trace_decode.py <file>
+     to turn it into a timeline with the event, state and timer names.
+     Records are only written from the main loop, never from interrupts.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Trace.h"
+
+#if ES_TRACE
+
+/*----------------------------- Module Defines ----------------------------*/
+#define RING_MASK (TRACE_RING_SIZE - 1)
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct {
+	uint16_t Time;
+	uint8_t Kind;
+	uint8_t Service;
+	uint16_t Type;
+	uint16_t Param;
+} TraceRecord_t;
+
+/*---------------------------- Module Variables ---------------------------*/
+static TraceRecord_t Ring[TRACE_RING_SIZE];
+// free running count of records written, slot number = Head & RING_MASK
+static uint16_t Head;
+// true once the ring has been filled, from then on every slot holds a record
+static bool IsFull;
+static bool IsFrozen;
+
+// state each service was in when its Run function was entered
+static uint8_t EntryState[NUM_SERVICES];
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     ES_TraceRecord
+
+ Parameters
+     uint8_t Kind : what happened, one of ES_TraceKind_t
+     uint8_t Service : the service it happened to
+     uint16_t Type, Param : what ES_TraceKind_t says for this Kind
+
+ Description
+     Writes one record into the ring, overwriting the oldest
+****************************************************************************/
+void ES_TraceRecord ( uint8_t Kind, uint8_t Service, uint16_t Type, uint16_t Param )
+{
+	TraceRecord_t *pRecord;
+
+	if ( IsFrozen == true ) {
+		return;
+	}
+	pRecord = &Ring[Head & RING_MASK];
+	pRecord->Time = ES_Timer_GetTime();
+	pRecord->Kind = Kind;
+	pRecord->Service = Service;
+	pRecord->Type = Type;
+	pRecord->Param = Param;
+	Head++;
+	if ( (Head & RING_MASK) == 0 ) {
+		IsFull = true;
+	}
+}
+
+/****************************************************************************
+ Function
+     ES_TraceDequeue
+
+ Parameters
+     uint8_t Priority : the service whose Run function was called
+     ES_Event ThisEvent : the event it was called with
+     uint8_t State : its state before handling the event
+
+ Description
+     Called by ES_QueueStatsRun before a service's handler. Records the
+     event and remembers the state, so ES_TraceState can tell whether the
+     event changed it.
+****************************************************************************/
+void ES_TraceDequeue ( uint8_t Priority, ES_Event ThisEvent, uint8_t State )
+{
+	if ( Priority < NUM_SERVICES ) {
+		EntryState[Priority] = State;
+	}
+	ES_TraceRecord( TRACE_DEQUEUE, Priority, ThisEvent.EventType, ThisEvent.EventParam );
+}
+
+/****************************************************************************
+ Function
+     ES_TraceState
+
+ Parameters
+     uint8_t Priority : the service whose Run function is returning
+     uint8_t State : its state after handling the event
+
+ Description
+     Called by ES_QueueStatsRun after the handler returns, records a state
+     change
+****************************************************************************/
+void ES_TraceState ( uint8_t Priority, uint8_t State )
+{
+	if ( (Priority < NUM_SERVICES) && (State != EntryState[Priority]) ) {
+		ES_TraceRecord( TRACE_STATE, Priority, EntryState[Priority], State );
+		EntryState[Priority] = State;
+	}
+}
+
+/****************************************************************************
+ Function
+     ES_TraceFreeze
+
+ Parameters
+     bool Frozen : true to stop recording, false to go on
+****************************************************************************/
+void ES_TraceFreeze ( bool Frozen )
+{
+	IsFrozen = Frozen;
+}
+
+/****************************************************************************
+ Function
+     ES_TraceDump
+
+ Description
+     Prints the ring oldest record first, one record per line as
+     time kind service type param, all in hex
+****************************************************************************/
+void ES_TraceDump ( void )
+{
+	uint16_t Count = (IsFull == true) ? TRACE_RING_SIZE : Head;
+	uint16_t Index;
+	TraceRecord_t *pRecord;
+
+	printf("TRACE %u\n\r", Count);
+	for ( Index = Head - Count; Index != Head; Index++ ) {
+		pRecord = &Ring[Index & RING_MASK];
+		printf("%04x %02x %02x %04x %04x\n\r", pRecord->Time, pRecord->Kind,
+		       pRecord->Service, pRecord->Type, pRecord->Param);
+	}
+	printf("END TRACE\n\r");
+}
+
+#endif /* ES_TRACE */
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,34 @@
+/****************************************************************************
+
+  Header file for the binary event trace
+
+ ****************************************************************************/
+
+#ifndef ES_TRACE_H
+#define ES_TRACE_H
+
+#include "ES_Configure.h" /* gets us ES_TRACE and TRACE_RING_SIZE */
+#include "ES_Types.h"     /* gets bool type for returns */
+#include "ES_Events.h"
+
+// what a trace record is about, tools/trace_decode.py knows these numbers
+typedef enum { TRACE_POST = 1,  // Service: posted to, Type/Param: the event
+               TRACE_REJECT,    // same, but the queue was full
+               TRACE_DEQUEUE,   // Service: whose Run got it, Type/Param: the event
+               TRACE_FETCH,     // the event a broadcast or mailbox fetch swapped in
+               TRACE_STATE,     // Service changed state, Type: from, Param: to
+               TRACE_TIMER,     // Service: 0xff, Type: timer number, Param: ms late
+               TRACE_SPIN       // Service: a flipbook, Type: revolution ms, Param: error ms (signed)
+             } ES_TraceKind_t ;
+
+// Service of a record that does not belong to one
+#define TRACE_NO_SERVICE 0xff
+
+// Public Function Prototypes
+void ES_TraceRecord ( uint8_t Kind, uint8_t Service, uint16_t Type, uint16_t Param );
+void ES_TraceDequeue ( uint8_t Priority, ES_Event ThisEvent, uint8_t State );
+void ES_TraceState ( uint8_t Priority, uint8_t State );
+void ES_TraceFreeze ( bool Frozen );
+void ES_TraceDump ( void );
+
+#endif /* ES_TRACE_H */
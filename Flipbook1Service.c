@@ -23,10 +23,15 @@
 */
 #include "ES_Configure.h"
 #include "ES_Framework.h"
+#include "ES_Broadcast.h"
+#include "ES_QueueStats.h"
+#include "ES_TableFSM.h"
 #include "TemplateService.h"
 
 // include the PWM library
 #include "PWM8Tiva.h"
+#include "PWMBatch.h"
+#include "SpinControl.h"
 
 // the headers to access the GPIO subsystem
 #include "inc/hw_memmap.h"
@@ -67,16 +72,65 @@
 #define HALF_SEC (ONE_SEC/2)
 #define TWO_SEC (ONE_SEC*2)
 #define FIVE_SEC (ONE_SEC*5)
+// the revolution time to hold while celebrating, tune it with the spin trace
+#define CELEB_PERIOD ONE_SEC
+
+// superstate of the running states, handles ES_RESET for all of them
+#define Flip1Running (Wait4ResetF1 + 1)
+#define NUM_F1_STATES (Flip1Running + 1)
 
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this service.They should be functions
    relevant to the behavior of this service
 */
+static ES_Event HandleFlip1Event ( ES_Event ThisEvent );
+static uint8_t QueryState ( void );
+static void StartPWM ( ES_Event ThisEvent );
+static void StartMotor ( ES_Event ThisEvent );
+static void StopMotor ( ES_Event ThisEvent );
+static void StartCelebration ( ES_Event ThisEvent );
+static void HoldSpinRate ( ES_Event ThisEvent );
+static void StartReset ( ES_Event ThisEvent );
+static void DoneResetting ( ES_Event ThisEvent );
 
 /*---------------------------- Module Variables ---------------------------*/
 // with the introduction of Gen2, we need a module level Priority variable
 static uint8_t MyPriority;
 static Flip1State_t CurrentState;
+// holds the revolution period while celebrating
+static SpinControl_t Spin;
+
+// the transitions of each state
+static const ES_FSMRow_t InitRows[] = {
+	{ ES_INIT,          ES_FSM_ANY_PARAM, 0, StartPWM,         Wait4Seed }
+};
+static const ES_FSMRow_t Wait4SeedRows[] = {
+	{ ES_SEED_DETECTED, ES_FSM_ANY_PARAM, 0, StartMotor,       Wait4Stop }
+};
+static const ES_FSMRow_t Wait4StopRows[] = {
+	{ ES_F1_DONE,       ES_FSM_ANY_PARAM, 0, StopMotor,        Wait4CelebrationF1 }
+};
+static const ES_FSMRow_t Wait4CelebrationRows[] = {
+	{ ES_CELEBRATION,   ES_FSM_ANY_PARAM, 0, StartCelebration, ES_FSM_NO_CHANGE },
+	{ ES_F1_DONE,       ES_FSM_ANY_PARAM, 0, HoldSpinRate,     ES_FSM_NO_CHANGE }
+};
+static const ES_FSMRow_t Wait4ResetRows[] = {
+	{ ES_F1_DONE,       ES_FSM_ANY_PARAM, 0, DoneResetting,    InitFlip1 }
+};
+static const ES_FSMRow_t RunningRows[] = {
+	{ ES_RESET,         ES_FSM_ANY_PARAM, 0, StartReset,       Wait4ResetF1 }
+};
+
+// the machine, indexed by Flip1State_t (plus the Flip1Running superstate)
+static const ES_FSMState_t Flip1States[NUM_F1_STATES] = {
+	/* InitFlip1 */          ES_FSM_STATE( ES_FSM_NO_PARENT, InitRows ),
+	/* Wait4Seed */          ES_FSM_STATE( Flip1Running, Wait4SeedRows ),
+	/* Wait4Stop */          ES_FSM_STATE( Flip1Running, Wait4StopRows ),
+	/* Wait4CelebrationF1 */ ES_FSM_STATE( Flip1Running, Wait4CelebrationRows ),
+	/* Wait4ResetF1 */       ES_FSM_STATE( ES_FSM_NO_PARENT, Wait4ResetRows ),
+	/* Flip1Running */       ES_FSM_STATE( ES_FSM_NO_PARENT, RunningRows )
+};
+static const ES_FSM_t Flip1Machine = { Flip1States, NUM_F1_STATES };
 
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
@@ -102,6 +156,7 @@ bool InitFlip1Service ( uint8_t Priority )
   ES_Event ThisEvent;
 	//Initialize the MyPriority variable with the passed in parameter.
   MyPriority = Priority;
+	SpinControl_Init( &Spin, MyPriority );
 	
 	//Make sure PWM is initialized in Main
 	
@@ -115,7 +170,7 @@ bool InitFlip1Service ( uint8_t Priority )
 	
 	//Post Event ES_Init to Flipbook3Service queue (this service)
   ThisEvent.EventType = ES_INIT;
-  if (ES_PostToService( MyPriority, ThisEvent) == true)
+  if (ES_QueueStatsPost( MyPriority, ThisEvent) == true)
   {
       return true;
   }else
@@ -144,7 +199,7 @@ bool InitFlip1Service ( uint8_t Priority )
 ****************************************************************************/
 bool PostFlip1Service( ES_Event ThisEvent )
 {
-  return ES_PostToService( MyPriority, ThisEvent);
+  return ES_QueueStatsPost( MyPriority, ThisEvent);
 }
 
 /****************************************************************************
@@ -154,113 +209,63 @@ bool PostFlip1Service( ES_Event ThisEvent )
  Parameters
    ES_Event : the event to process
 
+ Returns
+   ES_Event, whatever HandleFlip1Event returns
+
+ Description
+   Runs ThisEvent through HandleFlip1Event by way of ES_QueueStatsRun
+****************************************************************************/
+ES_Event RunFlip1Service( ES_Event ThisEvent )
+{
+	return ES_QueueStatsRun( MyPriority, ThisEvent, HandleFlip1Event, QueryState );
+}
+
+/****************************************************************************
+ Function
+    HandleFlip1Event
+
+ Parameters
+   ES_Event : the event to process
+
  Returns
    ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
 
  Description
-   add your description here
+   Runs the event through the Flip1 state table
  Notes
-   
+   ES_RESET is handled by the Flip1Running superstate for every state
+   between the seed and the celebration
  Author
    A.Siu
 ****************************************************************************/
-ES_Event RunFlip1Service( ES_Event ThisEvent )
+static ES_Event HandleFlip1Event( ES_Event ThisEvent )
 {
   ES_Event ReturnEvent;
   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
-  Flip1State_t NextState = CurrentState;
-  switch ( CurrentState )
-  {
-		case InitFlip1:
-			if ( ThisEvent.EventType == ES_INIT ) {
-				#if DEBUG_F1
-				printf( "F1S: Init starting.\n\r\n" );
-				#endif
-				PWM8_TIVA_SetFreq( PWM_FREQ, PWM_GROUP );
-				NextState = Wait4Seed;
-			}
-		break;
-		
-		case Wait4Seed:
-			if ( ThisEvent.EventType == ES_SEED_DETECTED ) {
-				//Start the motor with PWM duty cycle at 
-				//printf( "pulse %f\n\r\n", PWM_PULSE );
-				PWM8_TIVA_SetPulseWidth( PWM_PULSE, PWM_CHAN );
-				//Set NextState Wait4Stop
-				NextState = Wait4Stop;
-				#if DEBUG_F1
-				printf( "F1S: seed detected, starting motor\n\r\n" );
-				#endif
-			} 
-			else if ( ThisEvent.EventType == ES_RESET ) {
-				//Turn on the motor to reset to the beginning
-				PWM8_TIVA_SetPulseWidth( PWM_RESET_PULSE, PWM_CHAN );
-				//Set NextState to wait for reset
-				NextState = Wait4ResetF1;
-			}
-		break;
-		
-		case Wait4Stop:
-			//if ThisEvent is ES_F1_DONE
-			if ( ThisEvent.EventType == ES_F1_DONE ) {
-				#if DEBUG_F1
-				printf( "F1S: F1 done spinning stopping motor F1\n\r\n" );
-				#endif
-				//Stop the motor
-				PWM8_TIVA_SetDuty( 0, PWM_CHAN );
-				//Set NextState Wait4Celebration
-				NextState = Wait4CelebrationF1;
-			} 
-			else if ( ThisEvent.EventType == ES_RESET ) {
-				//Turn on the motor to reset to the beginning
-				PWM8_TIVA_SetPulseWidth( PWM_RESET_PULSE, PWM_CHAN );
-				//Set NextState to wait for reset
-				NextState = Wait4ResetF1;
-			}
-			break;
-		
-		case Wait4CelebrationF1:
-			// if it's a celebration event
-			if ( ThisEvent.EventType == ES_CELEBRATION ) {
-				// start the F1 motor to make 2 flips
-				PWM8_TIVA_SetPulseWidth( PWM_CELEB_PULSE, PWM_CHAN );
-				#if DEBUG_F1
-				printf("F1S: celebration mode!\n\r\n");
-				#endif
-			} 
-			// if it's time to reset
-			else if ( ThisEvent.EventType == ES_RESET ) {
-				//Turn on the motor to reset to the beginning
-				PWM8_TIVA_SetPulseWidth( PWM_RESET_PULSE, PWM_CHAN );
-				//Set NextState to wait for reset
-				NextState = Wait4ResetF1;
-			}
-			break;
-
-		case Wait4ResetF1:
-			if ( ThisEvent.EventType == ES_F1_DONE ) {
-				//Turn off motor
-				PWM8_TIVA_SetDuty( 0, PWM_CHAN );
-				#if DEBUG_F1
-				printf("F1S: Wait4ResetF1 - done resetting flipbook\n\r\n");
-				#endif
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Set NextState to InitFlipbook3Service
-				NextState = InitFlip1;
-			}
-		break;
-		
-		default :
-	  ;
-		
-	} // end SM
-	CurrentState = NextState;
+	//Broadcasts (ES_RESET, ES_CELEBRATION) come through the broadcast ring,
+	//swap in the next one
+	if ( ThisEvent.EventType == ES_BROADCAST ) {
+		ThisEvent = ES_BroadcastFetch( MyPriority );
+	}
+
+	//Look the event up in the state table, it runs the action and gives us
+	//the next state
+	CurrentState = (Flip1State_t)ES_FSM_Dispatch( &Flip1Machine, CurrentState, ThisEvent );
   return ReturnEvent;
 }
 
+/****************************************************************************
+ Function
+     QueryState
+
+ Returns
+     uint8_t, the current state, for the trace kept by ES_QueueStatsRun
+****************************************************************************/
+static uint8_t QueryState ( void )
+{
+	return CurrentState;
+}
+
 /****************************************************************************
  Function
      QueryFlip1Service
@@ -286,6 +291,126 @@ Flip1State_t QueryFlip1Service ( void )
 /***************************************************************************
  private functions
  ***************************************************************************/
+/****************************************************************************
+ Function
+     StartPWM
+
+ Description
+     InitFlip1 on ES_INIT: sets the motor PWM frequency
+****************************************************************************/
+static void StartPWM ( ES_Event ThisEvent )
+{
+	#if DEBUG_F1
+	printf( "F1S: Init starting.\n\r\n" );
+	#endif
+	PWMBatch_InitGroups( PWM_FREQ, PWM_BATCH_GROUP_BIT(PWM_GROUP) );
+}
+
+/****************************************************************************
+ Function
+     StartMotor
+
+ Description
+     Wait4Seed on ES_SEED_DETECTED: starts the motor
+****************************************************************************/
+static void StartMotor ( ES_Event ThisEvent )
+{
+	//Start the motor with PWM duty cycle at 
+	PWMBatch_WritePulseWidth( PWM_PULSE, PWM_CHAN );
+	#if DEBUG_F1
+	printf( "F1S: seed detected, starting motor\n\r\n" );
+	#endif
+}
+
+/****************************************************************************
+ Function
+     StopMotor
+
+ Description
+     Wait4Stop on ES_F1_DONE: stops the motor
+****************************************************************************/
+static void StopMotor ( ES_Event ThisEvent )
+{
+	#if DEBUG_F1
+	printf( "F1S: F1 done spinning stopping motor F1\n\r\n" );
+	#endif
+	//Stop the motor
+	PWMBatch_WriteDuty( 0, PWM_CHAN );
+}
+
+/****************************************************************************
+ Function
+     StartCelebration
+
+ Description
+     Wait4CelebrationF1 on ES_CELEBRATION: spins the flipbook faster
+****************************************************************************/
+static void StartCelebration ( ES_Event ThisEvent )
+{
+	// start the F1 motor to make 2 flips, at the celebration period
+	PWMBatch_WritePulseWidth( SpinControl_Start( &Spin, PWM_CELEB_PULSE, CELEB_PERIOD ), PWM_CHAN );
+	#if DEBUG_F1
+	printf("F1S: celebration mode!\n\r\n");
+	#endif
+}
+
+/****************************************************************************
+ Function
+     HoldSpinRate
+
+ Description
+     Wait4CelebrationF1 on ES_F1_DONE: the limit switch closes once a
+     revolution, so times the revolution and trims the pulse to hold
+     CELEB_PERIOD (nothing happens before the celebration starts)
+****************************************************************************/
+static void HoldSpinRate ( ES_Event ThisEvent )
+{
+	uint16_t Pulse;
+
+	if ( SpinControl_Revolution( &Spin, ThisEvent.EventParam, &Pulse ) == true ) {
+		PWMBatch_WritePulseWidth( Pulse, PWM_CHAN );
+		#if DEBUG_F1
+		printf("F1S: revolution %u, %d off, pulse %u\n\r\n", Spin.Period, Spin.Error, Pulse);
+		#endif
+	}
+}
+
+/****************************************************************************
+ Function
+     StartReset
+
+ Description
+     Flip1Running on ES_RESET: turns the motor on to spin the flipbook back
+     to the beginning
+****************************************************************************/
+static void StartReset ( ES_Event ThisEvent )
+{
+	//Stop holding the celebration period, turn on the motor to reset to the beginning
+	SpinControl_Stop( &Spin );
+	PWMBatch_WritePulseWidth( PWM_RESET_PULSE, PWM_CHAN );
+}
+
+/****************************************************************************
+ Function
+     DoneResetting
+
+ Description
+     Wait4ResetF1 on ES_F1_DONE: stops the motor and tells MainStoryService
+     this flipbook is reset
+****************************************************************************/
+static void DoneResetting ( ES_Event ThisEvent )
+{
+	ES_Event Event2Post;
+
+	//Turn off motor
+	PWMBatch_WriteDuty( 0, PWM_CHAN );
+	#if DEBUG_F1
+	printf("F1S: Wait4ResetF1 - done resetting flipbook\n\r\n");
+	#endif
+	// post an ES_DONE_INIT to the MainService
+	Event2Post.EventType = ES_DONE_INIT;
+	PostMainService( Event2Post );
+}
 
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
@@ -25,9 +25,15 @@
 #include <cmath>
 #include "ES_Configure.h"
 #include "ES_Framework.h"
+#include "ES_Broadcast.h"
+#include "ES_Mailbox.h"
+#include "ES_QueueStats.h"
+#include "ES_TableFSM.h"
 
 // include the PWM library
 #include "PWM8Tiva.h"
+#include "PWMBatch.h"
+#include "SpinControl.h"
 #include "PWMTiva.h"
 
 // the headers to access the GPIO subsystem
@@ -47,6 +53,7 @@
 #include "WaterBucketService.h"
 #include "Flipbook2Service.h"
 #include "ADMulti.h"
+#include "TiltCalibration.h"
 #include "MainStoryService.h"
 
 #define ALL_BITS (0xff<<2)
@@ -64,17 +71,70 @@
 
 #define MIN_PWM   1800
 #define MAX_PWM   2000
-#define MIN_ACC   2700 //Formerly 2610
-#define MAX_ACC   1999
-#define MIN_TILT_CHANGE 2500 //2600
+
+//the revolution time to hold while celebrating (1.000mS ticks), tune it with the spin trace
+#define CELEB_PERIOD 976
 
 #define PORT_F    BIT5HI      // for the 595 + LEDs
 #define LED_PIN   BIT3HI;
 #define LED_LO    BIT3LO;
 
+//superstate of the running states, handles ES_RESET for all of them
+#define Flip2Running (Wait4ResetF2 + 1)
+#define NUM_F2_STATES (Flip2Running + 1)
+
+//The state machine, run by RunFlip2Service
+static ES_Event HandleFlip2Event ( ES_Event ThisEvent );
+static uint8_t QueryState ( void );
+
+//Private actions for the state table
+static void StartPWM ( ES_Event ThisEvent );
+static void StartWatering ( ES_Event ThisEvent );
+static void RunMotorWithTilt ( ES_Event ThisEvent );
+static void FinishWatering ( ES_Event ThisEvent );
+static void StartCelebration ( ES_Event ThisEvent );
+static void HoldSpinRate ( ES_Event ThisEvent );
+static void StartReset ( ES_Event ThisEvent );
+static void DoneResetting ( ES_Event ThisEvent );
+
 //Local variables: LastAccState, MyPriority, CurrentState
 static uint8_t MyPriority;
 static Flip2State_t CurrentState;
+//holds the revolution period while celebrating
+static SpinControl_t Spin;
+
+//The transitions of each state
+static const ES_FSMRow_t InitRows[] = {
+	{ ES_INIT,        ES_FSM_ANY_PARAM, 0, StartPWM,         AwaitFlip1Finished }
+};
+static const ES_FSMRow_t AwaitFlip1Rows[] = {
+	{ ES_F1_DONE,     ES_FSM_ANY_PARAM, 0, StartWatering,    AwaitingWater }
+};
+static const ES_FSMRow_t AwaitingWaterRows[] = {
+	{ ES_WATER,       ES_FSM_ANY_PARAM, 0, RunMotorWithTilt, ES_FSM_NO_CHANGE },
+	{ ES_F2_DONE,     ES_FSM_ANY_PARAM, 0, FinishWatering,   Wait4Celebration }
+};
+static const ES_FSMRow_t Wait4CelebrationRows[] = {
+	{ ES_CELEBRATION, ES_FSM_ANY_PARAM, 0, StartCelebration, ES_FSM_NO_CHANGE },
+	{ ES_F2_DONE,     ES_FSM_ANY_PARAM, 0, HoldSpinRate,     ES_FSM_NO_CHANGE }
+};
+static const ES_FSMRow_t Wait4ResetRows[] = {
+	{ ES_F2_DONE,     ES_FSM_ANY_PARAM, 0, DoneResetting,    InitFlipbook2Service }
+};
+static const ES_FSMRow_t RunningRows[] = {
+	{ ES_RESET,       ES_FSM_ANY_PARAM, 0, StartReset,       Wait4ResetF2 }
+};
+
+//The machine, indexed by Flip2State_t (plus the Flip2Running superstate)
+static const ES_FSMState_t Flip2States[NUM_F2_STATES] = {
+	/* InitFlipbook2Service */ ES_FSM_STATE( ES_FSM_NO_PARENT, InitRows ),
+	/* AwaitFlip1Finished */   ES_FSM_STATE( Flip2Running, AwaitFlip1Rows ),
+	/* AwaitingWater */        ES_FSM_STATE( Flip2Running, AwaitingWaterRows ),
+	/* Wait4Celebration */     ES_FSM_STATE( Flip2Running, Wait4CelebrationRows ),
+	/* Wait4ResetF2 */         ES_FSM_STATE( ES_FSM_NO_PARENT, Wait4ResetRows ),
+	/* Flip2Running */         ES_FSM_STATE( ES_FSM_NO_PARENT, RunningRows )
+};
+static const ES_FSM_t Flip2Machine = { Flip2States, NUM_F2_STATES };
 
 //InitFlip2Service
 //Takes a priority number, returns True.
@@ -82,6 +142,7 @@ bool InitFlip2Service ( uint8_t Priority ) {
 	ES_Event ThisEvent;
 	//Initialize the MyPriority variable with the passed in parameter.
 	MyPriority = Priority;
+	SpinControl_Init( &Spin, MyPriority );
 	
 	//Initialize the port line to control the LEDs on Flipbook 2
 	//LEDs belong to port F, pin 3
@@ -91,11 +152,14 @@ bool InitFlip2Service ( uint8_t Priority ) {
 	HWREG(GPIO_PORTF_BASE+GPIO_O_DIR) |= LED_PIN;
 	//Turn the LEDs off TODO
 	
+	//Subscribe to the water mailbox so we get the freshest tilt sample
+	ES_MailboxSubscribe( WATER_MAILBOX, MyPriority );
+	
 //	Set CurrentState to be InitFlipbook2Service
 	CurrentState = InitFlipbook2Service;
 //	Post Event ES_Init to Flipbook2Service queue (this service)
 	ThisEvent.EventType = ES_INIT;
-	if (ES_PostToService( MyPriority, ThisEvent) == true)
+	if (ES_QueueStatsPost( MyPriority, ThisEvent) == true)
   {  
     return true;
   }else
@@ -104,132 +168,131 @@ bool InitFlip2Service ( uint8_t Priority ) {
   }
 }//	End of InitFlip2Service (return True)
 
-//RunFlip2Service (implements the state machine for Flipbook2 Service)
-//The EventType field of ThisEvent will be one of: ES_INIT, ES_WATER, ES_NO_WATER, ES_F2_DONE, ES_CELEBRATION
-//Local Variables: NextState
+//RunFlip2Service (hands ThisEvent to HandleFlip2Event by way of ES_QueueStatsRun)
 ES_Event RunFlip2Service ( ES_Event ThisEvent ) {
-//Set NextState to CurrentState
-	Flip2State_t NextState = CurrentState;
-	//Based on the state of the CurrentState variable choose one of the following blocks of code:
-	switch ( CurrentState ) {
-		
-		//CurrentState is InitFlipbook2Service
-		case InitFlipbook2Service :
-			//if ThisEvent is ES_INIT
-			if (ThisEvent.EventType == ES_INIT) {
-				// set the pwm frequency, turn of motors
-				PWM8_TIVA_SetFreq( PWM_FREQ, PWM_GROUP );
-				//Set NextState AwaitFlip1Finished
-				NextState = AwaitFlip1Finished;
-				#if DEBUG_F2
-				printf("FS2: init starting. \n\r\n");
-				#endif
-			}
-		break;
-
-		//CurrentState is AwaitFlip1Finished
-		case AwaitFlip1Finished :
-			//if ThisEvent is ES_F1_DONE
-			if (ThisEvent.EventType == ES_F1_DONE) {
-				#if DEBUG_F2
-				printf("F2S: F1 done, waiting 4 water\n\r\n");
-				#endif
-				//Set NextState Wait4Water
-				NextState = AwaitingWater;
-			} else if ( ThisEvent.EventType == ES_RESET ) {
-				//Turn on the motor to reset to the beginning
-				PWM8_TIVA_SetPulseWidth( PWM_RESET_PULSE, PWM_CHAN );
-				//Set NextState to InitFlipbook2Service
-				NextState = Wait4ResetF2;
-			}	
-		break; //End Wait4Seed block
-
-		//CurrentState is AwaitingWater
-		case AwaitingWater :
-			
-			//if ThisEvent is ES_WATER
-			if ( ThisEvent.EventType == ES_WATER ) {
-				// if it's close to zero 
-				if ( ThisEvent.EventParam >= 2595 ) {
-					//Stop the motor
-					PWM8_TIVA_SetDuty(0, PWM_CHAN);
-				} else { // else start the motor
-					// calculate the scaled parameter
-					uint16_t AccPulse = (((MAX_PWM - MIN_PWM)*(ThisEvent.EventParam - MIN_ACC))/(MAX_ACC-MIN_ACC)) + MIN_PWM;
-					//Start the motor with the scaled parameter
-					PWM8_TIVA_SetPulseWidth( AccPulse, PWM_CHAN );
-					#if DEBUG_F2
-						printf("F2S: F2 motor running at %u\n\r\n", AccPulse );
-					#endif
-				}
-			}
-			
-			//if ThisEvent is ES_F2_DONE
-			else if ( ThisEvent.EventType == ES_F2_DONE ) {
-				//Stop the motor
-				PWM8_TIVA_SetDuty(0, PWM_CHAN);
-				//Keep motor running now at a constant rate
-				PWM8_TIVA_SetPulseWidth(PWM_PULSE, PWM_CHAN);
-				#if DEBUG_F2
-				printf("FS2: flipbook2 done, stopping motor\n\r\n");
-				#endif
-				//Set NextState Wait4Celebration
-				NextState = Wait4Celebration;
-			}
-			//if ThisEvent is ES_RESET
-			else if ( ThisEvent.EventType == ES_RESET ) {
-				//Turn on the motor to reset to the beginning
-				PWM8_TIVA_SetPulseWidth( PWM_RESET_PULSE, PWM_CHAN );
-				//Set NextState to InitFlipbook2Service
-				NextState = Wait4ResetF2;
-			}	
-		break; //	End Wait4Water block
-
-		//CurrentState is Wait4Celebration
-		case Wait4Celebration :
-			//if ThisEvent is ES_CELEBRATION
-			if ( ThisEvent.EventType == ES_CELEBRATION ) {
-				// start the F2 motor 
-				PWM8_TIVA_SetPulseWidth( PWM_CELEB_PULSE, PWM_CHAN );
-				#if DEBUG_F2
-				printf("F2S: Celebration!\n\r\n");
-				#endif
-			} else if ( ThisEvent.EventType == ES_RESET ) {
-				//Turn on the motor to reset to the beginning
-				PWM8_TIVA_SetPulseWidth( PWM_RESET_PULSE, PWM_CHAN );
-				//Set NextState to InitFlipbook2Service
-				NextState = Wait4ResetF2;
-			}			
-		break; //	End Wait4Celebration block
-
-		case Wait4ResetF2:
-			if ( ThisEvent.EventType == ES_F2_DONE ) {
-				//Turn off motor
-				PWM8_TIVA_SetDuty( 0, PWM_CHAN );
-				#if DEBUG_F2
-				printf("F2S: Wait4ResetF2 - done resetting flipbook\n\r\n");
-				#endif
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Set NextState to InitFlipbook3Service
-				NextState = InitFlipbook2Service;
-			}
-		break;	
-	} // end SM
-	
-	//Set CurrentState to NextState
-	CurrentState = NextState;
-	//eturn ES_NO_EVENT
+	return ES_QueueStatsRun( MyPriority, ThisEvent, HandleFlip2Event, QueryState );
+}//End of RunFlip2Service
+
+//HandleFlip2Event (implements the state machine for Flipbook2 Service)
+//The EventType field of ThisEvent will be one of: ES_INIT, ES_WATER, ES_F1_DONE, ES_F2_DONE, ES_CELEBRATION, ES_RESET
+static ES_Event HandleFlip2Event ( ES_Event ThisEvent ) {
+	//If ThisEvent is ES_WATER, replace it with the latest sample in the water mailbox
+	if ( ThisEvent.EventType == ES_WATER ) {
+		ThisEvent = ES_MailboxFetch( WATER_MAILBOX, MyPriority );
+	}
+	//If ThisEvent is ES_BROADCAST, replace it with the next event in the broadcast ring
+	if ( ThisEvent.EventType == ES_BROADCAST ) {
+		ThisEvent = ES_BroadcastFetch( MyPriority );
+	}
+	//Look ThisEvent up in the state table, it runs the action and gives us the
+	//next state (ES_RESET is handled by the Flip2Running superstate)
+	CurrentState = (Flip2State_t)ES_FSM_Dispatch( &Flip2Machine, CurrentState, ThisEvent );
+	//Return ES_NO_EVENT
 	ThisEvent.EventType = ES_NO_EVENT;
 	return ThisEvent;
-}//End of RunFlip2Service
+}//End of HandleFlip2Event
+
+//QueryState (the current state, for the trace kept by ES_QueueStatsRun)
+static uint8_t QueryState ( void ) {
+	return CurrentState;
+}//End of QueryState
+
+//private StartPWM
+//InitFlipbook2Service on ES_INIT
+static void StartPWM ( ES_Event ThisEvent ) {
+	// set the pwm frequency, turn of motors
+	PWMBatch_InitGroups( PWM_FREQ, PWM_BATCH_GROUP_BIT(PWM_GROUP) );
+	#if DEBUG_F2
+	printf("FS2: init starting. \n\r\n");
+	#endif
+}//End StartPWM
+
+//private StartWatering
+//AwaitFlip1Finished on ES_F1_DONE
+static void StartWatering ( ES_Event ThisEvent ) {
+	#if DEBUG_F2
+	printf("F2S: F1 done, waiting 4 water\n\r\n");
+	#endif
+}//End StartWatering
+
+//private RunMotorWithTilt
+//AwaitingWater on ES_WATER, runs the motor faster the more the bucket is tilted
+static void RunMotorWithTilt ( ES_Event ThisEvent ) {
+	// if it's close to zero 
+	if ( ThisEvent.EventParam <= TiltCal_Get()->StopThreshold ) {
+		//Stop the motor
+		PWMBatch_WriteDuty(0, PWM_CHAN);
+	} else { // else start the motor
+		// calculate the scaled parameter
+		uint16_t AccPulse = TiltCal_Scale( ThisEvent.EventParam, MIN_PWM, MAX_PWM );
+		//Start the motor with the scaled parameter
+		PWMBatch_WritePulseWidth( AccPulse, PWM_CHAN );
+		#if DEBUG_F2
+			printf("F2S: F2 motor running at %u\n\r\n", AccPulse );
+		#endif
+	}
+}//End RunMotorWithTilt
+
+//private FinishWatering
+//AwaitingWater on ES_F2_DONE
+static void FinishWatering ( ES_Event ThisEvent ) {
+	//Keep motor running now at a constant rate, from the next PWM period
+	PWMBatch_WritePulseWidth(PWM_PULSE, PWM_CHAN);
+	#if DEBUG_F2
+	printf("FS2: flipbook2 done, stopping motor\n\r\n");
+	#endif
+}//End FinishWatering
+
+//private StartCelebration
+//Wait4Celebration on ES_CELEBRATION
+static void StartCelebration ( ES_Event ThisEvent ) {
+	// start the F2 motor, at the celebration period
+	PWMBatch_WritePulseWidth( SpinControl_Start( &Spin, PWM_CELEB_PULSE, CELEB_PERIOD ), PWM_CHAN );
+	#if DEBUG_F2
+	printf("F2S: Celebration!\n\r\n");
+	#endif
+}//End StartCelebration
+
+//private HoldSpinRate
+//Wait4Celebration on ES_F2_DONE, the limit switch closes once a revolution, so
+//time the revolution and trim the pulse to hold CELEB_PERIOD (nothing happens
+//before the celebration starts, while the motor turns at PWM_PULSE)
+static void HoldSpinRate ( ES_Event ThisEvent ) {
+	uint16_t Pulse;
+	if ( SpinControl_Revolution( &Spin, ThisEvent.EventParam, &Pulse ) == true ) {
+		PWMBatch_WritePulseWidth( Pulse, PWM_CHAN );
+		#if DEBUG_F2
+		printf("F2S: revolution %u, %d off, pulse %u\n\r\n", Spin.Period, Spin.Error, Pulse);
+		#endif
+	}
+}//End HoldSpinRate
+
+//private StartReset
+//Flip2Running on ES_RESET, spins the flipbook back to the beginning
+static void StartReset ( ES_Event ThisEvent ) {
+	//Stop holding the celebration period, turn on the motor to reset to the beginning
+	SpinControl_Stop( &Spin );
+	PWMBatch_WritePulseWidth( PWM_RESET_PULSE, PWM_CHAN );
+}//End StartReset
+
+//private DoneResetting
+//Wait4ResetF2 on ES_F2_DONE
+static void DoneResetting ( ES_Event ThisEvent ) {
+	ES_Event Event2Post;
+	//Turn off motor
+	PWMBatch_WriteDuty( 0, PWM_CHAN );
+	#if DEBUG_F2
+	printf("F2S: Wait4ResetF2 - done resetting flipbook\n\r\n");
+	#endif
+	// post an ES_DONE_INIT to the MainService
+	Event2Post.EventType = ES_DONE_INIT;
+	PostMainService( Event2Post );
+}//End DoneResetting
 
 //PostFlip2Service
 bool PostFlip2Service ( ES_Event ThisEvent ) {
 //Post Event to ES_SERVICES
-	return ES_PostToService( MyPriority, ThisEvent);
+	return ES_QueueStatsPost( MyPriority, ThisEvent);
 }
 
 /****************************************************************************
@@ -22,10 +22,16 @@
 */
 #include "ES_Configure.h"
 #include "ES_Framework.h"
+#include "ES_Broadcast.h"
+#include "ES_QueueStats.h"
+#include "ES_SoftTimers.h"
+#include "ES_TableFSM.h"
 #include "TemplateService.h"
 
 // include the PWM library
 #include "PWM8Tiva.h"
+#include "PWMBatch.h"
+#include "SpinControl.h"
 
 // the headers to access the GPIO subsystem
 #include "inc/hw_memmap.h"
@@ -57,8 +63,9 @@
 #define PWM_FREQ  50
 #define PWM_DUTY  90
 #define PWM_FREQ  50
-#define MS_TO_US( A )  A/(0.0008*1000)  // converts to ticks of 0.8 us
-#define PWM_PULSE MS_TO_US( 1530 )      //  (defined in ticks of 0.8 us)
+#define MS_TO_US( A )  ((uint16_t)(((A)*10)/8))  // converts uS to integer ticks of 0.8 us
+#define PWM_PULSE        MS_TO_US( 1530 )  //  (defined in ticks of 0.8 us)
+#define PWM_FAST_PULSE   MS_TO_US( 1580 )  // after the hardest waving
 #define PWM_CELEB_PULSE  MS_TO_US( 1600 )
 #define PWM_RESET_PULSE  MS_TO_US( 1550 )
 
@@ -68,16 +75,75 @@
 #define TWO_SEC (ONE_SEC*2)
 #define FIVE_SEC (ONE_SEC*5)
 #define F3_SHORT_TIME (ONE_SEC)
+// the revolution time to hold while celebrating, tune it with the spin trace
+#define CELEB_PERIOD ONE_SEC
+
+// superstate of the running states, handles ES_RESET for all of them
+#define Flip3Running (Wait4ResetF3 + 1)
+#define NUM_F3_STATES (Flip3Running + 1)
 
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this service.They should be functions
    relevant to the behavior of this service
 */
+static ES_Event HandleFlip3Event ( ES_Event ThisEvent );
+static uint8_t QueryState ( void );
+static void StartPWM ( ES_Event ThisEvent );
+static void StartShortSpin ( ES_Event ThisEvent );
+static void StartHarvest ( ES_Event ThisEvent );
+static void StartMotor ( ES_Event ThisEvent );
+static void StopMotor ( ES_Event ThisEvent );
+static void StartCelebration ( ES_Event ThisEvent );
+static void HoldSpinRate ( ES_Event ThisEvent );
+static void StartReset ( ES_Event ThisEvent );
+static void DoneResetting ( ES_Event ThisEvent );
 
 /*---------------------------- Module Variables ---------------------------*/
 // with the introduction of Gen2, we need a module level Priority variable
 static uint8_t MyPriority;
 static Flip3State_t CurrentState;
+// holds the revolution period while celebrating
+static SpinControl_t Spin;
+
+// the transitions of each state
+static const ES_FSMRow_t InitRows[] = {
+	{ ES_INIT,         ES_FSM_ANY_PARAM,     0, StartPWM,         Wait4Flip2Done }
+};
+static const ES_FSMRow_t Wait4Flip2DoneRows[] = {
+	{ ES_F2_DONE,      ES_FSM_ANY_PARAM,     0, StartShortSpin,   Wait4ShortTimeout }
+};
+static const ES_FSMRow_t Wait4ShortTimeoutRows[] = {
+	{ ES_TIMEOUT,      FLIPBOOK3_INIT_TIMER, 0, StartHarvest,     Wait4Harvesting }
+};
+static const ES_FSMRow_t Wait4HarvestingRows[] = {
+	{ ES_DONE_HARVEST, ES_FSM_ANY_PARAM,     0, StartMotor,       Wait4Flip3Done }
+};
+static const ES_FSMRow_t Wait4Flip3DoneRows[] = {
+	{ ES_F3_DONE,      ES_FSM_ANY_PARAM,     0, StopMotor,        Wait4CelebrationF3 }
+};
+static const ES_FSMRow_t Wait4CelebrationRows[] = {
+	{ ES_CELEBRATION,  ES_FSM_ANY_PARAM,     0, StartCelebration, ES_FSM_NO_CHANGE },
+	{ ES_F3_DONE,      ES_FSM_ANY_PARAM,     0, HoldSpinRate,     ES_FSM_NO_CHANGE }
+};
+static const ES_FSMRow_t Wait4ResetRows[] = {
+	{ ES_F3_DONE,      ES_FSM_ANY_PARAM,     0, DoneResetting,    InitFlip3 }
+};
+static const ES_FSMRow_t RunningRows[] = {
+	{ ES_RESET,        ES_FSM_ANY_PARAM,     0, StartReset,       Wait4ResetF3 }
+};
+
+// the machine, indexed by Flip3State_t (plus the Flip3Running superstate)
+static const ES_FSMState_t Flip3States[NUM_F3_STATES] = {
+	/* InitFlip3 */          ES_FSM_STATE( ES_FSM_NO_PARENT, InitRows ),
+	/* Wait4Flip2Done */     ES_FSM_STATE( Flip3Running, Wait4Flip2DoneRows ),
+	/* Wait4ShortTimeout */  ES_FSM_STATE( Flip3Running, Wait4ShortTimeoutRows ),
+	/* Wait4Harvesting */    ES_FSM_STATE( Flip3Running, Wait4HarvestingRows ),
+	/* Wait4Flip3Done */     ES_FSM_STATE( Flip3Running, Wait4Flip3DoneRows ),
+	/* Wait4CelebrationF3 */ ES_FSM_STATE( Flip3Running, Wait4CelebrationRows ),
+	/* Wait4ResetF3 */       ES_FSM_STATE( ES_FSM_NO_PARENT, Wait4ResetRows ),
+	/* Flip3Running */       ES_FSM_STATE( ES_FSM_NO_PARENT, RunningRows )
+};
+static const ES_FSM_t Flip3Machine = { Flip3States, NUM_F3_STATES };
 
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
@@ -103,6 +169,7 @@ bool InitFlip3Service ( uint8_t Priority )
   ES_Event ThisEvent;
 	//Initialize the MyPriority variable with the passed in parameter.
   MyPriority = Priority;
+	SpinControl_Init( &Spin, MyPriority );
 	
 	//Make sure PWM is initialized in Main
 	
@@ -117,7 +184,7 @@ bool InitFlip3Service ( uint8_t Priority )
 	
 	//Post Event ES_Init to Flipbook3Service queue (this service)
   ThisEvent.EventType = ES_INIT;
-  if (ES_PostToService( MyPriority, ThisEvent) == true)
+  if (ES_QueueStatsPost( MyPriority, ThisEvent) == true)
   {
       return true;
   }else
@@ -146,7 +213,7 @@ bool InitFlip3Service ( uint8_t Priority )
 ****************************************************************************/
 bool PostFlip3Service( ES_Event ThisEvent )
 {
-  return ES_PostToService( MyPriority, ThisEvent);
+  return ES_QueueStatsPost( MyPriority, ThisEvent);
 }
 
 /****************************************************************************
@@ -156,151 +223,63 @@ bool PostFlip3Service( ES_Event ThisEvent )
  Parameters
    ES_Event : the event to process
 
+ Returns
+   ES_Event, whatever HandleFlip3Event returns
+
+ Description
+   Runs ThisEvent through HandleFlip3Event by way of ES_QueueStatsRun
+****************************************************************************/
+ES_Event RunFlip3Service( ES_Event ThisEvent )
+{
+	return ES_QueueStatsRun( MyPriority, ThisEvent, HandleFlip3Event, QueryState );
+}
+
+/****************************************************************************
+ Function
+    HandleFlip3Event
+
+ Parameters
+   ES_Event : the event to process
+
  Returns
    ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
 
  Description
-   add your description here
+   Runs the event through the Flip3 state table
  Notes
-   
+   ES_RESET is handled by the Flip3Running superstate for every state
+   between flipbook 2 finishing and the celebration
  Author
    A.Siu
 ****************************************************************************/
-ES_Event RunFlip3Service( ES_Event ThisEvent )
+static ES_Event HandleFlip3Event( ES_Event ThisEvent )
 {
   ES_Event ReturnEvent;
   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
-  Flip3State_t NextState = CurrentState;
-  switch ( CurrentState )
-  {
-		case InitFlip3:
-			if ( ThisEvent.EventType == ES_INIT ) {
-				#if DEBUG_F3
-				printf( "FS3: Init starting.\n\r\n" );
-				#endif
-				// set PWM motor frequency
-				PWM8_TIVA_SetFreq( PWM_FREQ, PWM_GROUP );
-				//Start at 0 duty cycle
-				PWM8_TIVA_SetDuty( 0, PWM_CHAN );
-				NextState = Wait4Flip2Done;
-			}
-			break;
-		
-		//CurrentState is Wait4Flip2Done
-		case Wait4Flip2Done:
-			//if ThisEvent is ES_F2_DONE
-			if ( ThisEvent.EventType == ES_F2_DONE ) {
-				//Start the motor
-				PWM8_TIVA_SetPulseWidth( PWM_PULSE, PWM_CHAN );
-				//Start the FLIPBOOK3_INIT_TIMER
-				ES_Timer_InitTimer( FLIPBOOK3_INIT_TIMER, F3_SHORT_TIME );
-				//Set NextState to Wait4ShortTimeout
-				NextState = Wait4ShortTimeout;
-			} else if ( ThisEvent.EventType == ES_RESET ) {
-				//Turn on the motor to reset to the beginning
-				PWM8_TIVA_SetPulseWidth( PWM_RESET_PULSE, PWM_CHAN );
-				//Set next state to ResetF3
-				NextState = Wait4ResetF3;
-			}
-		break; //End Wait4Flip2Done block
-		
-		//CurrentState is Wait4ShortTimeout
-		case Wait4ShortTimeout:	
-			//if ThisEvent is ES_TIMEOUT and time corresponds to FLIPBOOK3_INIT_TIMER
-			if ( (ThisEvent.EventType == ES_TIMEOUT) && (ThisEvent.EventParam == FLIPBOOK3_INIT_TIMER) ){
-				//Stop motors
-				PWM8_TIVA_SetDuty( 0, PWM_CHAN );
-				//Post ES_START_HARVEST to AirService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_START_HARVEST;
-				PostAirService( Event2Post );
-				#if DEBUG_F3
-				printf( "FS3: waiting for harvest\n\r\n" );
-				#endif
-				//Set NextState to Wait4Harvesting
-				NextState = Wait4Harvesting;
-			} else if ( ThisEvent.EventType == ES_RESET ) {
-				//Turn on the motor to reset to the beginning
-				PWM8_TIVA_SetPulseWidth( PWM_RESET_PULSE, PWM_CHAN );
-				//Set next state to ResetF3
-				NextState = Wait4ResetF3;
-			}
-		break;
-			
-		case Wait4Harvesting:		
-			//if ThisEvent is ES_DONE_HARVEST
-			if ( ThisEvent.EventType == ES_DONE_HARVEST ) {
-				//Start the F3 motor
-				PWM8_TIVA_SetPulseWidth( PWM_PULSE, PWM_CHAN );
-				#if DEBUG_F3
-				printf( "FS3: starting flipbook3 motor\n\r\n" );
-				#endif
-				//NextState is Wait4FlipDone
-				NextState = Wait4Flip3Done;
-			}	else if ( ThisEvent.EventType == ES_RESET ) {
-				//Turn on the motor to reset to the beginning
-				PWM8_TIVA_SetPulseWidth( PWM_RESET_PULSE, PWM_CHAN );
-				//Set next state to ResetF3
-				NextState = Wait4ResetF3;
-			}
-			break;
-			
-		case Wait4Flip3Done:
-			//if ThisEvent is ES_F3_DONE
-			if ( ThisEvent.EventType == ES_F3_DONE ) {
-				//Stop the motor
-				PWM8_TIVA_SetDuty( 0, PWM_CHAN );
-				//Set NextState to Wait4Celebration
-				NextState = Wait4CelebrationF3;
-			}
-			//if ThisEvent is ES_RESET
-			else if ( ThisEvent.EventType == ES_RESET ) {
-				//Turn on the motor to reset to the beginning
-				PWM8_TIVA_SetPulseWidth( PWM_RESET_PULSE, PWM_CHAN );
-				//Set next state to ResetF3
-				NextState = Wait4ResetF3;
-			}
-			break;
-		
-		case Wait4CelebrationF3:
-			if ( ThisEvent.EventType == ES_CELEBRATION ) {
-				// start the F3 motor 
-				PWM8_TIVA_SetPulseWidth( PWM_CELEB_PULSE, PWM_CHAN );
-				#if DEBUG_F3
-				printf("F3S: celebration mode!\n\r\n");
-				#endif
-			} else if ( ThisEvent.EventType == ES_RESET ) {
-				//Turn on the motor to reset to the beginning
-				PWM8_TIVA_SetPulseWidth( PWM_RESET_PULSE, PWM_CHAN );
-				//Set next state to ResetF3
-				NextState = Wait4ResetF3;
-			}
-			break;
-		
-		case Wait4ResetF3:
-			if ( ThisEvent.EventType == ES_F3_DONE ) {
-				//Turn off motor
-				PWM8_TIVA_SetDuty( 0, PWM_CHAN );
-				#if DEBUG_F3
-				printf("F3S: Wait4ResetF3 - done resetting flipbook\n\r\n");
-				#endif
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Set NextState to InitFlipbook3Service
-				NextState = InitFlip3;
-			}
-		break;
-
-		default :
-	  ;
-		
-	} // end SM
-	CurrentState = NextState;
+	//Broadcasts (ES_RESET, ES_CELEBRATION) come through the broadcast ring,
+	//swap in the next one
+	if ( ThisEvent.EventType == ES_BROADCAST ) {
+		ThisEvent = ES_BroadcastFetch( MyPriority );
+	}
+
+	//Look the event up in the state table, it runs the action and gives us
+	//the next state
+	CurrentState = (Flip3State_t)ES_FSM_Dispatch( &Flip3Machine, CurrentState, ThisEvent );
   return ReturnEvent;
 }
 
+/****************************************************************************
+ Function
+     QueryState
+
+ Returns
+     uint8_t, the current state, for the trace kept by ES_QueueStatsRun
+****************************************************************************/
+static uint8_t QueryState ( void )
+{
+	return CurrentState;
+}
+
 /****************************************************************************
  Function
      QueryFlip3Service
@@ -327,6 +306,169 @@ Flip3State_t QueryFlip3Service ( void )
 /***************************************************************************
  private functions
  ***************************************************************************/
+/****************************************************************************
+ Function
+     StartPWM
+
+ Description
+     InitFlip3 on ES_INIT: sets the motor PWM frequency, motor off
+****************************************************************************/
+static void StartPWM ( ES_Event ThisEvent )
+{
+	#if DEBUG_F3
+	printf( "FS3: Init starting.\n\r\n" );
+	#endif
+	// set PWM motor frequency
+	PWMBatch_InitGroups( PWM_FREQ, PWM_BATCH_GROUP_BIT(PWM_GROUP) );
+	//Start at 0 duty cycle
+	PWMBatch_WriteDuty( 0, PWM_CHAN );
+}
+
+/****************************************************************************
+ Function
+     StartShortSpin
+
+ Description
+     Wait4Flip2Done on ES_F2_DONE: spins the flipbook for F3_SHORT_TIME
+****************************************************************************/
+static void StartShortSpin ( ES_Event ThisEvent )
+{
+	//Start the motor
+	PWMBatch_WritePulseWidth( PWM_PULSE, PWM_CHAN );
+	//Start the FLIPBOOK3_INIT_TIMER
+	ES_SoftTimer_InitTimer( FLIPBOOK3_INIT_TIMER, F3_SHORT_TIME );
+}
+
+/****************************************************************************
+ Function
+     StartHarvest
+
+ Description
+     Wait4ShortTimeout on the FLIPBOOK3_INIT_TIMER timeout: stops the motor
+     and starts the harvesting in AirService
+****************************************************************************/
+static void StartHarvest ( ES_Event ThisEvent )
+{
+	ES_Event Event2Post;
+
+	//Stop motors
+	PWMBatch_WriteDuty( 0, PWM_CHAN );
+	//Post ES_START_HARVEST to AirService
+	Event2Post.EventType = ES_START_HARVEST;
+	PostAirService( Event2Post );
+	#if DEBUG_F3
+	printf( "FS3: waiting for harvest\n\r\n" );
+	#endif
+}
+
+/****************************************************************************
+ Function
+     StartMotor
+
+ Description
+     Wait4Harvesting on ES_DONE_HARVEST: starts the motor, faster the
+     harder the visitor waved (the event parameter, 0 to WAVE_INTENSITY_MAX)
+****************************************************************************/
+static void StartMotor ( ES_Event ThisEvent )
+{
+	uint16_t Pulse;
+
+	//Scale the pulse from PWM_PULSE up to PWM_FAST_PULSE with the waving
+	Pulse = PWM_PULSE +
+	        ((uint32_t)(PWM_FAST_PULSE - PWM_PULSE) * ThisEvent.EventParam) / WAVE_INTENSITY_MAX;
+	//Start the F3 motor
+	PWMBatch_WritePulseWidth( Pulse, PWM_CHAN );
+	#if DEBUG_F3
+	printf( "FS3: starting flipbook3 motor, pulse %u\n\r\n", Pulse );
+	#endif
+}
+
+/****************************************************************************
+ Function
+     StopMotor
+
+ Description
+     Wait4Flip3Done on ES_F3_DONE: stops the motor
+****************************************************************************/
+static void StopMotor ( ES_Event ThisEvent )
+{
+	//Stop the motor
+	PWMBatch_WriteDuty( 0, PWM_CHAN );
+}
+
+/****************************************************************************
+ Function
+     StartCelebration
+
+ Description
+     Wait4CelebrationF3 on ES_CELEBRATION: spins the flipbook faster
+****************************************************************************/
+static void StartCelebration ( ES_Event ThisEvent )
+{
+	// start the F3 motor, at the celebration period
+	PWMBatch_WritePulseWidth( SpinControl_Start( &Spin, PWM_CELEB_PULSE, CELEB_PERIOD ), PWM_CHAN );
+	#if DEBUG_F3
+	printf("F3S: celebration mode!\n\r\n");
+	#endif
+}
+
+/****************************************************************************
+ Function
+     HoldSpinRate
+
+ Description
+     Wait4CelebrationF3 on ES_F3_DONE: the limit switch closes once a
+     revolution, so times the revolution and trims the pulse to hold
+     CELEB_PERIOD (nothing happens before the celebration starts)
+****************************************************************************/
+static void HoldSpinRate ( ES_Event ThisEvent )
+{
+	uint16_t Pulse;
+
+	if ( SpinControl_Revolution( &Spin, ThisEvent.EventParam, &Pulse ) == true ) {
+		PWMBatch_WritePulseWidth( Pulse, PWM_CHAN );
+		#if DEBUG_F3
+		printf("F3S: revolution %u, %d off, pulse %u\n\r\n", Spin.Period, Spin.Error, Pulse);
+		#endif
+	}
+}
+
+/****************************************************************************
+ Function
+     StartReset
+
+ Description
+     Flip3Running on ES_RESET: turns the motor on to spin the flipbook back
+     to the beginning
+****************************************************************************/
+static void StartReset ( ES_Event ThisEvent )
+{
+	//Stop holding the celebration period, turn on the motor to reset to the beginning
+	SpinControl_Stop( &Spin );
+	PWMBatch_WritePulseWidth( PWM_RESET_PULSE, PWM_CHAN );
+}
+
+/****************************************************************************
+ Function
+     DoneResetting
+
+ Description
+     Wait4ResetF3 on ES_F3_DONE: stops the motor and tells MainStoryService
+     this flipbook is reset
+****************************************************************************/
+static void DoneResetting ( ES_Event ThisEvent )
+{
+	ES_Event Event2Post;
+
+	//Turn off motor
+	PWMBatch_WriteDuty( 0, PWM_CHAN );
+	#if DEBUG_F3
+	printf("F3S: Wait4ResetF3 - done resetting flipbook\n\r\n");
+	#endif
+	// post an ES_DONE_INIT to the MainService
+	Event2Post.EventType = ES_DONE_INIT;
+	PostMainService( Event2Post );
+}
 
 /*------------------------------- Footnotes -------------------------------*/
 /*------------------------------ End of file ------------------------------*/
@@ -23,10 +23,13 @@
 #include <cmath>
 #include "ES_Configure.h"
 #include "ES_Framework.h"
+#include "ES_Broadcast.h"
+#include "ES_QueueStats.h"
 #include "TemplateService.h"
 
 // include the PWM library
 #include "PWM8Tiva.h"
+#include "PWMBatch.h"
 #include "PWMTiva.h"
 
 // the headers to access the GPIO subsystem
@@ -69,6 +72,8 @@
 /* prototypes for private functions for this service.They should be functions
    relevant to the behavior of this service
 */
+static ES_Event HandleFruitEvent ( ES_Event ThisEvent );
+static uint8_t QueryState ( void );
 
 /*---------------------------- Module Variables ---------------------------*/
 // with the introduction of Gen2, we need a module level Priority variable
@@ -105,7 +110,7 @@ bool InitFruitService ( uint8_t Priority )
 	
 	//Post Event ES_Init to PostFruitService queue (this service)
   ThisEvent.EventType = ES_INIT;
-  if (ES_PostToService( MyPriority, ThisEvent) == true)
+  if (ES_QueueStatsPost( MyPriority, ThisEvent) == true)
   {
       return true;
   }else
@@ -133,13 +138,31 @@ bool InitFruitService ( uint8_t Priority )
 ****************************************************************************/
 bool PostFruitService( ES_Event ThisEvent )
 {
-  return ES_PostToService( MyPriority, ThisEvent);
+  return ES_QueueStatsPost( MyPriority, ThisEvent);
 }
 
 /****************************************************************************
  Function
     RunFruitService
 
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, whatever HandleFruitEvent returns
+
+ Description
+   Runs ThisEvent through HandleFruitEvent by way of ES_QueueStatsRun
+****************************************************************************/
+ES_Event RunFruitService( ES_Event ThisEvent )
+{
+	return ES_QueueStatsRun( MyPriority, ThisEvent, HandleFruitEvent, QueryState );
+}
+
+/****************************************************************************
+ Function
+    HandleFruitEvent
+
  Parameters
    ES_Event : the event to process
 	 Input event can be: ES_F3_DONE, ES_INIT, ES_RESET
@@ -155,7 +178,7 @@ bool PostFruitService( ES_Event ThisEvent )
  Author
   Harine Ravichandiran
 ****************************************************************************/
-ES_Event RunFruitService( ES_Event ThisEvent )
+static ES_Event HandleFruitEvent( ES_Event ThisEvent )
 {
 	//Local Variables: NextState
 	ES_Event ReturnEvent;
@@ -164,6 +187,11 @@ ES_Event RunFruitService( ES_Event ThisEvent )
 	//Set NextFruitState to CurrentState
   FruitMotorState_t NextState = CurrentState;
 	
+	//If ThisEvent is ES_BROADCAST, replace it with the next event in the broadcast ring
+	if ( ThisEvent.EventType == ES_BROADCAST ) {
+		ThisEvent = ES_BroadcastFetch( MyPriority );
+	}
+	
 	//Based on the state of the CurrentState variable choose one of the following blocks of code:
 	switch ( CurrentState ){
 		//CurrentState is InitFruitService
@@ -171,7 +199,7 @@ ES_Event RunFruitService( ES_Event ThisEvent )
 			//if ThisEvent is ES_INIT
 			if (ThisEvent.EventType == ES_INIT){
                 //Sets the frequency of the PWM pin
-				PWM8_TIVA_SetFreq( PWM_FREQ, PWM_GROUP );
+				PWMBatch_InitGroups( PWM_FREQ, PWM_BATCH_GROUP_BIT(PWM_GROUP) );
 				//set NextState to Wait4Flip3DoneFr
 				NextState = Wait4Flip3DoneFr;
 				#if DEBUG_FRUIT
@@ -185,7 +213,7 @@ ES_Event RunFruitService( ES_Event ThisEvent )
 			//if ThisEvent event type is ES_F3_DONE,
 			if (ThisEvent.EventType == ES_F3_DONE){
 				//Turn motor on
-				PWM8_TIVA_SetPulseWidth (PWM_PULSE, PWM_CHAN);
+				PWMBatch_WritePulseWidth(PWM_PULSE, PWM_CHAN);
 				//set NextState to FruitDispensing
 				NextState = Wait4FrDispDone;
 				#if DEBUG_FRUIT
@@ -198,7 +226,7 @@ ES_Event RunFruitService( ES_Event ThisEvent )
 			//if ThisEvent event type is ES_TIMEOUT,
 			if (ThisEvent.EventType == ES_FR_DISP_DONE){
 				//Stop the motor
-				PWM8_TIVA_SetDuty( 0, PWM_CHAN );
+				PWMBatch_WriteDuty( 0, PWM_CHAN );
 				#if DEBUG_FRUIT
 				printf("Fruit: Fruit motor stopped after dispensing one fruit. \n\r\n");
 				#endif
@@ -213,7 +241,19 @@ ES_Event RunFruitService( ES_Event ThisEvent )
 	}
 	CurrentState = NextState;
   return ReturnEvent;
-} // End of RunFruitService
+} // End of HandleFruitEvent
+
+/****************************************************************************
+ Function
+     QueryState
+
+ Returns
+     uint8_t, the current state, for the trace kept by ES_QueueStatsRun
+****************************************************************************/
+static uint8_t QueryState ( void )
+{
+	return CurrentState;
+}
 
 /***************************************************************************
  private functions
@@ -0,0 +1,251 @@
+/****************************************************************************
+ Module
+   IRCapture.c
+
+ Description
+   Interrupt driven, timestamped edge capture for the IR break beam
+   sensors (IR1 on PA4, IR2 on PA5). The GPIO interrupt latches every
+   rising edge (a hand in the beam) with the time off a free running wide
+   timer into a ring buffer, and CheckIREdges posts ES_IR1_HI or ES_IR2_HI
+   for each one. The event carries the time since the other sensor's last
+   edge, so the air service can tell how fast the hand is waving.
+
+ Notes
+   IRCaptureISR must be installed as the GPIO Port A handler in the vector
+   table of the startup file.
+   PA4 and PA5 are not timer capture (CCP) pins, so the time is read from
+   wide timer 0A at the start of the ISR rather than latched by the timer.
+   The timer runs at the 40MHz system clock, so the stamp is good to well
+   under a microsecond plus the interrupt latency. It wraps every 107 S,
+   only differences of stamps are used.
+   The ring is single producer (the ISR only writes Head) and single
+   consumer (CheckIREdges only writes Tail), the same as SwitchCapture.
+   When it is full new edges are dropped and counted.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_timer.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/gpio.h"
+
+#include "BITDEFS.H"
+#include "IRCapture.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define ALL_BITS (0xff<<2)
+
+#define PORT_A          BIT0HI
+#define GPIOA_INT_EN    BIT0HI      // GPIO port A is interrupt 0, bit 0 of EN0
+#define WTIMER_0        BIT0HI
+
+#define IR1_PIN         GPIO_PIN_4  // PA4
+#define IR2_PIN         GPIO_PIN_5  // PA5
+#define IR_PINS         (IR1_PIN | IR2_PIN)
+
+#define WTIMER_CFG_32_BIT 0x4       // wide timer A and B as separate 32 bit timers
+#define TICKS_PER_US    40          // the system clock, and the time stamps
+
+#define RING_SIZE 8                 // must be a power of 2
+#define RING_MASK (RING_SIZE-1)
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct {
+	uint32_t Time;     // timer ticks when the edge was latched
+	uint8_t  Changed;  // pins that raised the interrupt
+} IREdge_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void PostEdge ( uint8_t Which, uint32_t Time );
+
+/*---------------------------- Module Variables ---------------------------*/
+static pPostFunc PostEdgeTo;
+// time of each sensor's last edge, and whether it has had one
+static uint32_t LastEdgeTime[2];
+static bool EdgeSeen[2];
+
+// ISR -> main loop ring
+static volatile IREdge_t Ring[RING_SIZE];
+static volatile uint8_t Head;    // written only by the ISR
+static volatile uint8_t Tail;    // written only by CheckIREdges
+static volatile uint16_t NumOverflows;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     IRCapture_Init
+
+ Parameters
+     pPostFunc Post : where to post ES_IR1_HI and ES_IR2_HI
+
+ Description
+     Starts the time stamp timer and sets PA4 and PA5 up as digital inputs
+     interrupting on the rising edge. Called from the air service's Init.
+****************************************************************************/
+void IRCapture_Init ( pPostFunc Post )
+{
+	PostEdgeTo = Post;
+	EdgeSeen[0] = false;
+	EdgeSeen[1] = false;
+
+	//wide timer 0A: 32 bit, free running down from the top at the system clock
+	HWREG(SYSCTL_RCGCWTIMER) |= WTIMER_0;
+	while ((HWREG(SYSCTL_PRWTIMER) & WTIMER_0) != WTIMER_0);
+	HWREG(WTIMER0_BASE+TIMER_O_CTL) &= ~TIMER_CTL_TAEN;
+	HWREG(WTIMER0_BASE+TIMER_O_CFG) = WTIMER_CFG_32_BIT;
+	HWREG(WTIMER0_BASE+TIMER_O_TAMR) = TIMER_TAMR_TAMR_PERIOD;
+	HWREG(WTIMER0_BASE+TIMER_O_TAILR) = 0xffffffff;
+	HWREG(WTIMER0_BASE+TIMER_O_CTL) |= TIMER_CTL_TASTALL | TIMER_CTL_TAEN;
+
+	HWREG(SYSCTL_RCGCGPIO) |= PORT_A; //enable port A
+	//wait for peripheral clock
+	while ((HWREG(SYSCTL_PRGPIO) & PORT_A) != PORT_A);
+	//the pins to digital inputs
+	HWREG(GPIO_PORTA_BASE+GPIO_O_DEN) |= IR_PINS;
+	HWREG(GPIO_PORTA_BASE+GPIO_O_DIR) &= ~IR_PINS;
+	//edge sensitive, on the rising edge only
+	HWREG(GPIO_PORTA_BASE+GPIO_O_IS) &= ~IR_PINS;
+	HWREG(GPIO_PORTA_BASE+GPIO_O_IBE) &= ~IR_PINS;
+	HWREG(GPIO_PORTA_BASE+GPIO_O_IEV) |= IR_PINS;
+	//clear anything left over from the setup, then unmask the pins
+	HWREG(GPIO_PORTA_BASE+GPIO_O_ICR) = IR_PINS;
+	HWREG(GPIO_PORTA_BASE+GPIO_O_IM) |= IR_PINS;
+	HWREG(NVIC_EN0) = GPIOA_INT_EN;
+}
+
+/****************************************************************************
+ Function
+     IRCapture_QueryTime
+
+ Returns
+     uint32_t, the time stamp clock now, in system clock ticks
+****************************************************************************/
+uint32_t IRCapture_QueryTime ( void )
+{
+	return ~HWREG(WTIMER0_BASE+TIMER_O_TAV);
+}
+
+/****************************************************************************
+ Function
+     IRCapture_QueryOverflows
+
+ Returns
+     uint16_t, number of edges dropped because the ring was full
+****************************************************************************/
+uint16_t IRCapture_QueryOverflows ( void )
+{
+	return NumOverflows;
+}
+
+/****************************************************************************
+ Function
+     IRCaptureISR
+
+ Description
+     GPIO port A interrupt response. Reads the time first, then clears the
+     source and latches which pins rose and when into the ring.
+****************************************************************************/
+void IRCaptureISR ( void )
+{
+	uint32_t Time = ~HWREG(WTIMER0_BASE+TIMER_O_TAV);
+	uint8_t Changed;
+	uint8_t Slot;
+
+	//find out which pins interrupted and clear them
+	Changed = HWREG(GPIO_PORTA_BASE+GPIO_O_MIS);
+	HWREG(GPIO_PORTA_BASE+GPIO_O_ICR) = Changed;
+
+	//if there is room in the ring, latch the edge
+	if ( (uint8_t)(Head - Tail) < RING_SIZE ) {
+		Slot = Head & RING_MASK;
+		Ring[Slot].Time = Time;
+		Ring[Slot].Changed = Changed;
+		//publish the entry only once it is complete
+		Head++;
+	} else {
+		NumOverflows++;
+	}
+}
+
+/****************************************************************************
+ Function
+     CheckIREdges
+
+ Parameters
+     Takes no parameters
+
+ Returns
+     bool, returns True if an event posted, false otherwise
+
+ Description
+     Event checker. Returns right away when the ring is empty, otherwise
+     posts ES_IR1_HI or ES_IR2_HI for every edge latched, in order.
+****************************************************************************/
+bool CheckIREdges ( void )
+{
+	bool ReturnVal = false;
+	IREdge_t Edge;
+	uint8_t Slot;
+
+	//drain everything latched since the last pass, if anything
+	while ( Tail != Head ) {
+		Slot = Tail & RING_MASK;
+		Edge.Time = Ring[Slot].Time;
+		Edge.Changed = Ring[Slot].Changed;
+		//hand the slot back to the ISR
+		Tail++;
+
+		if ( Edge.Changed & IR1_PIN ) {
+			PostEdge( 0, Edge.Time );
+			ReturnVal = true;
+		}
+		if ( Edge.Changed & IR2_PIN ) {
+			PostEdge( 1, Edge.Time );
+			ReturnVal = true;
+		}
+	}
+	return ReturnVal;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     PostEdge
+
+ Description
+     Posts ES_IR1_HI (Which 0) or ES_IR2_HI (Which 1), with the time since
+     the other sensor's last edge, and remembers this edge's time.
+****************************************************************************/
+static void PostEdge ( uint8_t Which, uint32_t Time )
+{
+	ES_Event ThisEvent;
+	uint8_t Other = Which ^ 1;
+	uint32_t Interval;
+
+	ThisEvent.EventType = ( Which == 0 ) ? ES_IR1_HI : ES_IR2_HI;
+	ThisEvent.EventParam = IR_NO_INTERVAL;
+	if ( EdgeSeen[Other] ) {
+		Interval = (Time - LastEdgeTime[Other]) / (TICKS_PER_US * IR_INTERVAL_US);
+		if ( Interval < IR_NO_INTERVAL ) {
+			ThisEvent.EventParam = Interval;
+		}
+	}
+	LastEdgeTime[Which] = Time;
+	EdgeSeen[Which] = true;
+	#if DEBUG_IR
+	printf("IR%u edge, %u x %uuS after IR%u\n\r\n", Which + 1,
+	       ThisEvent.EventParam, IR_INTERVAL_US, Other + 1);
+	#endif
+	PostEdgeTo( ThisEvent );
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
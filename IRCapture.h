@@ -0,0 +1,32 @@
+/****************************************************************************
+
+  Header file for IRCapture (timestamped edge capture for the IR break
+  beam sensors)
+
+ ****************************************************************************/
+
+#ifndef IRCapture_H
+#define IRCapture_H
+
+// Event Definitions
+#include "ES_Configure.h" /* gets us event definitions */
+#include "ES_Types.h"     /* gets bool type for returns */
+#include "ES_Framework.h" /* gets pPostFunc */
+
+// ES_IR1_HI and ES_IR2_HI carry the time since the other sensor's last
+// edge, in these units
+#define IR_INTERVAL_US 100
+// the interval when the other sensor hasn't had an edge, or it is too long
+// to fit (6.5 S or more)
+#define IR_NO_INTERVAL 0xffff
+
+// Public Function Prototypes
+void IRCapture_Init ( pPostFunc Post );
+uint32_t IRCapture_QueryTime ( void );
+uint16_t IRCapture_QueryOverflows ( void );
+void IRCaptureISR ( void );
+
+//Event checkers
+bool CheckIREdges ( void );
+
+#endif /* IRCapture_H */
@@ -0,0 +1,141 @@
+/****************************************************************************
+ Module
+   IntTrig.c
+
+ Description
+   atan2 and hypot on integers, for turning accelerometer axes into a tilt
+   angle without the soft float math library. Angles are in tenths of a
+   degree (ANGLE_SCALE).
+
+ Notes
+   IntAtan2 folds the vector into the first octant, where the angle is
+   atan of the smaller component over the larger, 0 to 1. That ratio is
+   looked up in a 65 entry table of atan(i/64) and interpolated, which is
+   good to the 0.1 degree the table is rounded to. It costs one divide.
+   IntHypot is the bit by bit integer square root of X^2 + Y^2.
+   Both take components below 32768 in size (the ADC readings are 12
+   bits), so the squares and the Q16 ratio fit in 32 bits.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "IntTrig.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// the table has a step every 1/64 of the ratio, the ratio is in Q16
+#define TABLE_BITS  6
+#define FRAC_BITS   (16 - TABLE_BITS)
+
+#define ANGLE_90    DEG(90)
+#define ANGLE_180   DEG(180)
+
+/*---------------------------- Module Functions ---------------------------*/
+static int16_t FirstOctant ( uint32_t Small, uint32_t Large );
+
+/*---------------------------- Module Variables ---------------------------*/
+// atan(i/64) in tenths of a degree, i = 0 to 64
+static const int16_t AtanTable[(1 << TABLE_BITS) + 1] = {
+	  0,   9,  18,  27,  36,  45,  54,  62,  71,
+	 80,  89,  98, 106, 115, 123, 132, 140, 149,
+	157, 165, 174, 182, 190, 198, 206, 213, 221,
+	229, 236, 244, 251, 258, 266, 273, 280, 287,
+	294, 300, 307, 314, 320, 326, 333, 339, 345,
+	351, 357, 363, 369, 374, 380, 386, 391, 396,
+	402, 407, 412, 417, 422, 427, 432, 436, 441,
+	445, 450
+};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   IntAtan2
+
+ Parameters
+   int32_t Y, X : the vector, each component below 32768 in size
+
+ Returns
+   int16_t, the angle of the vector from the X axis, -1800 to 1800 (tenths
+   of a degree), positive towards Y. 0 for a zero vector.
+****************************************************************************/
+int16_t IntAtan2 ( int32_t Y, int32_t X )
+{
+	uint32_t AbsY = ( Y < 0 ) ? -Y : Y;
+	uint32_t AbsX = ( X < 0 ) ? -X : X;
+	int16_t Angle;
+
+	if ( (AbsX == 0) && (AbsY == 0) ) {
+		return 0;
+	}
+	//angle in the first quadrant, from whichever octant it is in
+	if ( AbsY <= AbsX ) {
+		Angle = FirstOctant( AbsY, AbsX );
+	} else {
+		Angle = ANGLE_90 - FirstOctant( AbsX, AbsY );
+	}
+	//then unfold it into the vector's quadrant
+	if ( X < 0 ) {
+		Angle = ANGLE_180 - Angle;
+	}
+	if ( Y < 0 ) {
+		Angle = -Angle;
+	}
+	return Angle;
+}
+
+/****************************************************************************
+ Function
+   IntHypot
+
+ Parameters
+   int32_t X, Y : the vector, each component below 32768 in size
+
+ Returns
+   uint16_t, the length of the vector, rounded down
+****************************************************************************/
+uint16_t IntHypot ( int32_t X, int32_t Y )
+{
+	uint32_t Square = (uint32_t)(X * X) + (uint32_t)(Y * Y);
+	uint32_t Root = 0;
+	uint32_t Bit = 1ul << 30;
+
+	//highest power of 4 not above the square
+	while ( Bit > Square ) {
+		Bit >>= 2;
+	}
+	//one bit of the root each time round
+	while ( Bit != 0 ) {
+		if ( Square >= Root + Bit ) {
+			Square -= Root + Bit;
+			Root = (Root >> 1) + Bit;
+		} else {
+			Root >>= 1;
+		}
+		Bit >>= 2;
+	}
+	return (uint16_t)Root;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+   FirstOctant
+
+ Description
+   atan(Small / Large) for 0 <= Small <= Large, Large > 0, interpolated
+   from the table
+****************************************************************************/
+static int16_t FirstOctant ( uint32_t Small, uint32_t Large )
+{
+	uint32_t Ratio = (Small << 16) / Large;
+	uint32_t Index = Ratio >> FRAC_BITS;
+	uint32_t Frac = Ratio & ((1ul << FRAC_BITS) - 1);
+
+	if ( Index >= (1 << TABLE_BITS) ) {
+		return AtanTable[1 << TABLE_BITS];
+	}
+	return AtanTable[Index] + (int16_t)(((AtanTable[Index + 1] - AtanTable[Index]) * Frac +
+	                                     (1ul << (FRAC_BITS - 1))) >> FRAC_BITS);
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,21 @@
+/****************************************************************************
+
+  Header file for IntTrig (integer atan2 and hypot, no floating point)
+
+ ****************************************************************************/
+
+#ifndef IntTrig_H
+#define IntTrig_H
+
+#include "ES_Types.h"
+
+// angles are in tenths of a degree
+#define ANGLE_SCALE 10
+// an angle in degrees, only for constant expressions
+#define DEG( x ) ( (int16_t)( (x) * ANGLE_SCALE + ((x) < 0 ? -0.5 : 0.5) ) )
+
+// Public Function Prototypes
+int16_t IntAtan2 ( int32_t Y, int32_t X );
+uint16_t IntHypot ( int32_t X, int32_t Y );
+
+#endif /* IntTrig_H */
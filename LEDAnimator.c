@@ -0,0 +1,379 @@
+/****************************************************************************
+ Module
+   LEDAnimator.c
+
+ Description
+   Plays keyframe brightness curves (clips) and fades on up to
+   ANIM_MAX_CHANNELS LED channels. Timer 1A interrupts ANIM_TICK_RATE
+   times a second, and its ISR moves every channel on by ANIM_TICK_TIME
+   from the channel descriptors and writes the levels that changed through
+   the output function. The services only start clips and fades, so the
+   LEDs move smoothly however busy the event queues are.
+
+ Notes
+   LEDAnimISR must be installed as the Timer 1A handler in the vector table
+   of the startup file.
+   The clips are const tables of keys (see LEDAnimator.h), so a channel is
+   just a clip pointer, the key it is past and the time into the clip. A
+   fade is a two key clip kept in the channel itself.
+   A blink is a looping clip of ANIM_STEP keys, a ramp one or two
+   ANIM_LINEAR or ANIM_EASE keys, a pulse a looping pair of ANIM_EASE keys.
+   Only the ISR writes the outputs. The calls below change a descriptor
+   with the timer interrupt masked, so the ISR never sees half of one, and
+   a change shows on the next tick (within ANIM_TICK_TIME).
+   The flush function, when there is one, runs once at the end of a tick
+   that wrote anything, so the output can stage a tick's levels and send
+   them to the hardware together.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_timer.h"
+
+#include "BITDEFS.H"
+#include "LEDAnimator.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define TICKS_PER_SEC   40000000    // the system clock
+#define TIMER1A_INT_EN  BIT21HI     // timer 1A is interrupt 21, bit 21 of EN0
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct {
+	const AnimClip_t *pClip;  // 0 when the channel is holding a level
+	uint8_t  Key;             // the key the clip is past
+	uint16_t Elapsed;         // mS into the clip
+	uint8_t  StartLevel;      // first key level for FromCurrent clips
+	bool     FirstPass;       // StartLevel only applies before a loop
+	uint8_t  Hold;            // the level without a clip
+	uint8_t  Level;           // last level written
+	bool     Force;           // write on the next tick even if unchanged
+	AnimKey_t FadeKeys[2];    // the clip for LEDAnim_FadeTo
+	AnimClip_t Fade;
+} AnimChannel_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static uint8_t Evaluate ( AnimChannel_t *pChan );
+static void StartClip ( AnimChannel_t *pChan, const AnimClip_t *pClip );
+static void MaskTick ( void );
+static void UnmaskTick ( void );
+
+/*---------------------------- Module Variables ---------------------------*/
+static pAnimOutput Output;
+static pAnimFlush Flush;
+static uint8_t NumChannels;
+static volatile AnimChannel_t Channels[ANIM_MAX_CHANNELS];
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     LEDAnim_Init
+
+ Parameters
+     pAnimOutput Out : writes a channel's level to the hardware, it is
+                       called from the timer interrupt
+     pAnimFlush Done : called after a tick's writes, or 0 for none
+     uint8_t Num : channels in use, 0 to Num-1
+
+ Description
+     Sets the animator up with every channel holding off and starts the
+     tick interrupt. Nothing is written until a level changes.
+****************************************************************************/
+void LEDAnim_Init ( pAnimOutput Out, pAnimFlush Done, uint8_t Num )
+{
+	uint8_t i;
+
+	Output = Out;
+	Flush = Done;
+	NumChannels = ( Num > ANIM_MAX_CHANNELS ) ? ANIM_MAX_CHANNELS : Num;
+	for ( i = 0; i < ANIM_MAX_CHANNELS; i++ ) {
+		Channels[i].pClip = 0;
+		Channels[i].Hold = ANIM_LEVEL_OFF;
+		Channels[i].Level = ANIM_LEVEL_OFF;
+		Channels[i].Force = false;
+	}
+
+	//timer 1A: 32 bit periodic at ANIM_TICK_RATE, interrupting on time out
+	HWREG(SYSCTL_RCGCTIMER) |= SYSCTL_RCGCTIMER_R1;
+	while( (HWREG(SYSCTL_PRTIMER) & SYSCTL_PRTIMER_R1) != SYSCTL_PRTIMER_R1 );
+	HWREG(TIMER1_BASE+TIMER_O_CTL) &= ~TIMER_CTL_TAEN;
+	HWREG(TIMER1_BASE+TIMER_O_CFG) = TIMER_CFG_32_BIT_TIMER;
+	HWREG(TIMER1_BASE+TIMER_O_TAMR) = TIMER_TAMR_TAMR_PERIOD;
+	HWREG(TIMER1_BASE+TIMER_O_TAILR) = (TICKS_PER_SEC / ANIM_TICK_RATE) - 1;
+	HWREG(TIMER1_BASE+TIMER_O_ICR) = TIMER_ICR_TATOCINT;
+	HWREG(TIMER1_BASE+TIMER_O_IMR) |= TIMER_IMR_TATOIM;
+	HWREG(NVIC_EN0) = TIMER1A_INT_EN;
+	HWREG(TIMER1_BASE+TIMER_O_CTL) |= TIMER_CTL_TASTALL | TIMER_CTL_TAEN;
+}
+
+/****************************************************************************
+ Function
+     LEDAnim_Play
+
+ Parameters
+     uint8_t Channel : the channel to play on
+     const AnimClip_t *pClip : the clip, it must stay in place while it plays
+
+ Description
+     Starts the clip from its beginning on the next tick, replacing
+     whatever the channel was doing. Channels started between the same two
+     ticks stay in step.
+****************************************************************************/
+void LEDAnim_Play ( uint8_t Channel, const AnimClip_t *pClip )
+{
+	if ( Channel >= NumChannels ) {
+		return;
+	}
+	//a clip with a single key is just a level
+	if ( pClip->NumKeys < 2 ) {
+		LEDAnim_Set( Channel, pClip->pKeys[0].Level );
+		return;
+	}
+	MaskTick();
+	StartClip( (AnimChannel_t *)&Channels[Channel], pClip );
+	UnmaskTick();
+}
+
+/****************************************************************************
+ Function
+     LEDAnim_FadeTo
+
+ Parameters
+     uint8_t Channel : the channel
+     uint8_t Level : where to end up, ANIM_LEVEL_OFF to ANIM_LEVEL_FULL
+     uint16_t Time : mS to get there, in a straight line from the level now
+
+ Description
+     Replaces whatever the channel was doing with the fade, and holds Level
+     at the end. A Time under a tick just sets the level.
+****************************************************************************/
+void LEDAnim_FadeTo ( uint8_t Channel, uint8_t Level, uint16_t Time )
+{
+	AnimChannel_t *pChan;
+
+	if ( Channel >= NumChannels ) {
+		return;
+	}
+	if ( Time < ANIM_TICK_TIME ) {
+		LEDAnim_Set( Channel, Level );
+		return;
+	}
+	MaskTick();
+	pChan = (AnimChannel_t *)&Channels[Channel];
+	pChan->FadeKeys[0].Time = 0;
+	pChan->FadeKeys[0].Level = Level;   // replaced by the level now
+	pChan->FadeKeys[0].Curve = ANIM_LINEAR;
+	pChan->FadeKeys[1].Time = Time;
+	pChan->FadeKeys[1].Level = Level;
+	pChan->FadeKeys[1].Curve = ANIM_STEP;
+	pChan->Fade.pKeys = pChan->FadeKeys;
+	pChan->Fade.NumKeys = 2;
+	pChan->Fade.Loop = false;
+	pChan->Fade.FromCurrent = true;
+	StartClip( pChan, &pChan->Fade );
+	UnmaskTick();
+}
+
+/****************************************************************************
+ Function
+     LEDAnim_Set
+
+ Parameters
+     uint8_t Channel : the channel
+     uint8_t Level : ANIM_LEVEL_OFF to ANIM_LEVEL_FULL
+
+ Description
+     Stops any clip on the channel and holds it at Level from the next tick
+****************************************************************************/
+void LEDAnim_Set ( uint8_t Channel, uint8_t Level )
+{
+	if ( Channel >= NumChannels ) {
+		return;
+	}
+	MaskTick();
+	Channels[Channel].pClip = 0;
+	Channels[Channel].Hold = Level;
+	UnmaskTick();
+}
+
+/****************************************************************************
+ Function
+     LEDAnim_StopAll
+
+ Parameters
+     uint8_t Level : what to leave every channel at
+
+ Description
+     Stops every clip, and has the next tick write Level to every channel
+     even where it looks unchanged, so the hardware is in a known state.
+****************************************************************************/
+void LEDAnim_StopAll ( uint8_t Level )
+{
+	uint8_t i;
+
+	MaskTick();
+	for ( i = 0; i < NumChannels; i++ ) {
+		Channels[i].pClip = 0;
+		Channels[i].Hold = Level;
+		Channels[i].Force = true;
+	}
+	UnmaskTick();
+}
+
+/****************************************************************************
+ Function
+     LEDAnim_QueryLevel
+
+ Returns
+     uint8_t, the channel's level as last written
+****************************************************************************/
+uint8_t LEDAnim_QueryLevel ( uint8_t Channel )
+{
+	return ( Channel < NumChannels ) ? Channels[Channel].Level : ANIM_LEVEL_OFF;
+}
+
+/****************************************************************************
+ Function
+     LEDAnim_IsPlaying
+
+ Returns
+     bool, true while a clip or fade is playing on the channel
+****************************************************************************/
+bool LEDAnim_IsPlaying ( uint8_t Channel )
+{
+	return ( Channel < NumChannels ) && ( Channels[Channel].pClip != 0 );
+}
+
+/****************************************************************************
+ Function
+     LEDAnimISR
+
+ Description
+     Timer 1A time out. Works out every channel's level at its time into
+     its clip, writes the ones that changed and moves the clips on a tick,
+     then flushes the writes.
+****************************************************************************/
+void LEDAnimISR ( void )
+{
+	uint8_t i;
+	uint8_t Level;
+	bool Written = false;
+	AnimChannel_t *pChan;
+
+	HWREG(TIMER1_BASE+TIMER_O_ICR) = TIMER_ICR_TATOCINT;
+
+	for ( i = 0; i < NumChannels; i++ ) {
+		pChan = (AnimChannel_t *)&Channels[i];
+		if ( pChan->pClip != 0 ) {
+			Level = Evaluate( pChan );
+			pChan->Elapsed += ANIM_TICK_TIME;
+		} else {
+			Level = pChan->Hold;
+		}
+		if ( (Level != pChan->Level) || pChan->Force ) {
+			pChan->Level = Level;
+			pChan->Force = false;
+			Output( i, Level );
+			Written = true;
+		}
+	}
+	if ( Written && (Flush != 0) ) {
+		Flush();
+	}
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     StartClip
+
+ Description
+     Points the channel at the clip from its start, with the tick masked
+****************************************************************************/
+static void StartClip ( AnimChannel_t *pChan, const AnimClip_t *pClip )
+{
+	pChan->pClip = pClip;
+	pChan->Key = 0;
+	pChan->Elapsed = 0;
+	pChan->StartLevel = pChan->Level;
+	pChan->FirstPass = true;
+}
+
+/****************************************************************************
+ Function
+     Evaluate
+
+ Returns
+     uint8_t, a playing channel's level at its Elapsed time. A clip that has
+     run out loops, or stops and leaves the channel holding its last level.
+****************************************************************************/
+static uint8_t Evaluate ( AnimChannel_t *pChan )
+{
+	const AnimKey_t *pKeys = pChan->pClip->pKeys;
+	uint8_t Last = pChan->pClip->NumKeys - 1;
+	uint8_t From, To;
+	uint16_t Span;
+	uint32_t Frac;
+
+	//past the end, go round again or finish
+	if ( pChan->Elapsed >= pKeys[Last].Time ) {
+		if ( pChan->pClip->Loop && (pKeys[Last].Time > 0) ) {
+			pChan->Elapsed %= pKeys[Last].Time;
+			pChan->Key = 0;
+			pChan->FirstPass = false;
+		} else {
+			pChan->pClip = 0;
+			pChan->Hold = pKeys[Last].Level;
+			return pChan->Hold;
+		}
+	}
+	//find the keys either side, they only move forwards
+	while ( pChan->Elapsed >= pKeys[pChan->Key + 1].Time ) {
+		pChan->Key++;
+	}
+
+	From = pKeys[pChan->Key].Level;
+	if ( (pChan->Key == 0) && pChan->FirstPass && pChan->pClip->FromCurrent ) {
+		From = pChan->StartLevel;
+	}
+	To = pKeys[pChan->Key + 1].Level;
+
+	if ( pKeys[pChan->Key].Curve == ANIM_STEP ) {
+		return From;
+	}
+	//how far along this segment, 0 to 256
+	Span = pKeys[pChan->Key + 1].Time - pKeys[pChan->Key].Time;
+	Frac = ((uint32_t)(pChan->Elapsed - pKeys[pChan->Key].Time) << 8) / Span;
+	if ( pKeys[pChan->Key].Curve == ANIM_EASE ) {
+		//smoothstep, 3f^2 - 2f^3
+		Frac = (Frac * Frac * (3 * 256 - 2 * Frac)) >> 16;
+	}
+	return (uint8_t)(From + (((int16_t)To - From) * (int32_t)Frac) / 256);
+}
+
+/****************************************************************************
+ Function
+     MaskTick / UnmaskTick
+
+ Description
+     Hold off the tick interrupt while a descriptor changes. A time out in
+     between stays pending and is taken on the unmask.
+****************************************************************************/
+static void MaskTick ( void )
+{
+	HWREG(TIMER1_BASE+TIMER_O_IMR) &= ~TIMER_IMR_TATOIM;
+}
+
+static void UnmaskTick ( void )
+{
+	HWREG(TIMER1_BASE+TIMER_O_IMR) |= TIMER_IMR_TATOIM;
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
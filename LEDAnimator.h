@@ -0,0 +1,66 @@
+/****************************************************************************
+
+  Header file for LEDAnimator (keyframe brightness curves and fades for
+  the LED channels, advanced by a timer interrupt)
+
+ ****************************************************************************/
+
+#ifndef LEDAnimator_H
+#define LEDAnimator_H
+
+#include "ES_Types.h"
+
+// brightness levels run from off to full, the output maps them to duty
+#define ANIM_LEVEL_OFF  0
+#define ANIM_LEVEL_FULL 255
+// channels the animator can drive
+#define ANIM_MAX_CHANNELS 8
+// the interrupt advances every channel this many times a second, and the
+// clips' and fades' times are rounded to its mS
+#define ANIM_TICK_RATE 200
+#define ANIM_TICK_TIME (1000 / ANIM_TICK_RATE)
+
+// how the level moves from a key to the next one
+typedef enum { ANIM_STEP,     // hold the key's level (blinks)
+               ANIM_LINEAR,   // straight line
+               ANIM_EASE      // smoothstep, slow at both ends (ramps, pulses)
+             } AnimCurve_t;
+
+// one keyframe, Time is mS from the start of the clip, increasing
+typedef struct {
+	uint16_t Time;
+	uint8_t  Level;
+	uint8_t  Curve;   // AnimCurve_t, towards the next key
+} AnimKey_t;
+
+// a clip is a const table of keys. A looping clip goes back to its first
+// key when it reaches the last key's Time (so that key should match the
+// first), otherwise the channel holds the last level. FromCurrent starts
+// the clip from the channel's level now instead of the first key's.
+typedef struct {
+	const AnimKey_t *pKeys;
+	uint8_t NumKeys;
+	bool Loop;
+	bool FromCurrent;
+} AnimClip_t;
+
+// builds an AnimClip_t from a const array of keys
+#define ANIM_CLIP( Keys, Loop, FromCurrent ) \
+	{ (Keys), sizeof(Keys)/sizeof((Keys)[0]), (Loop), (FromCurrent) }
+
+// writes a channel's level to the hardware
+typedef void (*pAnimOutput)( uint8_t Channel, uint8_t Level );
+// sends the levels written in a tick to the hardware together
+typedef void (*pAnimFlush)( void );
+
+// Public Function Prototypes
+void LEDAnim_Init ( pAnimOutput Output, pAnimFlush Flush, uint8_t NumChannels );
+void LEDAnim_Play ( uint8_t Channel, const AnimClip_t *pClip );
+void LEDAnim_FadeTo ( uint8_t Channel, uint8_t Level, uint16_t Time );
+void LEDAnim_Set ( uint8_t Channel, uint8_t Level );
+void LEDAnim_StopAll ( uint8_t Level );
+uint8_t LEDAnim_QueryLevel ( uint8_t Channel );
+bool LEDAnim_IsPlaying ( uint8_t Channel );
+void LEDAnimISR ( void );
+
+#endif /* LEDAnimator_H */
@@ -0,0 +1,38 @@
+/****************************************************************************
+ Module
+   LEDGamma.c
+
+ Description
+   Pulse width for each LED level, gamma 2.2, 0 to 875 ticks
+   (70% of 1250).
+
+ Notes
+   Generated by tools/gen_gamma.py --gamma 2.2 --levels 256 --freq 1000 --tick-ns 800 --max-duty 70
+   Do not edit, run the script again instead.
+****************************************************************************/
+#include "LEDGamma.h"
+
+const uint16_t LEDGamma[LED_GAMMA_LEVELS] = {
+	   0,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,    1,
+	   1,    1,    1,    2,    2,    2,    3,    3,    3,    4,    4,    4,
+	   5,    5,    6,    6,    7,    7,    8,    8,    9,   10,   10,   11,
+	  12,   13,   13,   14,   15,   16,   17,   17,   18,   19,   20,   21,
+	  22,   23,   24,   25,   26,   28,   29,   30,   31,   32,   34,   35,
+	  36,   38,   39,   40,   42,   43,   45,   46,   48,   49,   51,   53,
+	  54,   56,   58,   59,   61,   63,   65,   66,   68,   70,   72,   74,
+	  76,   78,   80,   82,   84,   86,   89,   91,   93,   95,   97,  100,
+	 102,  104,  107,  109,  112,  114,  117,  119,  122,  124,  127,  129,
+	 132,  135,  138,  140,  143,  146,  149,  152,  155,  158,  161,  164,
+	 167,  170,  173,  176,  179,  182,  186,  189,  192,  195,  199,  202,
+	 206,  209,  212,  216,  219,  223,  227,  230,  234,  238,  241,  245,
+	 249,  253,  257,  260,  264,  268,  272,  276,  280,  284,  289,  293,
+	 297,  301,  305,  310,  314,  318,  323,  327,  331,  336,  340,  345,
+	 349,  354,  359,  363,  368,  373,  377,  382,  387,  392,  397,  402,
+	 407,  412,  417,  422,  427,  432,  437,  442,  447,  453,  458,  463,
+	 469,  474,  479,  485,  490,  496,  502,  507,  513,  518,  524,  530,
+	 536,  541,  547,  553,  559,  565,  571,  577,  583,  589,  595,  601,
+	 607,  614,  620,  626,  632,  639,  645,  651,  658,  664,  671,  677,
+	 684,  691,  697,  704,  711,  717,  724,  731,  738,  745,  752,  759,
+	 766,  773,  780,  787,  794,  801,  808,  816,  823,  830,  838,  845,
+	 853,  860,  867,  875
+};
@@ -0,0 +1,27 @@
+/****************************************************************************
+
+  Header file for LEDGamma (perceptual LED level to PWM pulse width)
+
+  Generated by tools/gen_gamma.py --gamma 2.2 --levels 256 --freq 1000 --tick-ns 800 --max-duty 70
+  Do not edit, run the script again instead.
+
+ ****************************************************************************/
+
+#ifndef LEDGamma_H
+#define LEDGamma_H
+
+#include "ES_Types.h"
+
+// the PWM the table was made for
+#define LED_GAMMA_PWM_FREQ 1000
+#define LED_GAMMA_PULSE_NS 800
+// pulse ticks in a PWM period
+#define LED_GAMMA_PERIOD 1250
+// the table's top entry is this duty, in percent
+#define LED_GAMMA_MAX_DUTY 70
+#define LED_GAMMA_LEVELS 256
+
+// pulse width for each level, in ticks of LED_GAMMA_PULSE_NS
+extern const uint16_t LEDGamma[LED_GAMMA_LEVELS];
+
+#endif /* LEDGamma_H */
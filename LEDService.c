@@ -26,11 +26,17 @@
 #include <cmath>
 #include "ES_Configure.h"
 #include "ES_Framework.h"
+#include "ES_Broadcast.h"
+#include "ES_Mailbox.h"
+#include "ES_QueueStats.h"
+#include "ES_SoftTimers.h"
+#include "ES_TableFSM.h"
 #include "LEDService.h"
 
 // include the PWM library
 #include "PWM8Tiva.h"
 #include "PWMTiva.h"
+#include "PWMBatch.h"
 
 // the headers to access the GPIO subsystem
 #include "inc/hw_memmap.h"
@@ -49,7 +55,11 @@
 #include "WaterBucketService.h"
 #include "Flipbook2Service.h"
 #include "ADMulti.h"
+#include "TiltCalibration.h"
 #include "MainStoryService.h"
+#include "AirService.h"
+#include "LEDAnimator.h"
+#include "LEDGamma.h"
 
 /*----------------------------- Module Defines ----------------------------*/
 
@@ -79,10 +89,15 @@
 #define MAX_SAFE_PWM_DUTY	70		//limit pwm to 85 of 99 to keep effective voltage below 12V, assuming 13.8V supply
 #define MIN_PWM_DUTY	0 
 
-// parameters for converting acc value to water brightness
-#define MIN_TILT_CHANGE 2300 //2600
-#define MIN_ACC   2610
-#define MAX_ACC   1999
+// the gamma table (tools/gen_gamma.py) has to be made for these LEDs
+#if LED_GAMMA_MAX_DUTY > MAX_SAFE_PWM_DUTY
+#error LEDGamma.c goes past MAX_SAFE_PWM_DUTY, run tools/gen_gamma.py --max-duty again
+#endif
+#if (LED_GAMMA_PWM_FREQ != PWM_Flip1LED_FREQ) || (LED_GAMMA_PWM_FREQ != PWM_Flip2LED_FREQ) || \
+    (LED_GAMMA_PWM_FREQ != PWM_Flip3LED_FREQ) || (LED_GAMMA_PWM_FREQ != PWM_WATER_LED_FREQ)
+#error LEDGamma.c is for another PWM frequency, run tools/gen_gamma.py --freq again
+#endif
+
 
 // these times assume a 1.000mS/tick timing
 #define ONE_SEC 976
@@ -90,44 +105,129 @@
 #define TWO_SEC (ONE_SEC*2)
 #define FIVE_SEC (ONE_SEC*5)
 
-// timers for blinkin
-#define BLINK_SEED_TIME  ONE_SEC
-#define BLINK_WATER_TIME ONE_SEC
+// half period of the blinks: seed and water, and the celebration
+#define BLINK_SLOW_TIME ONE_SEC
+#define BLINK_FAST_TIME HALF_SEC
+// time for a ramp from off to full, what the old steps of 4 every half
+// second took
+#define RAMP_TIME (ONE_SEC*9)
+// glides to a new water level or wave glow, about the time between samples
+#define WATER_FADE_TIME 100
+#define WAVE_FADE_TIME  HALF_SEC
 
 #define ALL_BITS (0xff<<2)
 
+// superstate of the running states, handles ES_RESET for all of them
+#define LEDRunning (Celebration + 1)
+#define NUM_LED_STATES (LEDRunning + 1)
+
 
 
 /*---------------------------- Module Functions ---------------------------*/
 /* prototypes for private functions for this machine.They should be functions
    relevant to the behavior of this state machine
 */
-
-static void RampF1LEDS( void );
-static void RampF2LEDS( void );
-static void RampF3LEDS( void );
-static void RampWaterLEDS ( uint8_t brightness );
-static void BlinkSeedLEDS(bool);
-static void BlinkWaterLEDS(bool);
-static void BlinkAllLEDS(bool);
-static void F1SetFullBrightness( void );
-static void F2SetFullBrightness( void );
-static void F3SetFullBrightness( void );
+static ES_Event HandleLEDEvent ( ES_Event ThisEvent );
+static uint8_t QueryState ( void );
+
+static void WriteLEDLevel( uint8_t Channel, uint8_t Level );
+static void FlushLEDLevels( void );
+static void BlinkAllLEDS( void );
+
+// state table actions and guards
+static void StartLEDs( ES_Event ThisEvent );
+static void StartF1( ES_Event ThisEvent );
+static void FinishF1( ES_Event ThisEvent );
+static bool IsPouring( ES_Event ThisEvent );
+static void StartF2( ES_Event ThisEvent );
+static void StartPouring( ES_Event ThisEvent );
+static void StopPouring( ES_Event ThisEvent );
+static void ShowWaterLevel( ES_Event ThisEvent );
+static void FinishF2( ES_Event ThisEvent );
+static void ShowWaveRate( ES_Event ThisEvent );
+static void StartF3( ES_Event ThisEvent );
+static void FinishF3( ES_Event ThisEvent );
+static void ReportReset( ES_Event ThisEvent );
 
 /*---------------------------- Module Variables ---------------------------*/
 // everybody needs a state variable, you may need others as well.
 // type of state variable should match that of enum in header file
 static LEDState_t CurrentState;
 
-//module level variables to set brightness of leds that can be reset easily and persists across function calls
-static uint8_t F1LED_Brightness = 0;				//flipbook 1 LED brightness
-static uint8_t F2LED_Brightness = 0;				//flipbook 2 LED brightness
-static uint8_t F3LED_Brightness = 0;				//flipbook 3 LED brightness
-static uint8_t WaterLED_Brightness = 0;			//water LED brightness
+// the animator's channels, and the PWM channel of each (the seed LED is
+// a GPIO line)
+enum { LED_F1, LED_F2, LED_F3, LED_WATER, LED_SEED, NUM_LED_CHANNELS };
+static const uint8_t LEDPWMChannels[LED_SEED] = {
+	PWM_Flip1LED_CHAN, PWM_Flip2LED_CHAN, PWM_Flip3LED_CHAN, PWM_WATER_LED_CHAN
+};
+// a tick's LED writes, so groups 2 and 3 change on the same PWM period
+static PWMBatch_t LEDBatch;
+
+// the clips, a ramp starts from wherever the LEDs are
+static const AnimKey_t RampKeys[] = {
+	{ 0,                 ANIM_LEVEL_OFF,  ANIM_EASE },
+	{ RAMP_TIME,         ANIM_LEVEL_FULL, ANIM_STEP }
+};
+static const AnimKey_t SlowBlinkKeys[] = {
+	{ 0,                 ANIM_LEVEL_FULL, ANIM_STEP },
+	{ BLINK_SLOW_TIME,   ANIM_LEVEL_OFF,  ANIM_STEP },
+	{ 2*BLINK_SLOW_TIME, ANIM_LEVEL_FULL, ANIM_STEP }
+};
+static const AnimKey_t FastBlinkKeys[] = {
+	{ 0,                 ANIM_LEVEL_FULL, ANIM_STEP },
+	{ BLINK_FAST_TIME,   ANIM_LEVEL_OFF,  ANIM_STEP },
+	{ 2*BLINK_FAST_TIME, ANIM_LEVEL_FULL, ANIM_STEP }
+};
+static const AnimClip_t RampClip = ANIM_CLIP( RampKeys, false, true );
+static const AnimClip_t SlowBlinkClip = ANIM_CLIP( SlowBlinkKeys, true, false );
+static const AnimClip_t FastBlinkClip = ANIM_CLIP( FastBlinkKeys, true, false );
+
+static bool Pouring = false;						//between ES_TILT_ENTER and ES_TILT_EXIT
 
 // with the introduction of Gen2, we need a module level Priority var as well
 static uint8_t MyPriority;
 
+// the transitions of each state
+static const ES_FSMRow_t InitRows[] = {
+	{ ES_INIT,          ES_FSM_ANY_PARAM,     0,          StartLEDs,         Waiting4Seed }
+};
+static const ES_FSMRow_t Waiting4SeedRows[] = {
+	{ ES_SEED_DETECTED, ES_FSM_ANY_PARAM,     0,          StartF1,           F1Run }
+};
+static const ES_FSMRow_t F1RunRows[] = {
+	{ ES_F1_DONE,       ES_FSM_ANY_PARAM,     0,          FinishF1,          Wait4Watering }
+};
+static const ES_FSMRow_t Wait4WateringRows[] = {
+	{ ES_TILT_ENTER,    ES_FSM_ANY_PARAM,     0,          StartF2,           F2Run }
+};
+static const ES_FSMRow_t F2RunRows[] = {
+	{ ES_TILT_ENTER,    ES_FSM_ANY_PARAM,     0,          StartPouring,      ES_FSM_NO_CHANGE },
+	{ ES_TILT_EXIT,     ES_FSM_ANY_PARAM,     0,          StopPouring,       ES_FSM_NO_CHANGE },
+	{ ES_WATER,         ES_FSM_ANY_PARAM,     IsPouring,  ShowWaterLevel,    ES_FSM_NO_CHANGE },
+	{ ES_F2_DONE,       ES_FSM_ANY_PARAM,     0,          FinishF2,          F3Run }
+};
+static const ES_FSMRow_t F3RunRows[] = {
+	{ ES_WAVE_RATE,     ES_FSM_ANY_PARAM,     0,          ShowWaveRate,      ES_FSM_NO_CHANGE },
+	{ ES_DONE_HARVEST,  ES_FSM_ANY_PARAM,     0,          StartF3,           ES_FSM_NO_CHANGE },
+	{ ES_F3_DONE,       ES_FSM_ANY_PARAM,     0,          FinishF3,          Celebration }
+};
+static const ES_FSMRow_t RunningRows[] = {
+	{ ES_RESET,         ES_FSM_ANY_PARAM,     0,          ReportReset,       InitLEDState }
+};
+
+// the machine, indexed by LEDState_t (plus the LEDRunning superstate)
+static const ES_FSMState_t LEDStates[NUM_LED_STATES] = {
+	/* InitLEDState */  ES_FSM_STATE( ES_FSM_NO_PARENT, InitRows ),
+	/* Waiting4Seed */  ES_FSM_STATE( LEDRunning, Waiting4SeedRows ),
+	/* F1Run */         ES_FSM_STATE( LEDRunning, F1RunRows ),
+	/* Wait4Watering */ ES_FSM_STATE( LEDRunning, Wait4WateringRows ),
+	/* F2Run */         ES_FSM_STATE( LEDRunning, F2RunRows ),
+	/* F3Run */         ES_FSM_STATE( LEDRunning, F3RunRows ),
+	/* Celebration */   ES_FSM_EMPTY_STATE( LEDRunning ),
+	/* LEDRunning */    ES_FSM_STATE( ES_FSM_NO_PARENT, RunningRows )
+};
+static const ES_FSM_t LEDMachine = { LEDStates, NUM_LED_STATES };
+
 
 /*------------------------------ Module Code ------------------------------*/
 /****************************************************************************
@@ -160,21 +260,15 @@ bool InitLEDService ( uint8_t Priority )
   CurrentState = InitLEDState;
 	
 	//initialize and turn on all PWM LEDs
-			//set frequency and duty for F1
-					PWM8_TIVA_SetFreq( PWM_Flip1LED_FREQ, PWM_Flip1LED_GROUP);
-					PWM8_TIVA_SetDuty( PWM_Flip1LED_DUTY, PWM_Flip1LED_CHAN );
-	
-			//set frequency and duty for F2
-					PWM8_TIVA_SetFreq( PWM_Flip2LED_FREQ, PWM_Flip2LED_GROUP);
-					PWM8_TIVA_SetDuty( PWM_Flip2LED_DUTY, PWM_Flip2LED_CHAN );
-	
-			//set frequency and duty for F3
-					PWM8_TIVA_SetFreq( PWM_Flip3LED_FREQ, PWM_Flip3LED_GROUP);
-					PWM8_TIVA_SetDuty( PWM_Flip3LED_DUTY, PWM_Flip3LED_CHAN );
-					
-			//set frequency and duty for water LED
-					PWM8_TIVA_SetFreq( PWM_WATER_LED_FREQ, PWM_WATER_LED_GROUP);
-					PWM8_TIVA_SetDuty( PWM_WATER_LED_DUTY, PWM_WATER_LED_CHAN );
+			//both LED groups at the same frequency (checked against LEDGamma above), on synchronized updates
+					PWMBatch_InitGroups( PWM_Flip1LED_FREQ, PWM_BATCH_GROUP_BIT(PWM_Flip1LED_GROUP) | PWM_BATCH_GROUP_BIT(PWM_Flip3LED_GROUP) );
+			//set the starting duty for all four together
+					PWMBatch_Begin( &LEDBatch );
+					PWMBatch_SetDuty( &LEDBatch, PWM_Flip1LED_DUTY, PWM_Flip1LED_CHAN );
+					PWMBatch_SetDuty( &LEDBatch, PWM_Flip2LED_DUTY, PWM_Flip2LED_CHAN );
+					PWMBatch_SetDuty( &LEDBatch, PWM_Flip3LED_DUTY, PWM_Flip3LED_CHAN );
+					PWMBatch_SetDuty( &LEDBatch, PWM_WATER_LED_DUTY, PWM_WATER_LED_CHAN );
+					PWMBatch_Commit( &LEDBatch );
 					
 	//set seed GPIO LED to on
 
@@ -189,9 +283,15 @@ bool InitLEDService ( uint8_t Priority )
 			// Start with seed LED on
 					HWREG(GPIO_PORTD_BASE+(GPIO_O_DATA + ALL_BITS)) |= SEED_LED_ON;
 	
+	//the blinks, ramps and fades run on the animator's timer interrupt
+	LEDAnim_Init( WriteLEDLevel, FlushLEDLevels, NUM_LED_CHANNELS );
+	
+	//subscribe to the water mailbox so we get the freshest tilt sample
+	ES_MailboxSubscribe( WATER_MAILBOX, MyPriority );
+	
   // post the initial transition event
   ThisEvent.EventType = ES_INIT;
-  if (ES_PostToService( MyPriority, ThisEvent) == true)
+  if (ES_QueueStatsPost( MyPriority, ThisEvent) == true)
   {
       return true;
   }else
@@ -219,7 +319,7 @@ bool InitLEDService ( uint8_t Priority )
 ****************************************************************************/
 bool PostLEDService( ES_Event ThisEvent )
 {
-  return ES_PostToService( MyPriority, ThisEvent);
+  return ES_QueueStatsPost( MyPriority, ThisEvent);
 }
 
 /****************************************************************************
@@ -229,276 +329,68 @@ bool PostLEDService( ES_Event ThisEvent )
  Parameters
    ES_Event : the event to process
 
+ Returns
+   ES_Event, whatever HandleLEDEvent returns
+
+ Description
+   Runs ThisEvent through HandleLEDEvent by way of ES_QueueStatsRun
+****************************************************************************/
+ES_Event RunLEDService( ES_Event ThisEvent )
+{
+	return ES_QueueStatsRun( MyPriority, ThisEvent, HandleLEDEvent, QueryState );
+}
+
+/****************************************************************************
+ Function
+    HandleLEDEvent
+
+ Parameters
+   ES_Event : the event to process
+
  Returns
    ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
 
  Description
-   add your description here
+   Runs the event through the LED state table
  Notes
-   uses nested switch/case to implement the machine.
+   ES_RESET is handled by the LEDRunning superstate for every state after
+   Init.
  Author
    Drew Bell, 11/16/16, 15:23
 ****************************************************************************/
-ES_Event RunLEDService( ES_Event ThisEvent )
+static ES_Event HandleLEDEvent( ES_Event ThisEvent )
 {
   ES_Event ReturnEvent;
-	//Set NextState to CurrentState
-	LEDState_t NextState = CurrentState;
-	
-	
   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
 
-  switch ( CurrentState )
-  {
-    case InitLEDState :       // If current state is initial Psedudo State
-			if ( ThisEvent.EventType == ES_INIT ) {
-				//set all LEDS to be off OFF
-				PWM8_TIVA_SetDuty( MIN_PWM_DUTY, PWM_Flip1LED_CHAN );
-				PWM8_TIVA_SetDuty( MIN_PWM_DUTY, PWM_Flip2LED_CHAN );
-				PWM8_TIVA_SetDuty( MIN_PWM_DUTY, PWM_Flip3LED_CHAN );
-				PWM8_TIVA_SetDuty( MIN_PWM_DUTY, PWM_WATER_LED_CHAN);
-				HWREG(GPIO_PORTD_BASE+(GPIO_O_DATA + ALL_BITS)) &= ~SEED_LED_ON;
-						
-				//set Ramp LED values back to zero
-				F1LED_Brightness = 0;				//flipbook 1 LED brightness
-				F2LED_Brightness = 0;				//flipbook 2 LED brightness
-				F3LED_Brightness = 0;				//flipbook 3 LED brightness
-				WaterLED_Brightness = 0;			//water LED brightness
-				
-				//Blink all LEDs in Wait for seed / Welcome Mode
-				BlinkSeedLEDS(true);
-			
-				// now put the machine into the actual initial state
-				NextState = Waiting4Seed;
-				#if DEBUG_LED
-				printf("LS: InitLEDState Done.\n\r\n");
-				#endif
-      }
-				
-      break;
-
-    case Waiting4Seed :       // This is the welcoming state
-			//if ThisEvent is a timeout caused by BlinkSeedLEDS
-			if ( (ThisEvent.EventType == ES_TIMEOUT) && (ThisEvent.EventParam == BlinkSeedLEDS_TIMER) ) {
-				//call blink seed again and pass true to keep blinking
-				BlinkSeedLEDS(true);
-				#if DEBUG_LED
-				printf("LS: Blink Seed LEDS | Waiting for Seed.\n\r\n");
-				#endif
-			}			
-			//if ES_SEED_DETECTED
-			else if ( ThisEvent.EventType == ES_SEED_DETECTED ) {
-				//stop seed LED blink 
-				BlinkSeedLEDS(false);
-				//start RampF1LEDS and transition to F1Run State
-				RampF1LEDS();
-				NextState = F1Run;
-				#if DEBUG_LED
-				printf("LS: Move to F1Run | Waiting4Seed.\n\r\n");
-				#endif
-			}
-			//if ES_RESET
-			else if ( ThisEvent.EventType == ES_RESET ) {
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Return to InitLEDState
-				NextState = InitLEDState;				
-			}
-			break;
-	  
-	 case F1Run : 
-			//if the timer ran out and event is from RampF1LEDS
-			if ((ThisEvent.EventType == ES_TIMEOUT) && (ThisEvent.EventParam == RampF1LEDS_TIMER)) {
-				//keep ramping
-				RampF1LEDS();
-				#if DEBUG_LED
-				printf("LS: Ramping LEDs | F1 Run.\n\r\n");
-				#endif
-			}
-			//if ES_F1_DONE
-			else if ( ThisEvent.EventType == ES_F1_DONE ) {
-				// make sure F1 LEDs are set to their full brightness
-				F1SetFullBrightness();
-				//start blinking of water leds
-				BlinkWaterLEDS(true);
-				//change to wait for water state
-				NextState = Wait4Watering;
-				#if DEBUG_LED
-				printf("LS: ES_F1_DONE - Moving to Watering | F1Run.\n\r\n");
-				#endif
-			}	
-			//else if ES_RESET
-			else if ( ThisEvent.EventType == ES_RESET ) {
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Return to InitLEDState
-				NextState = InitLEDState;
-			}
-			break;
-			
-	case Wait4Watering : 	//for now, blink the whole time for water
-			//if event is blink water LEDS, keep blinking
-			if ( (ThisEvent.EventType == ES_TIMEOUT) && (ThisEvent.EventParam == BlinkWaterLEDS_TIMER) ) {
-				//keep blinking water LEDs by calling and passing true
-				BlinkWaterLEDS(true);
-				#if DEBUG_LED
-				printf("LS: Timeout - Blink Water LEDs | Waiting4Watering.\n\r\n");
-				#endif
-			}
-			
-			//if ES_WATER, go to F2 Run
-			else if ( ThisEvent.EventType == ES_WATER ) {
-				if ( ThisEvent.EventParam <= MIN_TILT_CHANGE ) {
-					//stop blinking the water LED
-					BlinkWaterLEDS(false);
-					//Start ramping F2 LEDs
-					RampF2LEDS();
-					//move to F2Run state
-					NextState = F2Run;
-					#if DEBUG_LED
-					printf("LS: ES_WATER - Move to F2Run | Waiting4Seed.\n\r\n");
-					#endif
-				}
-			}
-			
-			else if ( ThisEvent.EventType == ES_RESET ) {
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Return to InitLEDState
-				NextState = InitLEDState;
-			}
-			break;
-	  
-	case F2Run : 
-			//if the timer ran out and event is from RampF2LEDS
-			if ( (ThisEvent.EventType == ES_TIMEOUT) && (ThisEvent.EventParam == RampF2LEDS_TIMER) ) {
-				//keep ramping
-				RampF2LEDS();
-				#if DEBUG_LED
-				printf("LS: Timeout - Ramp F2 LEDs | F2Run.\n\r\n");
-				#endif
-			}
-			else if ( ThisEvent.EventType == ES_WATER ) {
-				// if there is enough tilt
-				if ( ThisEvent.EventParam <= MIN_TILT_CHANGE ) {
-					// stop blinking the LEDS
-					BlinkWaterLEDS(false);
-					// calculate the water brightness based on the acc value
-					uint16_t WaterPulse = ((MAX_SAFE_PWM_DUTY*(ThisEvent.EventParam - MIN_ACC))/(MAX_ACC-MIN_ACC));
-					// start ramping water leds
-					RampWaterLEDS( WaterPulse );
-				} else { // else if it's not enough tilt
-					// start blinking again
-					BlinkWaterLEDS(true);
-				}
-			}
-			// if it's a timeout for blinking the water LEDs, continue blinking
-			else if ((ThisEvent.EventType == ES_TIMEOUT) && (ThisEvent.EventParam == BlinkWaterLEDS_TIMER)){
-				//keep blinking water LEDs by calling and passing true
-				BlinkWaterLEDS(true);
-				#if DEBUG_LED
-				printf("LS: Timeout - Blink Water LEDs | F2Run.\n\r\n");
-				#endif
-			}
-			//if ES_F2_DONE move to F3Run
-			else if(ThisEvent.EventType == ES_F2_DONE){
-				// make sure F2 LEDs are set to their full brightness
-				F2SetFullBrightness();
-				// turn off the water LEDs
-				BlinkWaterLEDS(false);
-//				//Start ramping F3 LEDS
-//				RampF3LEDS();
-				//Change to F3 state
-				NextState = F3Run;
-				#if DEBUG_LED
-				printf("LS: ES_F2_DONE - Moving to F3Run | F2Run.\n\r\n");
-				#endif
-			}	
-			// else if it's a reset event
-			else if(ThisEvent.EventType == ES_RESET){
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Return to InitLEDState
-				NextState = InitLEDState;
-			}
-			break; 
-			
-	 case F3Run : 
-			if ( ThisEvent.EventType == ES_DONE_HARVEST )  {
-				//Start ramping F3 LEDS
-				RampF3LEDS();
-			}
-			//if the timer ran out and event is from RampF3LEDS
-			else if((ThisEvent.EventType == ES_TIMEOUT) && (ThisEvent.EventParam == RampF3LEDS_TIMER)){
-				//keep ramping
-				RampF3LEDS();
-				#if DEBUG_LED
-				printf("LS: Timeout - Ramp F3 LEDs | F3Run.\n\r\n");
-				#endif
-			}
-			//if ES_F3_DONE, go to celebrate
-			else if(ThisEvent.EventType == ES_F3_DONE){
-				// make sure F3 LEDs are set to their full brightness
-				F3SetFullBrightness();
-				// set next state to celebration
-				NextState = Celebration;
-				//blink all LEDs to celebrate
-				BlinkAllLEDS(true);
-				#if DEBUG_LED
-				printf("LS: ES_F3_DONE - Moving to Celebration | F3Run.\n\r\n");
-				#endif
-			}
-			//if event is a reset, reset 
-			else if(ThisEvent.EventType == ES_RESET){
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Return to InitLEDState
-				NextState = InitLEDState;
-			}
-			break;
-			
-		//No case for harvest. Leave harvest LEDs in airservice
-	
-	case Celebration : 
-			// if timeout to keep blinkinh,
-			if((ThisEvent.EventType == ES_TIMEOUT) && ThisEvent.EventParam == BlinkAllLEDS_TIMER){
-				//call blink all again and pass true to keep blinking
-				BlinkAllLEDS(true);
-				#if DEBUG_LED
-				printf("LS: Timeout - Blinking all LEDs | Celebration.\n\r\n");
-				#endif
-			}		
-			//if event is a reset, reset 
-			else if(ThisEvent.EventType == ES_RESET){
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Return to InitLEDState
-				NextState = InitLEDState;
-			}
-			break;
-
-	  
-    // repeat state pattern as required for other states
-    default :
-      ;
-  }      // end switch on Current State
-  
-  CurrentState = NextState;
+	//ES_WATER comes through the water mailbox, swap in the latest sample
+	if ( ThisEvent.EventType == ES_WATER ) {
+		ThisEvent = ES_MailboxFetch( WATER_MAILBOX, MyPriority );
+	}
+	//Broadcasts (ES_RESET, ES_CELEBRATION) come through the broadcast ring,
+	//swap in the next one
+	if ( ThisEvent.EventType == ES_BROADCAST ) {
+		ThisEvent = ES_BroadcastFetch( MyPriority );
+	}
+
+	//Look the event up in the state table, it runs the action and gives us
+	//the next state
+	CurrentState = (LEDState_t)ES_FSM_Dispatch( &LEDMachine, CurrentState, ThisEvent );
   return ReturnEvent;
 }
 
+/****************************************************************************
+ Function
+     QueryState
+
+ Returns
+     uint8_t, the current state, for the trace kept by ES_QueueStatsRun
+****************************************************************************/
+static uint8_t QueryState ( void )
+{
+	return CurrentState;
+}
+
 /****************************************************************************
  Function
      QueryLEDService
@@ -527,57 +419,47 @@ LEDState_t QueryLEDService ( void )
 
 /****************************************************************************
  Function
-    RampF1LEDS
+    WriteLEDLevel
 
  Parameters
-   none
+   uint8_t Channel : LED_F1 to LED_SEED
+   uint8_t Level : ANIM_LEVEL_OFF to ANIM_LEVEL_FULL
 
  Returns
    none
 
  Description
-  Ramps the duty cycle of Flipbook 1 LEDs from 0 to full brightness over time with non-blocking code
+  The animator's output, sets a channel's LEDs to a level. It is called
+  from the animator's timer interrupt, nothing else writes these LEDs.
+  The PWM channels are only staged, FlushLEDLevels sends them.
 
  Notes
- 	(1) F1LED_Brightness is a module-level variable that is reset to 0 by the RESET state
-	(2) The maximum suggested duty cycle is 85. With a 13.8V supply, this correlates to an effective voltage of 12V, the rating for the LED strips
-	(3) Duty cycle controls brightness, so the terms are used interchangably in this module
-	 
- Author
-   Drew Bell, 11/20/16, 15:23
+	(1) The levels are perceptually even, LEDGamma turns them into a pulse width in 0.8uS ticks (1250 a period), much finer than the 0 to 99 duty
+	(2) Full is MAX_SAFE_PWM_DUTY. With a 13.8V supply, this keeps the effective voltage at or below 12V, the rating for the LED strips
+	(3) The seed LED is on a plain GPIO line, it is on for any level above off
 ****************************************************************************/
-
-static void RampF1LEDS( void ) {
-// module level variable F1LED_Brightness is intialized to zero at compile, listed at top of module in defines
-	static uint8_t Inc = 4;			//increments this many per step
-	static uint8_t FullBrightness = MAX_SAFE_PWM_DUTY;	//sets the max brightness for the ramp
-
-	//duty cycle controls brightness, so brightness and duty cycle are interchangable
-	//will use brightness of clarity
-	//if brightness for this LED + inc is less than or equal to the desired brightness, then add inc to LED brightness
-	if( (F1LED_Brightness + Inc) < FullBrightness){
-		F1LED_Brightness = F1LED_Brightness + Inc;
+static void WriteLEDLevel( uint8_t Channel, uint8_t Level ) {
+	if( Channel == LED_SEED ){
+		if( Level != ANIM_LEVEL_OFF ){
+			HWREG(GPIO_PORTD_BASE+(GPIO_O_DATA + ALL_BITS)) |= SEED_LED_ON;
+		}
+		else{
+			HWREG(GPIO_PORTD_BASE+(GPIO_O_DATA + ALL_BITS)) &= ~SEED_LED_ON;
+		}
 	}
-	//else if LED brightness + inc is more than desired brightness, 
-	else if( (F1LED_Brightness + Inc) >= FullBrightness){
-		//set brightness = bmax
-		F1LED_Brightness = MAX_SAFE_PWM_DUTY;
+	else if( Level == ANIM_LEVEL_OFF ){
+		PWMBatch_SetDuty( &LEDBatch, MIN_PWM_DUTY, LEDPWMChannels[Channel] );
 	}
-	
-	//set duty to Brightness
-	PWM8_TIVA_SetDuty( F1LED_Brightness, PWM_Flip1LED_CHAN );
-	
-	//if LEDs need to have not reached the full brightness, set timer to wait before posting to LEDService to trigger another increment
-	if( F1LED_Brightness < FullBrightness){
-		ES_Timer_InitTimer(RampF1LEDS_TIMER, HALF_SEC);
+	else{
+		//pulse width controls brightness, look up the gamma corrected width
+		PWMBatch_SetPulseWidth( &LEDBatch, LEDGamma[Level], LEDPWMChannels[Channel] );
 	}
-
-  	return;	
+	return;
 }
 
 /****************************************************************************
  Function
-    F1SetFullBrightness
+    FlushLEDLevels
 
  Parameters
    none
@@ -586,20 +468,18 @@ static void RampF1LEDS( void ) {
    none
 
  Description
-  Sets flipbook1 LEDs to their max safe brightness
-
- Author
-   A. Siu, 11/27/16, 9:26
-****************************************************************************/	
-static void F1SetFullBrightness( void ) {
-	//set duty to full Brightness
-	PWM8_TIVA_SetDuty( MAX_SAFE_PWM_DUTY, PWM_Flip1LED_CHAN );
+  The animator's flush, at the end of a tick. Commits the tick's LED writes
+  so every LED that changed (a blink on all four, say) changes at the same
+  PWM period boundary, and any that did not really change are skipped.
+****************************************************************************/
+static void FlushLEDLevels( void ) {
+	PWMBatch_Commit( &LEDBatch );
 	return;
 }
-	
+
 /****************************************************************************
  Function
-    RampF2LEDS
+    BlinkAllLEDS
 
  Parameters
    none
@@ -608,391 +488,232 @@ static void F1SetFullBrightness( void ) {
    none
 
  Description
-  Ramps the duty cycle of Flipbook 2 LEDs from 0 to full brightness over time with non-blocking code
+	Starts every LED blinking together for the celebration
+****************************************************************************/
+static void BlinkAllLEDS( void ) {
+	uint8_t Channel;
 
- Notes
- 	(1) F2LED_Brightness is a module-level variable that is reset to 0 by the RESET state
-	(2) The maximum suggested duty cycle is 85. With a 13.8V supply, this correlates to an effective voltage of 12V, the rating for the LED strips
-	(3) Duty cycle controls brightness, so the terms are used interchangably in this module
-	 
- Author
-   Drew Bell, 11/20/16, 15:23
-****************************************************************************/			
-static void RampF2LEDS( void ) {
-// module level variable F2LED_Brightness is intialized to zero at compile, listed at top of module in defines
-	static uint8_t Inc = 4;			//increments this many per step
-	static uint8_t FullBrightness = MAX_SAFE_PWM_DUTY;	//sets the max brightness for the ramp
-
-	//duty cycle controls brightness, so brightness and duty cycle are interchangable
-	//will use brightness of clarity
-	//if brightness for this LED + inc is less than or equal to the desired brightness, then add inc to LED brightness
-	if( (F2LED_Brightness + Inc) < FullBrightness){
-		F2LED_Brightness = F2LED_Brightness + Inc;
-	}
-	//else if LED brightness + inc is more than desired brightness, 
-	else if( (F2LED_Brightness + Inc) >= FullBrightness){
-		//set brightness = bmax
-		F2LED_Brightness = MAX_SAFE_PWM_DUTY;
+	//starting them all in the same pass keeps them in step
+	for( Channel = 0; Channel < NUM_LED_CHANNELS; Channel++ ){
+		LEDAnim_Play( Channel, &FastBlinkClip );
 	}
-	
-	//set duty to Brightness
-	PWM8_TIVA_SetDuty( F2LED_Brightness, PWM_Flip2LED_CHAN );
-	
-	//if LEDs need to have not reached the full brightness, set timer to wait before posting to LEDService to trigger another increment
-		if( F2LED_Brightness < FullBrightness){
-		ES_Timer_InitTimer(RampF2LEDS_TIMER, HALF_SEC);
-	}
-
-  	return;	
+	return;
 }
 
 /****************************************************************************
  Function
-    F2SetFullBrightness
-
- Parameters
-   none
-
- Returns
-   none
+    StartLEDs
 
  Description
-  Sets flipbook2 LEDs to their max safe brightness
-
- Author
-   A. Siu, 11/27/16, 9:26
-****************************************************************************/		
-static void F2SetFullBrightness( void ) {
-	//set duty to full Brightness
-	PWM8_TIVA_SetDuty( MAX_SAFE_PWM_DUTY, PWM_Flip2LED_CHAN );
+  InitLEDState on ES_INIT: turns all the LEDs off, stops any clips left
+  from before a reset and starts blinking the seed LED for the welcome mode
+****************************************************************************/
+static void StartLEDs( ES_Event ThisEvent ) {
+	//set all LEDS to be off OFF, and stop anything left playing
+	LEDAnim_StopAll( ANIM_LEVEL_OFF );
+	//Blink the seed LED in Wait for seed / Welcome Mode
+	LEDAnim_Play( LED_SEED, &SlowBlinkClip );
+	#if DEBUG_LED
+	printf("LS: InitLEDState Done.\n\r\n");
+	#endif
 	return;
 }
-			
+
 /****************************************************************************
  Function
-    RampF3LEDS
-
- Parameters
-   none
-
- Returns
-   none
+    StartF1
 
  Description
-  Ramps the duty cycle of Flipbook 3 LEDs from 0 to full brightness over time with non-blocking code
-
- Notes
- 	(1) F3LED_Brightness is a module-level variable that is reset to 0 by the RESET state
-	(2) The maximum suggested duty cycle is 85. With a 13.8V supply, this correlates to an effective voltage of 12V, the rating for the LED strips
-	(3) Duty cycle controls brightness, so the terms are used interchangably in this module
-	 
- Author
-   Drew Bell, 11/20/16, 15:23
-****************************************************************************/			
-static void RampF3LEDS( void ) {
-// module level variable F3LED_Brightness is intialized to zero at compile, listed at top of module in defines
-	static uint8_t Inc = 4;			//increments this many per step
-	static uint8_t FullBrightness = MAX_SAFE_PWM_DUTY;	//sets the max brightness for the ramp
-
-	//duty cycle controls brightness, so brightness and duty cycle are interchangable
-	//will use brightness of clarity
-	//if brightness for this LED + inc is less than or equal to the desired brightness, then add inc to LED brightness
-	if( (F3LED_Brightness + Inc) < FullBrightness){
-		F3LED_Brightness = F3LED_Brightness + Inc;
-	}
-	//else if LED brightness + inc is more than desired brightness, 
-	else if( (F3LED_Brightness + Inc) >= FullBrightness){
-		//set brightness = bmax
-		F3LED_Brightness = MAX_SAFE_PWM_DUTY;
-	}
-	
-	//set duty to Brightness
-	PWM8_TIVA_SetDuty( F3LED_Brightness, PWM_Flip3LED_CHAN );
-	
-	//if LEDs need to have not reached the full brightness, set timer to wait before posting to LEDService to trigger another increment
-		if( F3LED_Brightness < FullBrightness){
-		ES_Timer_InitTimer(RampF3LEDS_TIMER, HALF_SEC);
-	}
-
-  	return;	
+  Waiting4Seed on ES_SEED_DETECTED: stops the seed blink and starts ramping
+  the F1 LEDs
+****************************************************************************/
+static void StartF1( ES_Event ThisEvent ) {
+	//stop seed LED blink 
+	LEDAnim_Set( LED_SEED, ANIM_LEVEL_OFF );
+	//start ramping the F1 LEDs
+	LEDAnim_Play( LED_F1, &RampClip );
+	#if DEBUG_LED
+	printf("LS: Move to F1Run | Waiting4Seed.\n\r\n");
+	#endif
+	return;
 }
 
 /****************************************************************************
  Function
-    F3SetFullBrightness
-
- Parameters
-   none
-
- Returns
-   none
+    FinishF1
 
  Description
-  Sets flipbook3 LEDs to their max safe brightness
-
- Author
-   A. Siu, 11/27/16, 9:26
-****************************************************************************/			
-static void F3SetFullBrightness( void ) {
-	//set duty to full Brightness
-	PWM8_TIVA_SetDuty( MAX_SAFE_PWM_DUTY, PWM_Flip3LED_CHAN );
+  F1Run on ES_F1_DONE: F1 LEDs to full and starts blinking the water LEDs
+****************************************************************************/
+static void FinishF1( ES_Event ThisEvent ) {
+	// make sure F1 LEDs are set to their full brightness
+	LEDAnim_Set( LED_F1, ANIM_LEVEL_FULL );
+	//start blinking of water leds
+	LEDAnim_Play( LED_WATER, &SlowBlinkClip );
+	#if DEBUG_LED
+	printf("LS: ES_F1_DONE - Moving to Watering | F1Run.\n\r\n");
+	#endif
 	return;
 }
-		
+
 /****************************************************************************
  Function
-    RampWaterLEDS
-
- Parameters
-   none
+    IsPouring
 
  Returns
-   none
-
- Description
-  Ramps the duty cycle of Water LEDs from 0 to full brightness over time with non-blocking code
-
- Notes
- 	(1) WaterLED_Brightness is a module-level variable that is reset to 0 by the RESET state
-	(2) The maximum suggested duty cycle is 85. With a 13.8V supply, this correlates to an effective voltage of 12V, the rating for the LED strips
-	(3) Duty cycle controls brightness, so the terms are used interchangably in this module
-	 
- Author
-   Drew Bell, 11/20/16, 15:23
-****************************************************************************/			
-static void RampWaterLEDS( uint8_t Inc ) {
-	
-	static uint8_t FullBrightness = MAX_SAFE_PWM_DUTY;	//sets the max brightness for the ramp
-
-	//duty cycle controls brightness, so brightness and duty cycle are interchangable
-	//will use brightness of clarity
-	//if brightness for this LED + inc is less than or equal to the desired brightness, then add inc to LED brightness
-	if( (WaterLED_Brightness + Inc) < FullBrightness){
-		WaterLED_Brightness = WaterLED_Brightness + Inc;
-	}
-	//else if LED brightness + inc is more than desired brightness, 
-	else if( (WaterLED_Brightness + Inc) >= FullBrightness){
-		//set brightness = bmax
-		WaterLED_Brightness = MAX_SAFE_PWM_DUTY;
-	}
-	
-	//set duty to Brightness
-	PWM8_TIVA_SetDuty( WaterLED_Brightness, PWM_WATER_LED_CHAN );
+  true between ES_TILT_ENTER and ES_TILT_EXIT
+****************************************************************************/
+static bool IsPouring( ES_Event ThisEvent ) {
+	return Pouring;
+}
 
-  	return;	
-	
-	/*
-	// module level variable WaterLED_Brightness is intialized to zero at compile, listed at top of module in defines
-	static uint8_t Inc = 4;			//increments this many per step
-	static uint8_t FullBrightness = MAX_SAFE_PWM_DUTY;	//sets the max brightness for the ramp
-
-	//duty cycle controls brightness, so brightness and duty cycle are interchangable
-	//will use brightness of clarity
-	//if brightness for this LED + inc is less than or equal to the desired brightness, then add inc to LED brightness
-	if( (WaterLED_Brightness + Inc) < FullBrightness){
-		WaterLED_Brightness = WaterLED_Brightness + Inc;
-	}
-	//else if LED brightness + inc is more than desired brightness, 
-	else if( (WaterLED_Brightness + Inc) >= FullBrightness){
-		//set brightness = bmax
-		WaterLED_Brightness = MAX_SAFE_PWM_DUTY;
-	}
-	
-	//set duty to Brightness
-	PWM8_TIVA_SetDuty( WaterLED_Brightness, PWM_WATER_LED_CHAN );
-	
-	//if LEDs need to have not reached the full brightness, set timer to wait before posting to LEDService to trigger another increment
-		if( WaterLED_Brightness < FullBrightness){
-		ES_Timer_InitTimer(RampWaterLEDS_TIMER, HALF_SEC);
-	}
+/****************************************************************************
+ Function
+    StartF2
 
-  	return;	
-		*/
-		
+ Description
+  Wait4Watering on ES_TILT_ENTER: stops the water blink and starts ramping
+  the F2 LEDs
+****************************************************************************/
+static void StartF2( ES_Event ThisEvent ) {
+	Pouring = true;
+	//stop blinking the water LED
+	LEDAnim_Set( LED_WATER, ANIM_LEVEL_OFF );
+	//Start ramping F2 LEDs
+	LEDAnim_Play( LED_F2, &RampClip );
+	#if DEBUG_LED
+	printf("LS: ES_TILT_ENTER - Move to F2Run | Wait4Watering.\n\r\n");
+	#endif
+	return;
 }
-	
+
 /****************************************************************************
  Function
-    BlinkAllLEDS
+    StartPouring
 
- Parameters
-   bool indicating start or stop blink
+ Description
+  F2Run on ES_TILT_ENTER: stops the water blink, ES_WATER lights the water
+  LEDs from now on
+****************************************************************************/
+static void StartPouring( ES_Event ThisEvent ) {
+	Pouring = true;
+	// stop blinking the LEDS
+	LEDAnim_Set( LED_WATER, ANIM_LEVEL_OFF );
+	return;
+}
 
- Returns
-   none
+/****************************************************************************
+ Function
+    StopPouring
 
  Description
-	This function makes all LEDs blink until a stop signal is given
-
- Notes
- 	(1) passing a boolean true to the function starts blinking, which toggles between an upper duty and lower duty
-	(2) the time given to the timer specifies half period of each blink cycle
-	(3) passing a boolean false stops the blinking and sets LEDs in the off state
-	(4) IMPORTANT - A STOP COMMAND MUST BE GIVEN TO STOP THE BLINKING, I.E. CHANGING FROM A BLINKING STATE TO A STEADY LED STATE.
-									OTHERWISE, BLINKING WILL CONTINUE. 
-									This design was chosen to increase flexibility. It can be changed to a state-based system or layered with a state checker, if desired.
- Author
-   Drew Bell, 11/20/16, 15:23
-****************************************************************************/			
-static void BlinkAllLEDS (bool command) {
-	
-	static bool BlinkState = 0;	//declare a static boolean variable BlinkState to determine on/off, start with false
-		
-	//if command is true, continue with blink
-	if (command == true){
-		//if BlinkState is false
-		if(BlinkState == 0){
-			//set PWM duty to high duty 
-			PWM8_TIVA_SetDuty( MAX_SAFE_PWM_DUTY, PWM_Flip1LED_CHAN );
-			PWM8_TIVA_SetDuty( MAX_SAFE_PWM_DUTY, PWM_Flip2LED_CHAN );
-			PWM8_TIVA_SetDuty( MAX_SAFE_PWM_DUTY, PWM_Flip3LED_CHAN );
-			PWM8_TIVA_SetDuty( MAX_SAFE_PWM_DUTY, PWM_WATER_LED_CHAN);
-			HWREG(GPIO_PORTD_BASE+(GPIO_O_DATA + ALL_BITS)) |= SEED_LED_ON;
-			//set BlinkStatePWM to 1 (true)-> LEDS have been turned on
-			BlinkState = 1;
-		}
-		//else if BlinkStatePWM is equal to true
-		else if (BlinkState == 1){
-			//set PWM duty to low duty
-			PWM8_TIVA_SetDuty( MIN_PWM_DUTY, PWM_Flip1LED_CHAN );
-			PWM8_TIVA_SetDuty( MIN_PWM_DUTY, PWM_Flip2LED_CHAN );
-			PWM8_TIVA_SetDuty( MIN_PWM_DUTY, PWM_Flip3LED_CHAN );
-			PWM8_TIVA_SetDuty( MIN_PWM_DUTY, PWM_WATER_LED_CHAN);
-			HWREG(GPIO_PORTD_BASE+(GPIO_O_DATA + ALL_BITS)) &= ~SEED_LED_ON;
-			//set BlinkStatePWM to 0 (false)-> LEDS have been turned off
-			BlinkState = 0;
-		//end if
-		}
-		//set timer to wait a half second before posting to LEDService
-		ES_Timer_InitTimer(BlinkAllLEDS_TIMER, HALF_SEC);
-	}
-	//else if command is false meaning the blinking should shop
-	else if(command == false){
-		//set LEDs low and return
-		PWM8_TIVA_SetDuty( 0, PWM_Flip1LED_CHAN );
-		PWM8_TIVA_SetDuty( 0, PWM_Flip2LED_CHAN );
-		PWM8_TIVA_SetDuty( 0, PWM_Flip3LED_CHAN );
-		PWM8_TIVA_SetDuty( 0, PWM_WATER_LED_CHAN);
-		HWREG(GPIO_PORTD_BASE+(GPIO_O_DATA + ALL_BITS)) &= ~SEED_LED_ON;
-	}
-					
+  F2Run on ES_TILT_EXIT: blinks the water LEDs again
+****************************************************************************/
+static void StopPouring( ES_Event ThisEvent ) {
+	Pouring = false;
+	// start blinking again
+	LEDAnim_Play( LED_WATER, &SlowBlinkClip );
 	return;
 }
 
 /****************************************************************************
  Function
-    BlinkWaterLEDS
+    ShowWaterLevel
 
- Parameters
-   bool indicating start or stop blink
+ Description
+  F2Run on ES_WATER while pouring: lights the water LEDs with the tilt
+****************************************************************************/
+static void ShowWaterLevel( ES_Event ThisEvent ) {
+	// the water brightness follows the tilt, gliding between the samples
+	LEDAnim_FadeTo( LED_WATER, (uint8_t)TiltCal_Scale( ThisEvent.EventParam, ANIM_LEVEL_OFF, ANIM_LEVEL_FULL ),
+	                WATER_FADE_TIME );
+	return;
+}
 
- Returns
-   none
+/****************************************************************************
+ Function
+    FinishF2
 
  Description
-	This function makes the water LEDs blink until a stop signal is given
+  F2Run on ES_F2_DONE: F2 LEDs to full and water LEDs off
+****************************************************************************/
+static void FinishF2( ES_Event ThisEvent ) {
+	// make sure F2 LEDs are set to their full brightness
+	LEDAnim_Set( LED_F2, ANIM_LEVEL_FULL );
+	// turn off the water LEDs
+	LEDAnim_Set( LED_WATER, ANIM_LEVEL_OFF );
+	#if DEBUG_LED
+	printf("LS: ES_F2_DONE - Moving to F3Run | F2Run.\n\r\n");
+	#endif
+	return;
+}
 
- Notes
- 	(1) passing a boolean true to the function starts blinking, which toggles between an upper duty and lower duty
-	(2) the time given to the timer specifies half period of each blink cycle
-	(3) passing a boolean false stops the blinking and sets LEDs in the off state
-	(4) IMPORTANT - A STOP COMMAND MUST BE GIVEN TO STOP THE BLINKING, I.E. CHANGING FROM A BLINKING STATE TO A STEADY LED STATE.
-									OTHERWISE, BLINKING WILL CONTINUE. 
-									This design was chosen to increase flexibility. It can be changed to a state-based system or layered with a state checker, if desired.
- Author
-   Drew Bell, 11/20/16, 16:23
-****************************************************************************/		
+/****************************************************************************
+ Function
+    ShowWaveRate
 
-static void BlinkWaterLEDS (bool command) {
+ Description
+  F3Run on ES_WAVE_RATE: while they harvest, the F3 LEDs glow as brightly
+  as the visitor is waving (the event parameter, 0 to WAVE_INTENSITY_MAX).
+  The ramp on ES_DONE_HARVEST carries on from here.
+****************************************************************************/
+static void ShowWaveRate( ES_Event ThisEvent ) {
+	uint8_t Level = (uint8_t)(((uint16_t)ThisEvent.EventParam * ANIM_LEVEL_FULL) / WAVE_INTENSITY_MAX);
 
-	static bool BlinkState = 0;	//declare a static boolean variable BlinkState to determine on/off, start with false
-		
-	//if command is true, continue with blink
-	if (command == true){
-		//if BlinkState is false
-		if(BlinkState == 0){
-			//set PWM duty to high duty 
-			PWM8_TIVA_SetDuty( MAX_SAFE_PWM_DUTY, PWM_WATER_LED_CHAN);
-			//set BlinkStatePWM to 1 (true)-> LEDS have been turned on
-			BlinkState = 1;
-		}
-		//else if BlinkStatePWM is equal to true
-		else if (BlinkState == 1){
-			//set PWM duty to low duty
-			PWM8_TIVA_SetDuty( MIN_PWM_DUTY, PWM_WATER_LED_CHAN);
-			//set BlinkStatePWM to 0 (false)-> LEDS have been turned off
-			BlinkState = 0;
-		//end if
-		}
-		//set timer to wait one second before posting to LEDService
-		ES_Timer_InitTimer(BlinkWaterLEDS_TIMER, BLINK_WATER_TIME);
-	}
-	//else if command is false meaning the blinking should shop
-	else if(command == false){
-		//set LEDs low and return
-		PWM8_TIVA_SetDuty( 0, PWM_WATER_LED_CHAN);
-	}
-					
+	LEDAnim_FadeTo( LED_F3, Level, WAVE_FADE_TIME );
+	#if DEBUG_LED
+	printf("LS: ES_WAVE_RATE - F3 LEDs at %u | F3Run.\n\r\n", Level);
+	#endif
 	return;
 }
 
 /****************************************************************************
  Function
-    BlinkSeedLEDS
+    StartF3
 
- Parameters
-   bool indicating start or stop blink
+ Description
+  F3Run on ES_DONE_HARVEST: starts ramping the F3 LEDs
+****************************************************************************/
+static void StartF3( ES_Event ThisEvent ) {
+	//Start ramping F3 LEDS, from the wave glow
+	LEDAnim_Play( LED_F3, &RampClip );
+	return;
+}
 
- Returns
-   none
+/****************************************************************************
+ Function
+    FinishF3
 
  Description
-	This function makes the seed LEDs blink until a stop signal is given
+  F3Run on ES_F3_DONE: F3 LEDs to full and blinks everything to celebrate
+****************************************************************************/
+static void FinishF3( ES_Event ThisEvent ) {
+	// make sure F3 LEDs are set to their full brightness
+	LEDAnim_Set( LED_F3, ANIM_LEVEL_FULL );
+	//blink all LEDs to celebrate
+	BlinkAllLEDS();
+	#if DEBUG_LED
+	printf("LS: ES_F3_DONE - Moving to Celebration | F3Run.\n\r\n");
+	#endif
+	return;
+}
 
- Notes
- 	(1) passing a boolean true to the function starts blinking, which toggles between an upper duty and lower duty
-	(2) the time given to the timer specifies half period of each blink cycle
-	(3) passing a boolean false stops the blinking and sets LEDs in the off state
-	(4) IMPORTANT - A STOP COMMAND MUST BE GIVEN TO STOP THE BLINKING, I.E. CHANGING FROM A BLINKING STATE TO A STEADY LED STATE.
-									OTHERWISE, BLINKING WILL CONTINUE. 
-									This design was chosen to increase flexibility. It can be changed to a state-based system or layered with a state checker, if desired.
- Author
-   Drew Bell, 11/20/16, 16:23
-****************************************************************************/	
-static void BlinkSeedLEDS(bool command) {
+/****************************************************************************
+ Function
+    ReportReset
 
-	static bool BlinkState = 0;	//declare a static boolean variable BlinkState to determine on/off, start with false
-		
-	//if command is true, continue with blink
-	if (command == true){
-		//if BlinkState is false
-		if(BlinkState == 0){
-			//set pin on
-			HWREG(GPIO_PORTD_BASE+(GPIO_O_DATA + ALL_BITS)) |= SEED_LED_ON;
-			//set BlinkStatePWM to 1 (true) -> LEDS have been turned on
-			BlinkState = 1;
-		}
-		//else if BlinkStatePWM is equal to true
-		else {
-			//set pin low
-			HWREG(GPIO_PORTD_BASE+(GPIO_O_DATA + ALL_BITS)) &= ~SEED_LED_ON;
-			//set BlinkStatePWM to 0 (false)-> LEDS have been turned off
-			BlinkState = 0;
-		//end if
-		}
-		//set timer to wait a half second before posting to LEDService
-		ES_Timer_InitTimer(BlinkSeedLEDS_TIMER, BLINK_SEED_TIME);
-	}
-	//else if command is false meaning the blinking should shop
-	else if(command == false){
-		//set LEDs low and return
-		HWREG(GPIO_PORTD_BASE+(GPIO_O_DATA + ALL_BITS)) &= ~SEED_LED_ON;
-	}
-					
+ Description
+  LEDRunning on ES_RESET: tells MainStoryService the LEDs are reset, the
+  LEDs themselves are cleared by StartLEDs on the way back through Init
+****************************************************************************/
+static void ReportReset( ES_Event ThisEvent ) {
+	ES_Event Event2Post;
+	// post an ES_DONE_INIT to the MainService
+	Event2Post.EventType = ES_DONE_INIT;
+	PostMainService( Event2Post );
 	return;
 }
 
-
 /***************************************************************************
 	Code Parts
 
@@ -22,6 +22,11 @@
 */
 #include "ES_Configure.h"
 #include "ES_Framework.h"
+#include "ES_SoftTimers.h"
+#include "ES_Broadcast.h"
+#include "ES_QueueStats.h"
+#include "ES_Profile.h"
+#include "ES_Trace.h"
 #include "TemplateService.h"
 
 #include "MainStoryService.h"
@@ -39,6 +44,8 @@
 /* prototypes for private functions for this service.They should be functions
    relevant to the behavior of this service
 */
+static ES_Event HandleMainEvent ( ES_Event ThisEvent );
+static uint8_t QueryState ( void );
 
 /*---------------------------- Module Variables ---------------------------*/
 // with the introduction of Gen2, we need a module level Priority variable
@@ -69,9 +76,13 @@ bool InitMainService ( uint8_t Priority )
   ES_Event ThisEvent;
   MyPriority = Priority;
 	CurrentState = InitMain;
+	#if ES_PROFILE
+	// start the cycle counter before any service runs
+	ES_ProfileInit();
+	#endif
   // post the initial transition event
   ThisEvent.EventType = ES_INIT;
-  if (ES_PostToService( MyPriority, ThisEvent) == true)
+  if (ES_QueueStatsPost( MyPriority, ThisEvent) == true)
   {
       return true;
   }else
@@ -99,7 +110,7 @@ bool InitMainService ( uint8_t Priority )
 ****************************************************************************/
 bool PostMainService( ES_Event ThisEvent )
 {
-  return ES_PostToService( MyPriority, ThisEvent);
+  return ES_QueueStatsPost( MyPriority, ThisEvent);
 }
 
 /****************************************************************************
@@ -109,6 +120,24 @@ bool PostMainService( ES_Event ThisEvent )
  Parameters
    ES_Event : the event to process
 
+ Returns
+   ES_Event, whatever HandleMainEvent returns
+
+ Description
+   Runs ThisEvent through HandleMainEvent by way of ES_QueueStatsRun
+****************************************************************************/
+ES_Event RunMainService( ES_Event ThisEvent )
+{
+	return ES_QueueStatsRun( MyPriority, ThisEvent, HandleMainEvent, QueryState );
+}
+
+/****************************************************************************
+ Function
+    HandleMainEvent
+
+ Parameters
+   ES_Event : the event to process
+
  Returns
    ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
 
@@ -119,11 +148,16 @@ bool PostMainService( ES_Event ThisEvent )
  Author
    A. Siu
 ****************************************************************************/
-ES_Event RunMainService( ES_Event ThisEvent )
+static ES_Event HandleMainEvent( ES_Event ThisEvent )
 {
   ES_Event ReturnEvent;
   ReturnEvent.EventType = ES_NO_EVENT; // assume no errors
   MainState_t NextState = CurrentState;
+	//Broadcasts (ES_RESET, ES_CELEBRATION, ES_INIT) come through the
+	//broadcast ring, swap in the next one, we get our own ones too
+	if ( ThisEvent.EventType == ES_BROADCAST ) {
+		ThisEvent = ES_BroadcastFetch( MyPriority );
+	}
   switch ( CurrentState )
   {
 		case InitMain:
@@ -143,13 +177,13 @@ ES_Event RunMainService( ES_Event ThisEvent )
 				#if DEBUG_MAIN
 				printf( "Main: got seed \n\r\n" );
 				#endif
-				ES_Timer_InitTimer( GAME_TIMER, GAME_TIME );
+				ES_SoftTimer_InitTimer( GAME_TIMER, GAME_TIME );
 				NextState = Wait4AllFlips;
 			} else if ( ThisEvent.EventType == ES_RESET ) {
 				// post reset to all services
 				ES_Event Event2Post;
 				Event2Post.EventType = ES_RESET;
-				ES_PostList00( Event2Post );
+				ES_BroadcastPost( RESET_BROADCAST, Event2Post );
 				NextState = Wait4Reset;
 			}
 			break;
@@ -162,9 +196,9 @@ ES_Event RunMainService( ES_Event ThisEvent )
 				// post to all services to celebrate
 				ES_Event Event2Post;
 				Event2Post.EventType = ES_CELEBRATION;
-				ES_PostList01( Event2Post );
+				ES_BroadcastPost( CELEBRATION_BROADCAST, Event2Post );
 				// start the celebration timer
-				ES_Timer_InitTimer( CELEB_TIMER, ONE_SEC*10 );
+				ES_SoftTimer_InitTimer( CELEB_TIMER, ONE_SEC*10 );
 				NextState = Celebrating;
 			}
 			// if game time is up == timeout
@@ -175,7 +209,7 @@ ES_Event RunMainService( ES_Event ThisEvent )
 				// post reset to all services
 				ES_Event Event2Post;
 				Event2Post.EventType = ES_RESET;
-				ES_PostList00( Event2Post );
+				ES_BroadcastPost( RESET_BROADCAST, Event2Post );
 				// set the next state to wait for all services to reset
 				NextState = Wait4Reset;
 			}
@@ -183,7 +217,7 @@ ES_Event RunMainService( ES_Event ThisEvent )
 				// post reset to all services
 				ES_Event Event2Post;
 				Event2Post.EventType = ES_RESET;
-				ES_PostList00( Event2Post );
+				ES_BroadcastPost( RESET_BROADCAST, Event2Post );
 				NextState = Wait4Reset;
 			}
 			break;
@@ -197,14 +231,14 @@ ES_Event RunMainService( ES_Event ThisEvent )
 				// post reset to all services
 				ES_Event Event2Post;
 				Event2Post.EventType = ES_RESET;
-				ES_PostList00( Event2Post );
+				ES_BroadcastPost( RESET_BROADCAST, Event2Post );
 				// set next state to wait for all services to reset
 				NextState = Wait4Reset;
 			} else if ( ThisEvent.EventType == ES_RESET ) {
 				// post reset to all services
 				ES_Event Event2Post;
 				Event2Post.EventType = ES_RESET;
-				ES_PostList00( Event2Post );
+				ES_BroadcastPost( RESET_BROADCAST, Event2Post );
 				NextState = Wait4Reset;
 			}
 			break;
@@ -222,10 +256,23 @@ ES_Event RunMainService( ES_Event ThisEvent )
 					#if DEBUG_MAIN
 					printf( "Main: all services done init\n\r\n" );
 					#endif
+					#if DEBUG_QUEUES
+					// the reset is the busiest time for the queues, show how full they got
+					ES_QueueStatsDump();
+					#endif
+					#if ES_PROFILE
+					// one game's worth of run and checker times, then start over
+					ES_ProfileDump();
+					ES_ProfileClear();
+					#endif
+					#if ES_TRACE
+					// everything that led up to this reset
+					ES_TraceDump();
+					#endif
 					// post an ES_INIT event so all services can re-initialize
 					ES_Event Event2Post;
 					Event2Post.EventType = ES_INIT;
-					ES_PostList00( Event2Post );
+					ES_BroadcastPost( RESET_BROADCAST, Event2Post );
 					// transition to the init state
 					NextState = InitMain;
 				}
@@ -240,6 +287,18 @@ ES_Event RunMainService( ES_Event ThisEvent )
   return ReturnEvent;
 }
 
+/****************************************************************************
+ Function
+     QueryState
+
+ Returns
+     uint8_t, the current state, for the trace kept by ES_QueueStatsRun
+****************************************************************************/
+static uint8_t QueryState ( void )
+{
+	return CurrentState;
+}
+
 /***************************************************************************
  private functions
  ***************************************************************************/
@@ -0,0 +1,298 @@
+/****************************************************************************
+ Module
+   PWMBatch.c
+
+ Description
+   Glitch free PWM updates. A caller stages the duty or pulse width of any
+   number of channels in a PWMBatch_t and commits it, and every channel in
+   it changes at its generator's next period boundary, together, instead
+   of one at a time part way through a period. Writes that would not
+   change a channel are skipped, and the writes made and skipped are
+   counted so that can be checked from the debugger or a keystroke.
+
+ Notes
+   PWMBatch_InitGroups switches a group's generator to globally
+   synchronized updates, so the load, compare and action registers
+   PWM8Tiva writes are held in the generator's buffers until its
+   GLOBALSYNC bit in PWMCTL is set, and then all applied when its counter
+   next reaches zero. Commit makes the library calls for the staged
+   channels and then sets the GLOBALSYNC bits of every group it touched in
+   one write.
+   Once a group is initialized here every write to it has to go through
+   this module, a bare PWM8_TIVA_SetDuty would sit in the buffer until
+   the next commit to that group.
+   Commits to the same group within one period land on the same boundary,
+   so two services answering the same event still change together.
+   InitGroups also restarts the counters of all the groups it is given at
+   once (PWMSYNC), so groups at the same frequency share their boundary.
+   The channel cache and counters are kept per channel and PWMCTL bits
+   are write 1 to set, so the LED timer interrupt and the services can
+   use the module at once as long as each channel has only one writer.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_pwm.h"
+
+#include "BITDEFS.H"
+#include "PWM8Tiva.h"
+#include "PWMBatch.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// the control register of generator (group) n
+#define GEN_CTL( Group ) (PWM_O_0_CTL + (Group)*(PWM_GEN_1_OFFSET - PWM_GEN_0_OFFSET))
+// every register PWM8Tiva writes updates on the global sync
+#define GEN_GLOBAL_SYNC (PWM_X_CTL_LOADUPD | PWM_X_CTL_CMPAUPD | PWM_X_CTL_CMPBUPD | \
+                         PWM_X_CTL_GENAUPD_GS | PWM_X_CTL_GENBUPD_GS)
+
+// what a staged value is
+#define KIND_NONE  0     // nothing written since the group was initialized
+#define KIND_DUTY  1
+#define KIND_PULSE 2
+
+/*---------------------------- Module Functions ---------------------------*/
+static void Stage ( PWMBatch_t *pBatch, uint8_t Kind, uint16_t Value, uint8_t Channel );
+
+/*---------------------------- Module Variables ---------------------------*/
+// what each channel was last set to, so repeats can be skipped
+static uint8_t LastKind[PWM_BATCH_CHANNELS];
+static uint16_t LastValue[PWM_BATCH_CHANNELS];
+// per channel, so each is only changed by the channel's one writer
+static volatile uint32_t NumWrites[PWM_BATCH_CHANNELS];
+static volatile uint32_t NumSkipped[PWM_BATCH_CHANNELS];
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     PWMBatch_InitGroups
+
+ Parameters
+     uint16_t Freq : PWM frequency for the groups, Hz
+     uint8_t Groups : PWM_BATCH_GROUP_BIT of each group to set up
+
+ Description
+     Sets the groups' frequency, switches their generators to globally
+     synchronized updates and restarts their counters together. Call it
+     from a service's Init in place of PWM8_TIVA_SetFreq, after
+     PWM8_TIVA_Init. Calling it again for a group is harmless.
+****************************************************************************/
+void PWMBatch_InitGroups ( uint16_t Freq, uint8_t Groups )
+{
+	uint8_t Group;
+
+	for ( Group = 0; Group < PWM_BATCH_GROUPS; Group++ ) {
+		if ( Groups & PWM_BATCH_GROUP_BIT(Group) ) {
+			PWM8_TIVA_SetFreq( Freq, Group );
+			HWREG(PWM0_BASE+GEN_CTL(Group)) |= GEN_GLOBAL_SYNC;
+			//the library may have rescaled the channels, forget them
+			LastKind[2*Group] = KIND_NONE;
+			LastKind[2*Group+1] = KIND_NONE;
+		}
+	}
+	//apply the new load values and line the periods up
+	HWREG(PWM0_BASE+PWM_O_CTL) = Groups;
+	HWREG(PWM0_BASE+PWM_O_SYNC) = Groups;
+	#if DEBUG_PWM
+	printf("PWMBatch: groups 0x%x at %uHz, global sync\n\r\n", Groups, Freq);
+	#endif
+}
+
+/****************************************************************************
+ Function
+     PWMBatch_Begin
+
+ Parameters
+     PWMBatch_t *pBatch : the batch to empty
+****************************************************************************/
+void PWMBatch_Begin ( PWMBatch_t *pBatch )
+{
+	pBatch->Staged = 0;
+}
+
+/****************************************************************************
+ Function
+     PWMBatch_SetDuty
+
+ Parameters
+     PWMBatch_t *pBatch : the batch
+     uint8_t Duty : 0 to 100, as for PWM8_TIVA_SetDuty
+     uint8_t Channel : 0 to 7
+
+ Description
+     Stages a duty for the channel, replacing anything staged for it.
+****************************************************************************/
+void PWMBatch_SetDuty ( PWMBatch_t *pBatch, uint8_t Duty, uint8_t Channel )
+{
+	Stage( pBatch, KIND_DUTY, Duty, Channel );
+}
+
+/****************************************************************************
+ Function
+     PWMBatch_SetPulseWidth
+
+ Parameters
+     PWMBatch_t *pBatch : the batch
+     uint16_t Pulse : in 0.8uS ticks, as for PWM8_TIVA_SetPulseWidth
+     uint8_t Channel : 0 to 7
+
+ Description
+     Stages a pulse width for the channel, replacing anything staged for it.
+****************************************************************************/
+void PWMBatch_SetPulseWidth ( PWMBatch_t *pBatch, uint16_t Pulse, uint8_t Channel )
+{
+	Stage( pBatch, KIND_PULSE, Pulse, Channel );
+}
+
+/****************************************************************************
+ Function
+     PWMBatch_Commit
+
+ Parameters
+     PWMBatch_t *pBatch : the batch, empty again afterwards
+
+ Returns
+     uint8_t, the number of channels written
+
+ Description
+     Writes every staged channel that would change into the generators'
+     buffers, then asks the groups written for a global sync, so they all
+     change at the next period boundary. Nothing at all is written when
+     every staged channel is already at its value.
+****************************************************************************/
+uint8_t PWMBatch_Commit ( PWMBatch_t *pBatch )
+{
+	uint8_t Channel;
+	uint8_t SyncGroups = 0;
+	uint8_t Written = 0;
+
+	for ( Channel = 0; Channel < PWM_BATCH_CHANNELS; Channel++ ) {
+		if ( (pBatch->Staged & BIT0HI << Channel) == 0 ) {
+			continue;
+		}
+		if ( (pBatch->Kind[Channel] == LastKind[Channel]) &&
+		     (pBatch->Value[Channel] == LastValue[Channel]) ) {
+			NumSkipped[Channel]++;
+			continue;
+		}
+		if ( pBatch->Kind[Channel] == KIND_DUTY ) {
+			PWM8_TIVA_SetDuty( pBatch->Value[Channel], Channel );
+		} else {
+			PWM8_TIVA_SetPulseWidth( pBatch->Value[Channel], Channel );
+		}
+		LastKind[Channel] = pBatch->Kind[Channel];
+		LastValue[Channel] = pBatch->Value[Channel];
+		NumWrites[Channel]++;
+		SyncGroups |= PWM_BATCH_GROUP_BIT(PWM_BATCH_GROUP_OF(Channel));
+		Written++;
+	}
+	pBatch->Staged = 0;
+
+	if ( SyncGroups != 0 ) {
+		//write 1 to set, the bits clear themselves once the update is done
+		HWREG(PWM0_BASE+PWM_O_CTL) = SyncGroups;
+	}
+	return Written;
+}
+
+/****************************************************************************
+ Function
+     PWMBatch_WriteDuty
+
+ Parameters
+     uint8_t Duty : 0 to 100
+     uint8_t Channel : 0 to 7
+
+ Description
+     A batch of one, for a service that only drives one channel.
+****************************************************************************/
+void PWMBatch_WriteDuty ( uint8_t Duty, uint8_t Channel )
+{
+	PWMBatch_t Batch;
+
+	PWMBatch_Begin( &Batch );
+	PWMBatch_SetDuty( &Batch, Duty, Channel );
+	PWMBatch_Commit( &Batch );
+}
+
+/****************************************************************************
+ Function
+     PWMBatch_WritePulseWidth
+
+ Parameters
+     uint16_t Pulse : in 0.8uS ticks
+     uint8_t Channel : 0 to 7
+
+ Description
+     A batch of one, for a service that only drives one channel.
+****************************************************************************/
+void PWMBatch_WritePulseWidth ( uint16_t Pulse, uint8_t Channel )
+{
+	PWMBatch_t Batch;
+
+	PWMBatch_Begin( &Batch );
+	PWMBatch_SetPulseWidth( &Batch, Pulse, Channel );
+	PWMBatch_Commit( &Batch );
+}
+
+/****************************************************************************
+ Function
+     PWMBatch_QueryWrites
+
+ Returns
+     uint32_t, channel writes made since reset, all channels
+****************************************************************************/
+uint32_t PWMBatch_QueryWrites ( void )
+{
+	uint32_t Total = 0;
+	uint8_t Channel;
+
+	for ( Channel = 0; Channel < PWM_BATCH_CHANNELS; Channel++ ) {
+		Total += NumWrites[Channel];
+	}
+	return Total;
+}
+
+/****************************************************************************
+ Function
+     PWMBatch_QuerySkipped
+
+ Returns
+     uint32_t, staged writes skipped because the channel was already at
+     the value, all channels
+****************************************************************************/
+uint32_t PWMBatch_QuerySkipped ( void )
+{
+	uint32_t Total = 0;
+	uint8_t Channel;
+
+	for ( Channel = 0; Channel < PWM_BATCH_CHANNELS; Channel++ ) {
+		Total += NumSkipped[Channel];
+	}
+	return Total;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     Stage
+
+ Description
+     Puts a value for the channel in the batch, ignoring bad channels.
+****************************************************************************/
+static void Stage ( PWMBatch_t *pBatch, uint8_t Kind, uint16_t Value, uint8_t Channel )
+{
+	if ( Channel >= PWM_BATCH_CHANNELS ) {
+		return;
+	}
+	pBatch->Kind[Channel] = Kind;
+	pBatch->Value[Channel] = Value;
+	pBatch->Staged |= BIT0HI << Channel;
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
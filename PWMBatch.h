@@ -0,0 +1,38 @@
+/****************************************************************************
+
+  Header file for PWMBatch (staged PWM channel writes that land together
+  at the next PWM period boundary)
+
+ ****************************************************************************/
+
+#ifndef PWMBatch_H
+#define PWMBatch_H
+
+#include "ES_Types.h"
+
+// the PWM8Tiva channels (0 to 7) and their groups, two channels a group
+#define PWM_BATCH_CHANNELS 8
+#define PWM_BATCH_GROUPS   4
+// the group of a channel, and the bit for a group in a Groups mask
+#define PWM_BATCH_GROUP_OF( Channel ) ((Channel) >> 1)
+#define PWM_BATCH_GROUP_BIT( Group )  (1 << (Group))
+
+// a set of channel writes, owned by whoever stages them (a local is fine)
+typedef struct {
+	uint8_t  Staged;                          // a bit for each channel staged
+	uint8_t  Kind[PWM_BATCH_CHANNELS];        // duty or pulse width
+	uint16_t Value[PWM_BATCH_CHANNELS];
+} PWMBatch_t;
+
+// Public Function Prototypes
+void PWMBatch_InitGroups ( uint16_t Freq, uint8_t Groups );
+void PWMBatch_Begin ( PWMBatch_t *pBatch );
+void PWMBatch_SetDuty ( PWMBatch_t *pBatch, uint8_t Duty, uint8_t Channel );
+void PWMBatch_SetPulseWidth ( PWMBatch_t *pBatch, uint16_t Pulse, uint8_t Channel );
+uint8_t PWMBatch_Commit ( PWMBatch_t *pBatch );
+void PWMBatch_WriteDuty ( uint8_t Duty, uint8_t Channel );
+void PWMBatch_WritePulseWidth ( uint16_t Pulse, uint8_t Channel );
+uint32_t PWMBatch_QueryWrites ( void );
+uint32_t PWMBatch_QuerySkipped ( void );
+
+#endif /* PWMBatch_H */
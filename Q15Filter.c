@@ -0,0 +1,77 @@
+/****************************************************************************
+ Module
+   Q15Filter.c
+
+ Description
+   First order IIR filter in fixed point,
+       y[n] = B0*x[n] + B1*x[n-1] - A1*y[n-1]
+   with the coefficients in Q15. A step is two 32 bit multiply-adds and
+   one 64 bit one, instead of the soft float double math it replaces.
+
+ Notes
+   Samples are integers up to 16 bits (the 12 bit ADC readings), so the
+   input terms always fit in 32 bits. The feedback term multiplies the
+   Q15 output by a Q15 coefficient and is done in 64 bits.
+   The output is rounded down, the same as assigning a positive double to
+   an integer, so with A1 = 0 and B0 = B1 = Q15(0.5) the filter gives
+   exactly (x[n] + x[n-1]) / 2 rounded down.
+   Any -1.0 <= coefficient < 1.0 can be used, the caller has to make sure
+   the filter is stable (|A1| < 1) and that its gain does not overflow the
+   output.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "Q15Filter.h"
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   Q15Filter_Init
+
+ Parameters
+   Q15Filter_t *pFilter : the filter
+   int16_t B0, B1, A1 : the coefficients in Q15 (see Q15())
+   int32_t Initial : the input (and output) the filter starts settled at
+
+ Description
+   Sets the coefficients and fills the history with Initial, so the first
+   outputs are not pulled towards 0
+****************************************************************************/
+void Q15Filter_Init ( Q15Filter_t *pFilter, int16_t B0, int16_t B1, int16_t A1,
+                      int32_t Initial )
+{
+	pFilter->B0 = B0;
+	pFilter->B1 = B1;
+	pFilter->A1 = A1;
+	pFilter->X1 = Initial;
+	pFilter->Y1 = Initial << 15;
+}
+
+/****************************************************************************
+ Function
+   Q15Filter_Step
+
+ Parameters
+   Q15Filter_t *pFilter : the filter
+   int32_t Sample : the new input
+
+ Returns
+   int32_t, the new output, rounded down
+
+ Description
+   Runs one sample through the filter
+****************************************************************************/
+int32_t Q15Filter_Step ( Q15Filter_t *pFilter, int32_t Sample )
+{
+	int32_t Acc;
+
+	Acc = pFilter->B0 * Sample + pFilter->B1 * pFilter->X1;
+	if ( pFilter->A1 != 0 ) {
+		Acc -= (int32_t)( ((int64_t)pFilter->A1 * pFilter->Y1) >> 15 );
+	}
+	pFilter->X1 = Sample;
+	pFilter->Y1 = Acc;
+	return Acc >> 15;
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
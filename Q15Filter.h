@@ -0,0 +1,29 @@
+/****************************************************************************
+
+  Header file for Q15Filter (fixed point first order IIR filter)
+
+ ****************************************************************************/
+
+#ifndef Q15Filter_H
+#define Q15Filter_H
+
+#include "ES_Types.h"
+
+// a coefficient in Q15, for -1.0 <= x < 1.0, only for constant expressions
+#define Q15( x ) ( (int16_t)( (x) * 32768.0 + ((x) < 0 ? -0.5 : 0.5) ) )
+
+// y[n] = B0*x[n] + B1*x[n-1] - A1*y[n-1], coefficients in Q15
+typedef struct {
+	int16_t B0;
+	int16_t B1;
+	int16_t A1;
+	int32_t X1;   // last input
+	int32_t Y1;   // last output in Q15, so the feedback keeps its fraction
+} Q15Filter_t;
+
+// Public Function Prototypes
+void Q15Filter_Init ( Q15Filter_t *pFilter, int16_t B0, int16_t B1, int16_t A1,
+                      int32_t Initial );
+int32_t Q15Filter_Step ( Q15Filter_t *pFilter, int32_t Sample );
+
+#endif /* Q15Filter_H */
@@ -0,0 +1,126 @@
+/****************************************************************************
+ Module
+   SpikeFilter.c
+
+ Description
+   Takes single sample spikes out of a stream of readings: each output is
+   the median of the last SPIKE_WINDOW inputs, and it may not move more
+   than MaxStep from the last output. The median throws away any spike
+   shorter than half the window, the slew limit keeps a longer burst from
+   jumping the output.
+
+ Notes
+   The median comes from a fixed sorting network on a copy of the window
+   (3, 7 or 13 compare-swaps for a window of 3, 5 or 7), so a step always
+   takes the same time and never calls qsort. The networks only sort as
+   far as they need to for the middle element.
+   tools/spike_bench.c times a step on the host for each window size.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "SpikeFilter.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#if (SPIKE_WINDOW != 3) && (SPIKE_WINDOW != 5) && (SPIKE_WINDOW != 7)
+#error SPIKE_WINDOW must be 3, 5 or 7
+#endif
+
+// puts the smaller of a and b in a
+#define SORT2( a, b ) { int32_t Temp = (a); if ( Temp > (b) ) { (a) = (b); (b) = Temp; } }
+
+/*---------------------------- Module Functions ---------------------------*/
+static int32_t Median ( const int32_t *pWindow );
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+   SpikeFilter_Init
+
+ Parameters
+   SpikeFilter_t *pFilter : the filter
+   int32_t MaxStep : the largest change of the output from one sample to
+                     the next
+   int32_t Initial : the input (and output) the filter starts settled at
+****************************************************************************/
+void SpikeFilter_Init ( SpikeFilter_t *pFilter, int32_t MaxStep, int32_t Initial )
+{
+	uint8_t i;
+
+	for ( i = 0; i < SPIKE_WINDOW; i++ ) {
+		pFilter->Window[i] = Initial;
+	}
+	pFilter->Next = 0;
+	pFilter->Last = Initial;
+	pFilter->MaxStep = MaxStep;
+}
+
+/****************************************************************************
+ Function
+   SpikeFilter_Step
+
+ Parameters
+   SpikeFilter_t *pFilter : the filter
+   int32_t Sample : the new input
+
+ Returns
+   int32_t, the new output
+
+ Description
+   Runs one sample through the median and then the slew limit
+****************************************************************************/
+int32_t SpikeFilter_Step ( SpikeFilter_t *pFilter, int32_t Sample )
+{
+	int32_t Output;
+
+	pFilter->Window[pFilter->Next] = Sample;
+	if ( ++pFilter->Next == SPIKE_WINDOW ) {
+		pFilter->Next = 0;
+	}
+	Output = Median( pFilter->Window );
+
+	if ( Output > pFilter->Last + pFilter->MaxStep ) {
+		Output = pFilter->Last + pFilter->MaxStep;
+	} else if ( Output < pFilter->Last - pFilter->MaxStep ) {
+		Output = pFilter->Last - pFilter->MaxStep;
+	}
+	pFilter->Last = Output;
+	return Output;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+   Median
+
+ Description
+   Middle value of the window, by a sorting network on a copy of it
+****************************************************************************/
+static int32_t Median ( const int32_t *pWindow )
+{
+	int32_t p[SPIKE_WINDOW];
+	uint8_t i;
+
+	for ( i = 0; i < SPIKE_WINDOW; i++ ) {
+		p[i] = pWindow[i];
+	}
+#if SPIKE_WINDOW == 3
+	SORT2( p[0], p[1] ); SORT2( p[1], p[2] ); SORT2( p[0], p[1] );
+	return p[1];
+#elif SPIKE_WINDOW == 5
+	SORT2( p[0], p[1] ); SORT2( p[3], p[4] ); SORT2( p[0], p[3] );
+	SORT2( p[1], p[4] ); SORT2( p[1], p[2] ); SORT2( p[2], p[3] );
+	SORT2( p[1], p[2] );
+	return p[2];
+#else
+	SORT2( p[0], p[5] ); SORT2( p[0], p[3] ); SORT2( p[1], p[6] );
+	SORT2( p[2], p[4] ); SORT2( p[0], p[1] ); SORT2( p[3], p[5] );
+	SORT2( p[2], p[6] ); SORT2( p[2], p[3] ); SORT2( p[3], p[6] );
+	SORT2( p[4], p[5] ); SORT2( p[1], p[4] ); SORT2( p[1], p[3] );
+	SORT2( p[3], p[4] );
+	return p[3];
+#endif
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
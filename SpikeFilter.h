@@ -0,0 +1,29 @@
+/****************************************************************************
+
+  Header file for SpikeFilter (streaming median plus slew rate limit)
+
+ ****************************************************************************/
+
+#ifndef SpikeFilter_H
+#define SpikeFilter_H
+
+#include "ES_Types.h"
+
+// samples in the median window, 3, 5 or 7. Override it for the whole
+// project (-DSPIKE_WINDOW=n), every file has to see the same size.
+#ifndef SPIKE_WINDOW
+#define SPIKE_WINDOW 5
+#endif
+
+typedef struct {
+	int32_t Window[SPIKE_WINDOW]; // the last SPIKE_WINDOW inputs
+	uint8_t Next;                 // where the next input goes
+	int32_t Last;                 // last output
+	int32_t MaxStep;              // largest change of the output per sample
+} SpikeFilter_t;
+
+// Public Function Prototypes
+void SpikeFilter_Init ( SpikeFilter_t *pFilter, int32_t MaxStep, int32_t Initial );
+int32_t SpikeFilter_Step ( SpikeFilter_t *pFilter, int32_t Sample );
+
+#endif /* SpikeFilter_H */
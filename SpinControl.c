@@ -0,0 +1,182 @@
+/****************************************************************************
+ Module
+   SpinControl.c
+
+ Description
+   Holds a flipbook's revolution period, and so its frame rate, against
+   wear and a sagging supply. The limit switch closes once a revolution,
+   and the time between two closings is the period. After each revolution
+   a small integer PI controller moves the servo pulse off its open loop
+   value to bring the period back to the target.
+
+ Notes
+   The edge times are the ES_Fn_DONE EventParam, which the switch debounce
+   service stamps with the captured time of the switch's first edge
+   (SwitchCapture), so the debounce delay does not add jitter.
+   The first hit after a start only starts the timing, the flipbook was
+   somewhere in its turn when the motor came on.
+   The pulse is only trimmed by up to SPIN_TRIM_MAX either way, so it
+   stays on the open loop pulse's side of the servo's dead band and a bad
+   target can only do so much. The integral is clamped to the same trim
+   (anti windup).
+   A period shorter than a quarter of the target is a double hit, it
+   restarts the timing and leaves the pulse alone.
+   Each timed revolution is traced (TRACE_SPIN) with the period and the
+   error, for tuning the targets and gains.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_Trace.h"
+
+#include "SpinControl.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+// pulse trim = Error / SPIN_KP_DIV + Integral / SPIN_KI_DIV, in 0.8uS ticks
+// per mS, so 160 mS slow gives 10 ticks at once and 5 more a revolution
+#define SPIN_KP_DIV 16
+#define SPIN_KI_DIV 32
+#define SPIN_INTEGRAL_MAX (SPIN_TRIM_MAX * SPIN_KI_DIV)
+
+/*---------------------------- Module Functions ---------------------------*/
+static int16_t Clamp ( int32_t Value, int16_t Limit );
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     SpinControl_Init
+
+ Parameters
+     SpinControl_t *pSpin : the controller
+     uint8_t Owner : the flipbook service's priority, for the trace
+
+ Description
+     Sets the controller up not holding a rate. Called from the service's
+     Init.
+****************************************************************************/
+void SpinControl_Init ( SpinControl_t *pSpin, uint8_t Owner )
+{
+	pSpin->Owner = Owner;
+	pSpin->Period = 0;
+	pSpin->Error = 0;
+	SpinControl_Stop( pSpin );
+}
+
+/****************************************************************************
+ Function
+     SpinControl_Start
+
+ Parameters
+     SpinControl_t *pSpin : the controller
+     uint16_t BasePulse : the open loop pulse, 0.8uS ticks
+     uint16_t TargetPeriod : the revolution period to hold, ES_Timer ticks
+
+ Returns
+     uint16_t, the pulse to start the motor with (BasePulse)
+
+ Description
+     Starts holding TargetPeriod from the open loop pulse, with the timing
+     and the integral cleared.
+****************************************************************************/
+uint16_t SpinControl_Start ( SpinControl_t *pSpin, uint16_t BasePulse,
+                             uint16_t TargetPeriod )
+{
+	pSpin->TargetPeriod = TargetPeriod;
+	pSpin->BasePulse = BasePulse;
+	pSpin->Pulse = BasePulse;
+	pSpin->Integral = 0;
+	pSpin->EdgeSeen = false;
+	pSpin->NumRevs = 0;
+	return BasePulse;
+}
+
+/****************************************************************************
+ Function
+     SpinControl_Stop
+
+ Parameters
+     SpinControl_t *pSpin : the controller
+
+ Description
+     Stops holding a rate, SpinControl_Revolution ignores hits until the
+     next start. The last period and error are kept for a look afterwards.
+****************************************************************************/
+void SpinControl_Stop ( SpinControl_t *pSpin )
+{
+	pSpin->TargetPeriod = 0;
+	pSpin->EdgeSeen = false;
+}
+
+/****************************************************************************
+ Function
+     SpinControl_Revolution
+
+ Parameters
+     SpinControl_t *pSpin : the controller
+     uint16_t EdgeTime : when the limit switch closed (ES_Fn_DONE EventParam)
+     uint16_t *pPulse : where to put the new pulse
+
+ Returns
+     bool, true if a new pulse was worked out, false if the hit only
+     started the timing or the controller is not holding a rate
+
+ Description
+     Times the revolution that just ended and runs the PI controller on
+     its error.
+****************************************************************************/
+bool SpinControl_Revolution ( SpinControl_t *pSpin, uint16_t EdgeTime,
+                              uint16_t *pPulse )
+{
+	uint16_t Period;
+	int16_t Trim;
+
+	if ( pSpin->TargetPeriod == 0 ) {
+		return false;
+	}
+	//unsigned subtraction copes with the timer wrapping
+	Period = EdgeTime - pSpin->LastEdge;
+	pSpin->LastEdge = EdgeTime;
+	if ( !pSpin->EdgeSeen || (Period < pSpin->TargetPeriod / 4) ) {
+		pSpin->EdgeSeen = true;
+		return false;
+	}
+
+	pSpin->Period = Period;
+	pSpin->Error = Clamp( (int32_t)Period - pSpin->TargetPeriod, INT16_MAX );
+	pSpin->Integral = Clamp( (int32_t)pSpin->Integral + pSpin->Error, SPIN_INTEGRAL_MAX );
+	pSpin->NumRevs++;
+
+	//too slow (positive error) needs a longer pulse
+	Trim = Clamp( pSpin->Error / SPIN_KP_DIV + pSpin->Integral / SPIN_KI_DIV, SPIN_TRIM_MAX );
+	pSpin->Pulse = pSpin->BasePulse + Trim;
+	*pPulse = pSpin->Pulse;
+
+	#if ES_TRACE
+	ES_TraceRecord( TRACE_SPIN, pSpin->Owner, Period, (uint16_t)pSpin->Error );
+	#endif
+	return true;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     Clamp
+
+ Description
+     Value limited to -Limit to Limit.
+****************************************************************************/
+static int16_t Clamp ( int32_t Value, int16_t Limit )
+{
+	if ( Value > Limit ) {
+		return Limit;
+	}
+	if ( Value < -Limit ) {
+		return -Limit;
+	}
+	return (int16_t)Value;
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,39 @@
+/****************************************************************************
+
+  Header file for SpinControl (integer PI control of a flipbook's
+  revolution period, timed by its limit switch)
+
+ ****************************************************************************/
+
+#ifndef SpinControl_H
+#define SpinControl_H
+
+#include "ES_Types.h"
+
+// the most the controller moves the pulse off its open loop value, in
+// 0.8uS PWM ticks (20uS)
+#define SPIN_TRIM_MAX 25
+
+// one flipbook's controller, times are in ES_Timer_GetTime ticks
+typedef struct {
+	uint8_t  Owner;          // the service's priority, for the trace
+	uint16_t TargetPeriod;   // 0 when not holding a rate
+	uint16_t BasePulse;      // the open loop pulse, 0.8uS ticks
+	uint16_t Pulse;          // the pulse now
+	int16_t  Integral;       // summed error
+	uint16_t LastEdge;       // time of the last switch hit
+	bool     EdgeSeen;       // false until the first hit after a start
+	uint16_t Period;         // last full revolution
+	int16_t  Error;          // Period - TargetPeriod, positive is too slow
+	uint16_t NumRevs;        // revolutions timed since the start
+} SpinControl_t;
+
+// Public Function Prototypes
+void SpinControl_Init ( SpinControl_t *pSpin, uint8_t Owner );
+uint16_t SpinControl_Start ( SpinControl_t *pSpin, uint16_t BasePulse,
+                             uint16_t TargetPeriod );
+void SpinControl_Stop ( SpinControl_t *pSpin );
+bool SpinControl_Revolution ( SpinControl_t *pSpin, uint16_t EdgeTime,
+                              uint16_t *pPulse );
+
+#endif /* SpinControl_H */
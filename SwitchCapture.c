@@ -0,0 +1,318 @@
+/****************************************************************************
+ Module
+   SwitchCapture.c
+
+ Description
+   Interrupt driven edge capture for the switches on port B (seed switch
+   on PB0 and the flipbook limit switches on PB1-PB3). The GPIO interrupt
+   latches every edge, with the framework time, into a ring buffer and
+   CheckSwitchEdges works through the entries. For each pin it remembers
+   when the first edge since the last SwitchCapture_TakeEdgeTime happened
+   and, if the pin was added with a post function, posts its Down/Up event.
+
+ Notes
+   SwitchCaptureISR must be installed as the GPIO Port B handler in the
+   vector table of the startup file.
+   The ring is single producer (the ISR only writes Head) and single
+   consumer (CheckSwitchEdges only writes Tail) so no interrupt masking is
+   needed to share it. When it is full new edges are dropped and counted.
+   The posted events carry the capture time (ES_Timer_GetTime) in
+   EventParam.
+   SwitchDebounceService adds its pins without a post function and calls
+   CheckSwitchEdges itself on every sample tick, so the checker does not
+   need to be in EVENT_CHECK_LIST unless a pin posts events.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_nvic.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/pin_map.h"	// Define PART_TM4C123GH6PM in project
+#include "driverlib/gpio.h"
+
+#include "BITDEFS.H"
+#include "SwitchCapture.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define ALL_BITS (0xff<<2)
+
+#define PORT_B          BIT1HI
+#define GPIOB_INT_EN    BIT1HI  // GPIO port B is interrupt 1, bit 1 of EN0
+
+#define RING_SIZE 16            // must be a power of 2
+#define RING_MASK (RING_SIZE-1)
+
+/*---------------------------- Module Types -------------------------------*/
+typedef struct {
+	uint16_t Time;     // framework time when the edge was latched
+	uint8_t  Changed;  // pins that raised the interrupt
+	uint8_t  Level;    // port B pin levels right after the edge
+} SwitchEdge_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void InitPortB ( void );
+static void PostEdge ( uint8_t Bit, bool IsDown, uint16_t Time );
+
+/*---------------------------- Module Variables ---------------------------*/
+static bool PortReady = false;
+static uint8_t CapturedPins;     // pins registered with AddPin
+static uint8_t LastLevel;        // levels as of the last edge processed
+static uint8_t EdgeSeen;         // pins with an edge since the last Take
+static uint16_t FirstEdgeTime[8];
+
+// who to tell about each pin, indexed by bit number
+static pPostFunc PinPostFunc[8];
+static ES_EventTyp_t PinDownEvent[8];
+static ES_EventTyp_t PinUpEvent[8];
+
+// ISR -> main loop ring
+static volatile SwitchEdge_t Ring[RING_SIZE];
+static volatile uint8_t Head;    // written only by the ISR
+static volatile uint8_t Tail;    // written only by CheckSwitchEdges
+static volatile uint16_t NumOverflows;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     SwitchCapture_AddPin
+
+ Parameters
+     uint8_t PinMask : the port B pin (BITnHI) the switch is on
+     pPostFunc PostFunc : where to post the switch events
+     (PostFunc may be (pPostFunc)0 to only timestamp the pin's edges)
+     ES_EventTyp_t DownEvent : posted when the pin goes high (switch closed)
+     ES_EventTyp_t UpEvent : posted when the pin goes low (switch open)
+
+ Returns
+     bool, false if PinMask is not a single pin, true otherwise
+
+ Description
+     Sets the pin up as a digital input interrupting on both edges and
+     records where its events go. Called from the switch service's Init.
+****************************************************************************/
+bool SwitchCapture_AddPin ( uint8_t PinMask, pPostFunc PostFunc,
+                            ES_EventTyp_t DownEvent, ES_EventTyp_t UpEvent )
+{
+	uint8_t Bit;
+
+	// make sure exactly one pin was given
+	if ( (PinMask == 0) || ((PinMask & (PinMask - 1)) != 0) ) {
+		return false;
+	}
+	for ( Bit = 0; (PinMask >> Bit) != 1; Bit++ ) {
+	}
+
+	if ( PortReady == false ) {
+		InitPortB();
+	}
+
+	PinPostFunc[Bit] = PostFunc;
+	PinDownEvent[Bit] = DownEvent;
+	PinUpEvent[Bit] = UpEvent;
+
+	//set the pin to a digital input
+	HWREG(GPIO_PORTB_BASE+GPIO_O_DEN) |= PinMask;
+	HWREG(GPIO_PORTB_BASE+GPIO_O_DIR) &= ~PinMask;
+	//edge sensitive, on both edges
+	HWREG(GPIO_PORTB_BASE+GPIO_O_IS) &= ~PinMask;
+	HWREG(GPIO_PORTB_BASE+GPIO_O_IBE) |= PinMask;
+
+	//sample the pin so the first edge is compared against the right level
+	LastLevel = (LastLevel & ~PinMask) |
+	            (HWREG(GPIO_PORTB_BASE+(GPIO_O_DATA+ALL_BITS)) & PinMask);
+	CapturedPins |= PinMask;
+
+	//clear anything left over from the setup, then unmask the pin
+	HWREG(GPIO_PORTB_BASE+GPIO_O_ICR) = PinMask;
+	HWREG(GPIO_PORTB_BASE+GPIO_O_IM) |= PinMask;
+	return true;
+}
+
+/****************************************************************************
+ Function
+     SwitchCapture_QueryLevels
+
+ Returns
+     uint8_t, the port B levels as of the last edge processed
+****************************************************************************/
+uint8_t SwitchCapture_QueryLevels ( void )
+{
+	return LastLevel;
+}
+
+/****************************************************************************
+ Function
+     SwitchCapture_TakeEdgeTime
+
+ Parameters
+     uint8_t PinMask : the port B pin (BITnHI) to ask about
+     uint16_t *pTime : gets the time of the first edge, if there was one
+
+ Returns
+     bool, true if the pin has had an edge since the last call
+
+ Description
+     Hands over the time the pin first changed since the last call and
+     starts looking for the next first edge. The edges are only seen once
+     CheckSwitchEdges has drained the ring.
+****************************************************************************/
+bool SwitchCapture_TakeEdgeTime ( uint8_t PinMask, uint16_t *pTime )
+{
+	uint8_t Bit;
+
+	if ( (EdgeSeen & PinMask) == 0 ) {
+		return false;
+	}
+	for ( Bit = 0; (PinMask >> Bit) != 1; Bit++ ) {
+	}
+	*pTime = FirstEdgeTime[Bit];
+	EdgeSeen &= ~PinMask;
+	return true;
+}
+
+/****************************************************************************
+ Function
+     SwitchCapture_QueryOverflows
+
+ Returns
+     uint16_t, number of edges dropped because the ring was full
+****************************************************************************/
+uint16_t SwitchCapture_QueryOverflows ( void )
+{
+	return NumOverflows;
+}
+
+/****************************************************************************
+ Function
+     SwitchCaptureISR
+
+ Description
+     GPIO port B interrupt response. Clears the source and latches which
+     pins changed, the pin levels and the time into the ring.
+****************************************************************************/
+void SwitchCaptureISR ( void )
+{
+	uint8_t Changed;
+	uint8_t Slot;
+
+	//find out which pins interrupted and clear them
+	Changed = HWREG(GPIO_PORTB_BASE+GPIO_O_MIS);
+	HWREG(GPIO_PORTB_BASE+GPIO_O_ICR) = Changed;
+
+	//if there is room in the ring, latch the edge
+	if ( (uint8_t)(Head - Tail) < RING_SIZE ) {
+		Slot = Head & RING_MASK;
+		Ring[Slot].Time = ES_Timer_GetTime();
+		Ring[Slot].Changed = Changed;
+		Ring[Slot].Level = HWREG(GPIO_PORTB_BASE+(GPIO_O_DATA+ALL_BITS));
+		//publish the entry only once it is complete
+		Head++;
+	} else {
+		NumOverflows++;
+	}
+}
+
+/****************************************************************************
+ Function
+     CheckSwitchEdges
+
+ Parameters
+     Takes no parameters
+
+ Returns
+     bool, returns True if an event posted, false otherwise
+
+ Description
+     Event checker. Returns right away when the ring is empty, otherwise
+     timestamps every captured pin change and posts a Down or Up event for
+     the pins that were added with a post function.
+****************************************************************************/
+bool CheckSwitchEdges ( void )
+{
+	bool ReturnVal = false;
+	SwitchEdge_t Edge;
+	uint8_t Slot;
+	uint8_t Pending;
+	uint8_t Bit;
+	uint8_t Mask;
+
+	//drain everything latched since the last pass, if anything
+	while ( Tail != Head ) {
+		Slot = Tail & RING_MASK;
+		Edge.Time = Ring[Slot].Time;
+		Edge.Changed = Ring[Slot].Changed;
+		Edge.Level = Ring[Slot].Level;
+		//hand the slot back to the ISR
+		Tail++;
+
+		Pending = Edge.Changed & CapturedPins;
+		for ( Bit = 0, Mask = BIT0HI; Pending != 0; Bit++, Mask <<= 1 ) {
+			if ( (Pending & Mask) == 0 ) {
+				continue;
+			}
+			Pending &= ~Mask;
+			//remember when this pin first moved
+			if ( (EdgeSeen & Mask) == 0 ) {
+				FirstEdgeTime[Bit] = Edge.Time;
+				EdgeSeen |= Mask;
+			}
+			if ( PinPostFunc[Bit] == (pPostFunc)0 ) {
+				continue;
+			}
+			ReturnVal = true;
+			//a pulse shorter than the interrupt latency leaves the level where
+			//it was, post the transition we did not get to see first
+			if ( (Edge.Level & Mask) == (LastLevel & Mask) ) {
+				PostEdge( Bit, (LastLevel & Mask) == 0, Edge.Time );
+			}
+			//pin high means the switch is down
+			PostEdge( Bit, (Edge.Level & Mask) != 0, Edge.Time );
+		}
+		LastLevel = (LastLevel & ~Edge.Changed) | (Edge.Level & Edge.Changed);
+	}
+	return ReturnVal;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     InitPortB
+
+ Description
+     Turns on port B and enables its interrupt in the NVIC, once.
+****************************************************************************/
+static void InitPortB ( void )
+{
+	HWREG(SYSCTL_RCGCGPIO) |= PORT_B; //enable port B
+	//wait for peripheral clock
+	while ((HWREG(SYSCTL_PRGPIO) & PORT_B) != PORT_B);
+	//let the port B interrupt through the NVIC, pins are unmasked as added
+	HWREG(NVIC_EN0) = GPIOB_INT_EN;
+	PortReady = true;
+}
+
+/****************************************************************************
+ Function
+     PostEdge
+
+ Description
+     Posts the Down or Up event registered for the pin, with the capture
+     time as the parameter.
+****************************************************************************/
+static void PostEdge ( uint8_t Bit, bool IsDown, uint16_t Time )
+{
+	ES_Event ThisEvent;
+	ThisEvent.EventType = IsDown ? PinDownEvent[Bit] : PinUpEvent[Bit];
+	ThisEvent.EventParam = Time;
+	PinPostFunc[Bit]( ThisEvent );
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,27 @@
+/****************************************************************************
+
+  Header file for SwitchCapture (port B edge capture for the limit and
+  seed switches)
+
+ ****************************************************************************/
+
+#ifndef SwitchCapture_H
+#define SwitchCapture_H
+
+// Event Definitions
+#include "ES_Configure.h" /* gets us event definitions */
+#include "ES_Types.h"     /* gets bool type for returns */
+#include "ES_Framework.h" /* gets pPostFunc */
+
+// Public Function Prototypes
+bool SwitchCapture_AddPin ( uint8_t PinMask, pPostFunc PostFunc,
+                            ES_EventTyp_t DownEvent, ES_EventTyp_t UpEvent );
+uint8_t SwitchCapture_QueryLevels ( void );
+bool SwitchCapture_TakeEdgeTime ( uint8_t PinMask, uint16_t *pTime );
+uint16_t SwitchCapture_QueryOverflows ( void );
+void SwitchCaptureISR ( void );
+
+//Event checkers
+bool CheckSwitchEdges ( void );
+
+#endif /* SwitchCapture_H */
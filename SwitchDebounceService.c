@@ -0,0 +1,348 @@
+/****************************************************************************
+ Module
+   SwitchDebounceService.c
+
+ Description
+   Debounces all of the switches at once: the seed switch (PB0), the
+   flipbook limit switches (PB1-PB3) and the fruit switch (PA7). Every
+   DEBOUNCE_TICK the ports are read once and all pins are run through a
+   set of 2 bit vertical counters, so a pin only changes its debounced
+   state after reading the new level 4 samples in a row.
+   When a switch is debounced closed the matching story event is posted
+   (ES_SEED_DETECTED, ES_F1_DONE, ES_F2_DONE, ES_F3_DONE, ES_FR_DISP_DONE).
+
+ Notes
+   Replaces the SeedService, Flipbook1/2/3Switch and FruitSwitch services,
+   which each used their own service, queue and timer for the same 2 state
+   debounce machine.
+   The port B pins are also timestamped by SwitchCapture, so the posted
+   events carry the time of the first edge of the press (ES_Timer_GetTime
+   units) in EventParam rather than the time the press was confirmed. The
+   fruit switch is not on port B and gets the confirm time instead.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+/* include header files for the framework and this service
+*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+#include "ES_SoftTimers.h"
+#include "ES_QueueStats.h"
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_sysctl.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/pin_map.h"	// Define PART_TM4C123GH6PM in project
+#include "driverlib/gpio.h"
+
+#include "BITDEFS.H"
+#include "SwitchCapture.h"
+#include "SwitchDebounceService.h"
+#include "FruitDispenseService.h"
+
+#define ALL_BITS (0xff<<2)
+
+#define PORT_A  BIT0HI
+
+// port pins
+#define SEED_PIN    BIT0HI  //The input pin from seed switch is PB0
+#define F1_PIN      BIT1HI  //The input pin from flipbook1 switch is PB1
+#define F3_PIN      BIT2HI  //The input pin from flipbook3 switch is PB2
+#define F2_PIN      BIT3HI  //The input pin from flipbook2 switch is PB3
+#define FRUIT_PIN   BIT7HI  //The input pin for fruitswitch is PA7
+
+// bits in the combined sample, the port B switches keep their pin bits and
+// the fruit switch is moved down next to them
+#define PORTB_SWITCHES (SEED_PIN | F1_PIN | F3_PIN | F2_PIN)
+#define FRUIT_BIT   BIT4HI
+#define FRUIT_SHIFT 3
+
+#define DEBOUNCE_TICK     10  //ms between samples, the 2 bit counters need 4
+                              //samples in a row to accept a change
+
+#define NUM_SWITCHES 5
+
+/*---------------------------- Module Types -------------------------------*/
+// what to post when a switch is debounced closed
+typedef struct {
+	uint8_t Bit;             // bit in the combined sample
+	pPostFunc PostFunc;      // post function or distribution list
+	ES_EventTyp_t EventType;
+} SwitchAction_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+/* prototypes for private functions for this service.They should be functions
+   relevant to the behavior of this service
+*/
+static ES_Event HandleSwitchDebounceEvent ( ES_Event ThisEvent );
+static uint8_t QueryState ( void );
+static uint8_t SampleSwitches ( void );
+static void PostPressed ( uint8_t Pressed );
+
+/*---------------------------- Module Variables ---------------------------*/
+// with the introduction of Gen2, we need a module level Priority variable
+static uint8_t MyPriority;
+
+// debounced levels (bit high = switch down) and the vertical counters,
+// Count0 is the low bit and Count1 the high bit of each pin's counter
+static uint8_t Debounced;
+static uint8_t Count0;
+static uint8_t Count1;
+
+static const SwitchAction_t Actions[NUM_SWITCHES] = {
+	// seed detected goes to Flip1Service, MainStoryService, LEDService
+	{ SEED_PIN,  ES_PostList03,    ES_SEED_DETECTED },
+	// F1 done goes to Flip1Service, WaterBucketService, Flip2Service, LEDService
+	{ F1_PIN,    ES_PostList02,    ES_F1_DONE },
+	// F2 done goes to Flip2Service, Flip3Service, LEDService, WaterBucketService
+	{ F2_PIN,    ES_PostList05,    ES_F2_DONE },
+	// F3 done goes to Flip3Service, MainStoryService, LEDService, FruitService
+	{ F3_PIN,    ES_PostList06,    ES_F3_DONE },
+	{ FRUIT_BIT, PostFruitService, ES_FR_DISP_DONE }
+};
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     InitSwitchDebounceService
+
+ Parameters
+     uint8_t : the priorty of this service
+
+ Returns
+     bool, false if error in initialization, true otherwise
+
+ Description
+     Saves away the priority, sets up the switch pins, takes the starting
+     levels as the debounced state and starts the sample timer.
+ Notes
+
+****************************************************************************/
+bool InitSwitchDebounceService ( uint8_t Priority )
+{
+	ES_Event ThisEvent;
+
+	//	Initialize the MyPriority variable with the passed in parameter.
+	MyPriority = Priority;
+
+	//Let SwitchCapture set up the port B pins and timestamp their edges,
+	//we do the posting so no post function is given
+	SwitchCapture_AddPin( SEED_PIN, (pPostFunc)0, ES_NO_EVENT, ES_NO_EVENT );
+	SwitchCapture_AddPin( F1_PIN, (pPostFunc)0, ES_NO_EVENT, ES_NO_EVENT );
+	SwitchCapture_AddPin( F2_PIN, (pPostFunc)0, ES_NO_EVENT, ES_NO_EVENT );
+	SwitchCapture_AddPin( F3_PIN, (pPostFunc)0, ES_NO_EVENT, ES_NO_EVENT );
+
+	//Initialize the port line to monitor the fruit switch
+	HWREG(SYSCTL_RCGCGPIO) |= PORT_A; //enable port A
+	//wait for peripheral clock
+	while ((HWREG(SYSCTL_PRGPIO) & PORT_A) != PORT_A);
+	//set fruit switch pin to input
+	HWREG(GPIO_PORTA_BASE+GPIO_O_DEN) |= FRUIT_PIN;
+	HWREG(GPIO_PORTA_BASE+GPIO_O_DIR) &= ~FRUIT_PIN;
+
+	//Whatever the switches are doing now is the starting state, so a switch
+	//that is already down does not post
+	Debounced = SampleSwitches();
+	Count0 = 0;
+	Count1 = 0;
+
+	//Start the sample timer, it is periodic so the tick does not stretch
+	ES_SoftTimer_InitPeriodic( DEBOUNCE_TIMER, DEBOUNCE_TICK );
+
+	ThisEvent.EventType = ES_INIT;
+	if (ES_QueueStatsPost( MyPriority, ThisEvent) == true)
+	{
+		return true;
+	} else {
+		return false;
+	}
+}
+
+/****************************************************************************
+ Function
+     PostSwitchDebounceService
+
+ Parameters
+     EF_Event ThisEvent ,the event to post to the queue
+
+ Returns
+     bool false if the Enqueue operation failed, true otherwise
+
+ Description
+     Posts an event to this service's queue
+****************************************************************************/
+bool PostSwitchDebounceService( ES_Event ThisEvent )
+{
+	return ES_QueueStatsPost( MyPriority, ThisEvent);
+}
+
+/****************************************************************************
+ Function
+    RunSwitchDebounceService
+
+ Parameters
+   ES_Event : the event to process
+
+ Returns
+   ES_Event, whatever HandleSwitchDebounceEvent returns
+
+ Description
+   Runs ThisEvent through HandleSwitchDebounceEvent by way of ES_QueueStatsRun
+****************************************************************************/
+ES_Event RunSwitchDebounceService( ES_Event ThisEvent )
+{
+	return ES_QueueStatsRun( MyPriority, ThisEvent, HandleSwitchDebounceEvent, QueryState );
+}
+
+/****************************************************************************
+ Function
+    HandleSwitchDebounceEvent
+
+ Parameters
+   ES_Event : the event to process
+	 The EventType field of ThisEvent will be ES_INIT or ES_TIMEOUT
+
+ Returns
+   ES_Event, ES_NO_EVENT if no error ES_ERROR otherwise
+
+ Description
+   On every sample tick reads the switches and steps the vertical counters.
+   A pin whose sample differs from its debounced level counts up, a pin
+   that reads its debounced level has its counter cleared. When a counter
+   wraps the pin has been different for 4 ticks in a row and
+   its debounced level flips.
+ Notes
+   The counters are the usual bitwise ones, every pin is stepped with the
+   same handful of logic operations regardless of how many there are.
+****************************************************************************/
+static ES_Event HandleSwitchDebounceEvent( ES_Event ThisEvent )
+{
+	ES_Event ReturnEvent;
+	uint8_t Sample;
+	uint8_t Delta;
+	uint8_t Toggle;
+	uint8_t Clear;
+	uint8_t Mask;
+	uint16_t Dummy;
+
+	ReturnEvent.EventType = ES_NO_EVENT;
+
+	//If EventType is ES_TIMEOUT from the sample timer
+	if ( (ThisEvent.EventType == ES_TIMEOUT) && (ThisEvent.EventParam == DEBOUNCE_TIMER) ) {
+		//Pick up any port B edges latched since the last tick
+		CheckSwitchEdges();
+
+		//Read all the switches
+		Sample = SampleSwitches();
+
+		//Pins that differ from their debounced level count, the rest reset
+		Delta = Sample ^ Debounced;
+		Count1 = (Count1 ^ Count0) & Delta;
+		Count0 = ~Count0 & Delta;
+		//A counter that wrapped back to 0 while still different means the
+		//pin has been steady at the new level long enough
+		Toggle = Delta & ~(Count0 | Count1);
+		Debounced ^= Toggle;
+
+		//Post the story events for the switches that just closed (pin high)
+		if ( (Toggle & Debounced) != 0 ) {
+			PostPressed( Toggle & Debounced );
+		}
+
+		//Drop the edge times of switches that just opened, and of pins that
+		//read their debounced level (so not in the middle of a change) so a
+		//glitch does not stamp the next real press
+		Clear = (~Delta | (Toggle & ~Debounced)) & PORTB_SWITCHES;
+		for ( Mask = BIT0HI; Clear != 0; Mask <<= 1 ) {
+			if ( (Clear & Mask) != 0 ) {
+				SwitchCapture_TakeEdgeTime( Mask, &Dummy );
+				Clear &= ~Mask;
+			}
+		}
+	}
+
+	//Return ES_NO_EVENT
+	return ReturnEvent;
+}
+
+/****************************************************************************
+ Function
+     QueryState
+
+ Returns
+     uint8_t, always 0: the debouncer has no states, so the trace only
+     shows the events it handles
+****************************************************************************/
+static uint8_t QueryState ( void )
+{
+	return 0;
+}
+
+/****************************************************************************
+ Function
+     QueryDebouncedSwitches
+
+ Returns
+     uint8_t, the debounced levels, PB0-PB3 in bits 0-3 and the fruit
+     switch in bit 4 (bit high = switch down)
+****************************************************************************/
+uint8_t QueryDebouncedSwitches ( void )
+{
+	return Debounced;
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     SampleSwitches
+
+ Description
+     One read of each port, packed into a single byte of switch levels.
+****************************************************************************/
+static uint8_t SampleSwitches ( void )
+{
+	uint8_t Sample;
+
+	Sample = HWREG(GPIO_PORTB_BASE+(GPIO_O_DATA+ALL_BITS)) & PORTB_SWITCHES;
+	Sample |= (HWREG(GPIO_PORTA_BASE+(GPIO_O_DATA+ALL_BITS)) & FRUIT_PIN) >> FRUIT_SHIFT;
+	return Sample;
+}
+
+/****************************************************************************
+ Function
+     PostPressed
+
+ Description
+     Posts the story event for every switch in Pressed, stamped with the
+     time its first edge was captured (or the current time if there is
+     none).
+****************************************************************************/
+static void PostPressed ( uint8_t Pressed )
+{
+	ES_Event PressEvent;
+	uint16_t EdgeTime;
+	uint8_t i;
+
+	for ( i = 0; i < NUM_SWITCHES; i++ ) {
+		if ( (Pressed & Actions[i].Bit) == 0 ) {
+			continue;
+		}
+		PressEvent.EventType = Actions[i].EventType;
+		if ( ((Actions[i].Bit & PORTB_SWITCHES) != 0) &&
+		     (SwitchCapture_TakeEdgeTime( Actions[i].Bit, &EdgeTime ) == true) ) {
+			PressEvent.EventParam = EdgeTime;
+		} else {
+			PressEvent.EventParam = ES_Timer_GetTime();
+		}
+		Actions[i].PostFunc( PressEvent );
+		#if DEBUG_SWITCHES
+		printf("SD: switch 0x%02x down, posting event %d\n\r", Actions[i].Bit, PressEvent.EventType);
+		#endif
+	}
+}
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
@@ -0,0 +1,21 @@
+/****************************************************************************
+
+  Header file for SwitchDebounceService
+
+ ****************************************************************************/
+
+#ifndef SwitchDebounceService_H
+#define SwitchDebounceService_H
+
+// Event Definitions
+#include "ES_Configure.h" /* gets us event definitions */
+#include "ES_Types.h"     /* gets bool type for returns */
+#include "ES_Events.h"
+
+// Public Function Prototypes
+bool InitSwitchDebounceService ( uint8_t Priority );
+ES_Event RunSwitchDebounceService( ES_Event ThisEvent );
+bool PostSwitchDebounceService( ES_Event ThisEvent );
+uint8_t QueryDebouncedSwitches ( void );
+
+#endif /*SwitchDebounceService_H */
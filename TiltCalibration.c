@@ -0,0 +1,354 @@
+/****************************************************************************
+ Module
+   TiltCalibration.c
+
+ Description
+   The one copy of the water bucket calibration: the tilt angle at rest and
+   at full tilt, and the thresholds derived from them. Every
+   service that looks at ES_WATER samples reads it with TiltCal_Get, so
+   they all agree on when water is pouring.
+   The calibration is kept in the on-chip EEPROM. Re-mounting the bucket
+   only needs a new rest and full tilt reading (TiltCal_RecordRest and
+   TiltCal_RecordFullTilt, the water bucket service does them on the 'r'
+   and 't' keys), not a code change.
+
+ Notes
+   The thresholds are fractions of the range from rest to full tilt:
+   water pours once the bucket is WATER_DIV of the way over and the bucket
+   is at rest within STOP_DIV of the rest reading.
+   TiltCal_Scale maps a tilt onto an output range (a PWM duty or pulse
+   width) with a multiply by 1 / (full tilt - rest), worked out once when
+   the calibration changes, so mapping an ES_WATER sample never divides.
+   The EEPROM record carries a magic number and a check word. If either is
+   wrong, or the readings make no sense, the defaults (upright and 90
+   degrees over) are used until a calibration is recorded. Records from
+   before the tilt was an angle have a different magic number.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include "ES_Configure.h"
+#include "ES_Framework.h"
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_sysctl.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/eeprom.h"
+
+#include "IntTrig.h"
+#include "TiltCalibration.h"
+#if BENCH_TILT_SCALE
+#include "ES_Profile.h"
+#endif
+
+/*----------------------------- Module Defines ----------------------------*/
+// used until the bucket is calibrated
+#define DEFAULT_REST_TILT DEG(0)
+#define DEFAULT_FULL_TILT DEG(90)
+
+// thresholds as fractions of the rest to full tilt range
+#define WATER_DIV 4
+#define STOP_DIV  64
+
+// a calibration with less range than this is a bad reading
+#define MIN_RANGE DEG(10)
+
+// TiltCal_Scale multiplies by 1 / range in Q24, rounded up so full tilt
+// maps all the way to the top of the output
+#define SCALE_BITS 24
+#define RECIP( Range ) ( ((1ul << SCALE_BITS) + (Range) - 1) / (Range) )
+
+#if BENCH_TILT_SCALE && !ES_PROFILE
+#error BENCH_TILT_SCALE needs ES_PROFILE for the cycle counter
+#endif
+
+// where the record lives in the EEPROM, and what marks it as ours
+#define EEPROM_ADDR  0x0
+#define RECORD_MAGIC 0x544c5432  // "TLT2", the counts were "TILT"
+
+/*---------------------------- Module Types -------------------------------*/
+// the EEPROM record, a whole number of words
+typedef struct {
+	uint32_t Magic;
+	TiltCal_t Cal;
+	uint32_t Check;
+} CalRecord_t;
+
+/*---------------------------- Module Functions ---------------------------*/
+static void Derive ( TiltCal_t *pCal );
+static bool IsSensible ( const TiltCal_t *pCal );
+static uint32_t CheckWord ( const CalRecord_t *pRecord );
+static bool Save ( void );
+#if BENCH_TILT_SCALE
+static void BenchmarkScale ( void );
+#endif
+
+/*---------------------------- Module Variables ---------------------------*/
+static TiltCal_t Cal = { DEFAULT_REST_TILT, DEFAULT_FULL_TILT,
+                         DEFAULT_REST_TILT + (DEFAULT_FULL_TILT - DEFAULT_REST_TILT) / WATER_DIV,
+                         DEFAULT_REST_TILT + (DEFAULT_FULL_TILT - DEFAULT_REST_TILT) / STOP_DIV };
+static uint32_t Recip = RECIP( DEFAULT_FULL_TILT - DEFAULT_REST_TILT );
+static bool EEPROMReady = false;
+
+/*------------------------------ Module Code ------------------------------*/
+/****************************************************************************
+ Function
+     TiltCal_Init
+
+ Description
+     Starts the EEPROM and loads the calibration from it, keeping the
+     defaults if there is no good record. Called from the water bucket
+     service's Init.
+****************************************************************************/
+void TiltCal_Init ( void )
+{
+	CalRecord_t Record;
+
+	HWREG(SYSCTL_RCGCEEPROM) |= SYSCTL_RCGCEEPROM_R0;
+	while( (HWREG(SYSCTL_PREEPROM) & SYSCTL_PREEPROM_R0) != SYSCTL_PREEPROM_R0 );
+	if ( EEPROMInit() != EEPROM_INIT_OK ) {
+		#if DEBUG_WATER
+		printf("Cal: EEPROM failed, using defaults\n\r");
+		#endif
+		return;
+	}
+	EEPROMReady = true;
+
+	EEPROMRead( (uint32_t *)&Record, EEPROM_ADDR, sizeof(Record) );
+	if ( (Record.Magic == RECORD_MAGIC) && (Record.Check == CheckWord( &Record )) &&
+	     IsSensible( &Record.Cal ) ) {
+		Cal = Record.Cal;
+		Recip = RECIP( Cal.FullTilt - Cal.RestTilt );
+	}
+	#if DEBUG_WATER
+	printf("Cal: rest %u, full tilt %u, water at %u, stop at %u\n\r", Cal.RestTilt,
+	       Cal.FullTilt, Cal.WaterThreshold, Cal.StopThreshold);
+	#endif
+	#if BENCH_TILT_SCALE
+	BenchmarkScale();
+	#endif
+}
+
+/****************************************************************************
+ Function
+     TiltCal_Get
+
+ Returns
+     const TiltCal_t *, the calibration in use
+****************************************************************************/
+const TiltCal_t *TiltCal_Get ( void )
+{
+	return &Cal;
+}
+
+/****************************************************************************
+ Function
+     TiltCal_Scale
+
+ Parameters
+     uint16_t Tilt : a tilt, from ES_WATER
+     uint16_t OutMin, OutMax : the output at rest and at full tilt,
+                               OutMin <= OutMax
+
+ Returns
+     uint16_t, the output in proportion to how far the tilt is from rest
+     to full tilt, held at OutMin and OutMax outside that range
+****************************************************************************/
+uint16_t TiltCal_Scale ( uint16_t Tilt, uint16_t OutMin, uint16_t OutMax )
+{
+	uint32_t Fraction;
+
+	if ( Tilt <= Cal.RestTilt ) {
+		return OutMin;
+	}
+	if ( Tilt >= Cal.FullTilt ) {
+		return OutMax;
+	}
+	//how far from rest to full tilt, in Q16 (just under 1)
+	Fraction = ((uint32_t)(Tilt - Cal.RestTilt) * Recip) >> (SCALE_BITS - 16);
+	if ( Fraction > 0xffff ) {
+		Fraction = 0xffff;
+	}
+	return OutMin + (uint16_t)(((uint32_t)(OutMax - OutMin) * Fraction) >> 16);
+}
+
+/****************************************************************************
+ Function
+     TiltCal_RecordRest, TiltCal_RecordFullTilt
+
+ Parameters
+     uint16_t Reading : the filtered tilt with the bucket upright (at full
+                        tilt)
+
+ Returns
+     bool, true if the new calibration made sense and was saved
+
+ Description
+     Replaces one end of the range, derives the thresholds again and saves
+     the calibration. If it makes no sense (full tilt not well above rest)
+     the calibration in use is kept.
+****************************************************************************/
+bool TiltCal_RecordRest ( uint16_t Reading )
+{
+	TiltCal_t NewCal = Cal;
+
+	NewCal.RestTilt = Reading;
+	Derive( &NewCal );
+	if ( !IsSensible( &NewCal ) ) {
+		return false;
+	}
+	Cal = NewCal;
+	Recip = RECIP( Cal.FullTilt - Cal.RestTilt );
+	return Save();
+}
+
+bool TiltCal_RecordFullTilt ( uint16_t Reading )
+{
+	TiltCal_t NewCal = Cal;
+
+	NewCal.FullTilt = Reading;
+	Derive( &NewCal );
+	if ( !IsSensible( &NewCal ) ) {
+		return false;
+	}
+	Cal = NewCal;
+	Recip = RECIP( Cal.FullTilt - Cal.RestTilt );
+	return Save();
+}
+
+/***************************************************************************
+ private functions
+ ***************************************************************************/
+/****************************************************************************
+ Function
+     Derive
+
+ Description
+     Works the thresholds out from the rest and full tilt readings
+****************************************************************************/
+static void Derive ( TiltCal_t *pCal )
+{
+	uint16_t Range = pCal->FullTilt - pCal->RestTilt;
+
+	pCal->WaterThreshold = pCal->RestTilt + Range / WATER_DIV;
+	pCal->StopThreshold = pCal->RestTilt + Range / STOP_DIV;
+}
+
+/****************************************************************************
+ Function
+     IsSensible
+
+ Description
+     true if full tilt reads well above rest and the thresholds are the
+     ones Derive gives
+****************************************************************************/
+static bool IsSensible ( const TiltCal_t *pCal )
+{
+	TiltCal_t Derived = *pCal;
+
+	if ( (pCal->FullTilt <= pCal->RestTilt) ||
+	     (pCal->FullTilt - pCal->RestTilt < MIN_RANGE) ) {
+		return false;
+	}
+	Derive( &Derived );
+	return ( (Derived.WaterThreshold == pCal->WaterThreshold) &&
+	         (Derived.StopThreshold == pCal->StopThreshold) );
+}
+
+/****************************************************************************
+ Function
+     CheckWord
+
+ Description
+     Check word of a record, so a half written or foreign record is not
+     taken for a calibration
+****************************************************************************/
+static uint32_t CheckWord ( const CalRecord_t *pRecord )
+{
+	const uint32_t *pWords = (const uint32_t *)&pRecord->Cal;
+	uint32_t Check = RECORD_MAGIC;
+	uint8_t i;
+
+	for ( i = 0; i < sizeof(TiltCal_t) / sizeof(uint32_t); i++ ) {
+		Check = (Check << 5) + (Check >> 27) + pWords[i];
+	}
+	return ~Check;
+}
+
+/****************************************************************************
+ Function
+     Save
+
+ Description
+     Writes the calibration in use to the EEPROM
+****************************************************************************/
+static bool Save ( void )
+{
+	CalRecord_t Record;
+
+	#if DEBUG_WATER
+	printf("Cal: rest %u, full tilt %u, water at %u, stop at %u\n\r", Cal.RestTilt,
+	       Cal.FullTilt, Cal.WaterThreshold, Cal.StopThreshold);
+	#endif
+	if ( !EEPROMReady ) {
+		return false;
+	}
+	Record.Magic = RECORD_MAGIC;
+	Record.Cal = Cal;
+	Record.Check = CheckWord( &Record );
+	return ( EEPROMProgram( (uint32_t *)&Record, EEPROM_ADDR, sizeof(Record) ) == 0 );
+}
+
+#if BENCH_TILT_SCALE
+/****************************************************************************
+ Function
+     BenchmarkScale
+
+ Description
+     Maps every tilt from rest to full tilt onto Flipbook 2's pulse range
+     with a divide, the way the services used to, and with TiltCal_Scale,
+     then prints the cycles per sample of each and the largest difference
+****************************************************************************/
+#define BENCH_OUT_MIN 1800
+#define BENCH_OUT_MAX 2000
+static void BenchmarkScale ( void )
+{
+	static uint16_t DivideOut[DEG(90) + 1];
+	static uint16_t ScaleOut[DEG(90) + 1];
+	uint16_t NumSamples = Cal.FullTilt - Cal.RestTilt + 1;
+	uint32_t DivideCycles;
+	uint32_t ScaleCycles;
+	uint16_t MaxDiff = 0;
+	uint16_t i;
+
+	if ( NumSamples > DEG(90) + 1 ) {
+		NumSamples = DEG(90) + 1;
+	}
+	//Time the divide
+	DivideCycles = ES_ProfileGetCycles();
+	for ( i = 0; i < NumSamples; i++ ) {
+		DivideOut[i] = BENCH_OUT_MIN + ((BENCH_OUT_MAX - BENCH_OUT_MIN) * i) /
+		                               (Cal.FullTilt - Cal.RestTilt);
+	}
+	DivideCycles = ES_ProfileGetCycles() - DivideCycles;
+	//Time the reciprocal multiply
+	ScaleCycles = ES_ProfileGetCycles();
+	for ( i = 0; i < NumSamples; i++ ) {
+		ScaleOut[i] = TiltCal_Scale( Cal.RestTilt + i, BENCH_OUT_MIN, BENCH_OUT_MAX );
+	}
+	ScaleCycles = ES_ProfileGetCycles() - ScaleCycles;
+	//Compare the outputs
+	for ( i = 0; i < NumSamples; i++ ) {
+		uint16_t Diff = (DivideOut[i] > ScaleOut[i]) ? DivideOut[i] - ScaleOut[i]
+		                                             : ScaleOut[i] - DivideOut[i];
+		if ( Diff > MaxDiff ) {
+			MaxDiff = Diff;
+		}
+	}
+	printf("Cal: tilt scale, divide %lu cycles/sample, multiply %lu cycles/sample, max diff %u\n\r",
+	       (unsigned long)(DivideCycles / NumSamples),
+	       (unsigned long)(ScaleCycles / NumSamples), MaxDiff);
+}
+#endif
+
+/*------------------------------- Footnotes -------------------------------*/
+/*------------------------------ End of file ------------------------------*/
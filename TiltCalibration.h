@@ -0,0 +1,30 @@
+/****************************************************************************
+
+  Header file for TiltCalibration (water bucket tilt range and thresholds,
+  kept in EEPROM)
+
+ ****************************************************************************/
+
+#ifndef TiltCalibration_H
+#define TiltCalibration_H
+
+#include "ES_Types.h"     /* gets bool type for returns */
+
+// Tilts are angles from upright in tenths of a degree (IntTrig), they go
+// up as the bucket tips: the full tilt reading is above the rest reading,
+// and so are the thresholds.
+typedef struct {
+	uint16_t RestTilt;       // bucket upright
+	uint16_t FullTilt;       // bucket tipped all the way
+	uint16_t WaterThreshold; // at or above this, water is pouring
+	uint16_t StopThreshold;  // at or below this, the bucket is at rest
+} TiltCal_t;
+
+// Public Function Prototypes
+void TiltCal_Init ( void );
+const TiltCal_t *TiltCal_Get ( void );
+uint16_t TiltCal_Scale ( uint16_t Tilt, uint16_t OutMin, uint16_t OutMax );
+bool TiltCal_RecordRest ( uint16_t Reading );
+bool TiltCal_RecordFullTilt ( uint16_t Reading );
+
+#endif /* TiltCalibration_H */
@@ -23,9 +23,13 @@
    next lower level in the hierarchy that are sub-machines to this machine
 */
 
-#include <cmath>
 #include "ES_Configure.h"
 #include "ES_Framework.h"
+#include "ES_Broadcast.h"
+#include "ES_Mailbox.h"
+#include "ES_QueueStats.h"
+#include "ES_Profile.h"
+#include "ES_TableFSM.h"
 
 // include the PWM library
 #include "PWM8Tiva.h"
@@ -47,33 +51,106 @@
 #include "BITDEFS.H"
 #include "WaterBucketService.h"
 #include "Flipbook2Service.h"
-#include "ADMulti.h"
+#include "AccSampler.h"
+#include "Q15Filter.h"
+#include "SpikeFilter.h"
+#include "IntTrig.h"
+#include "TiltCalibration.h"
 #include "MainStoryService.h"
 
 #define ALL_BITS (0xff<<2)
-#define PI 3.14159265
-#define MIN_TILT_CHANGE 2500 //2600
-// define acceleration raw values that go roughly from 1800 (90 degrees) to 2600 (0 degrees)
+// the accelerometer reads about this on an axis with no gravity along it
+#define ACC_ZERO_G 2048
+
+// largest change of an axis reading from one sample to the next, a change
+// faster than this is a spike (SpikeFilter)
+#define ACC_SLEW_MAX 32
+
+// tilt filter coefficients (Q15Filter), the average of the last two samples
+#define TILT_B0 Q15(0.5)
+#define TILT_B1 Q15(0.5)
+#define TILT_A1 0
+// ES_TILT_EXIT needs the tilt this far back below the water threshold, so
+// the vibration motor doesn't chatter when the bucket sits at the threshold
+#define TILT_HYSTERESIS DEG(3)
+// ES_WATER only goes out when the tilt moved more than this since the last one
+#define WATER_DELTA DEG(0.5)
+
+#if BENCH_TILT_FILTER && !ES_PROFILE
+#error BENCH_TILT_FILTER needs ES_PROFILE for the cycle counter
+#endif
 
 #define PORT_C     BIT2HI
-#define PORT_E     BIT4HI
-#define Z_PIN      GPIO_PIN_0
 #define VIB_PIN    GPIO_PIN_4
 #define VIB_HI     BIT4HI
 #define VIB_LO     BIT4LO
 
+// superstate of the running states, handles ES_RESET for all of them
+#define WaterRunning  (DoneWatering + 1)
+#define NUM_WATER_STATES (WaterRunning + 1)
+
 //WaterBucketService
 //Listens to the water bucket accelerometer and controls the vibration motor. 
 bool InitWaterService ( uint8_t Priority );
 bool PostWaterBucketService ( ES_Event ThisEvent );
 ES_Event RunWaterService ( ES_Event ThisEvent );
+static ES_Event HandleWaterEvent ( ES_Event ThisEvent );
+static uint8_t QueryState ( void );
 
 bool Check4Water ( void );
+bool Check4CalibrationKey ( void );
 static bool Listen;
-static uint16_t AccToTilt ( void );
+static uint16_t AccToTilt ( const uint16_t *pBlock );
+static uint16_t AbsDiff ( uint16_t A, uint16_t B );
+static void StopListening ( ES_Event ThisEvent );
+static void StartListening ( ES_Event ThisEvent );
+static void StartVibrating ( ES_Event ThisEvent );
+static void StopVibrating ( ES_Event ThisEvent );
+static void StopWatering ( ES_Event ThisEvent );
+static void ResetWater ( ES_Event ThisEvent );
+static void CalibrateRest ( ES_Event ThisEvent );
+static void CalibrateFullTilt ( ES_Event ThisEvent );
+#if BENCH_TILT_FILTER
+static void BenchmarkTiltFilter ( void );
+#endif
 
 static uint8_t MyPriority;
 static WaterBucketState_t CurrentState;
+static Q15Filter_t TiltFilter;
+static SpikeFilter_t AxisFilters[ACC_AXES];
+static bool AxisFiltersReady;
+static uint16_t LastTilt;
+static bool Tilted;
+static uint16_t LastSent;
+static bool SendNext;
+
+//The transitions of each state
+static const ES_FSMRow_t InitRows[] = {
+	{ ES_INIT,    ES_FSM_ANY_PARAM, 0, StopListening,       Wait4Flip1Done }
+};
+static const ES_FSMRow_t Wait4Flip1DoneRows[] = {
+	{ ES_F1_DONE, ES_FSM_ANY_PARAM, 0, StartListening,      Wait4Water }
+};
+static const ES_FSMRow_t Wait4WaterRows[] = {
+	{ ES_TILT_ENTER, ES_FSM_ANY_PARAM, 0, StartVibrating,   ES_FSM_NO_CHANGE },
+	{ ES_TILT_EXIT, ES_FSM_ANY_PARAM, 0, StopVibrating,     ES_FSM_NO_CHANGE },
+	{ ES_F2_DONE, ES_FSM_ANY_PARAM, 0, StopWatering,        DoneWatering }
+};
+static const ES_FSMRow_t RunningRows[] = {
+	{ ES_RESET,   ES_FSM_ANY_PARAM, 0, ResetWater,          InitWaterBucketService },
+	{ ES_NEW_KEY, 'r',              0, CalibrateRest,       ES_FSM_NO_CHANGE },
+	{ ES_NEW_KEY, 't',              0, CalibrateFullTilt,   ES_FSM_NO_CHANGE }
+};
+
+//The machine, indexed by WaterBucketState_t (plus the WaterRunning superstate)
+static const ES_FSMState_t WaterStates[NUM_WATER_STATES] = {
+	/* InitWaterBucketService */ ES_FSM_STATE( ES_FSM_NO_PARENT, InitRows ),
+	/* Wait4Flip1Done */         ES_FSM_STATE( WaterRunning, Wait4Flip1DoneRows ),
+	/* Wait4Water */             ES_FSM_STATE( WaterRunning, Wait4WaterRows ),
+	/* DoneWatering */           ES_FSM_EMPTY_STATE( WaterRunning ),
+	/* WaterRunning */           ES_FSM_STATE( ES_FSM_NO_PARENT, RunningRows )
+};
+static const ES_FSM_t WaterMachine = { WaterStates, NUM_WATER_STATES };
 
 //InitWaterService
 //Takes a priority number, returns True. 
@@ -89,24 +166,25 @@ bool InitWaterService ( uint8_t Priority ) {
 	HWREG(GPIO_PORTC_BASE+GPIO_O_DEN) |= VIB_PIN;
 	HWREG(GPIO_PORTC_BASE+GPIO_O_DIR) |= VIB_PIN;
 	
-	//	Initialize the port E line for the accelerometer inputs
-  HWREG(SYSCTL_RCGCGPIO) |= PORT_E;   // enable port E 
-	// wait for the port to be ready
-	while( (HWREG(SYSCTL_PRGPIO) & PORT_E) != PORT_E );  
-	//We set pin PE0 to output the z position read by the accelerometer
-	//We set pin PE0 to be the output that feeds into the flipbook2 motor.
-	HWREG(GPIO_PORTE_BASE+GPIO_O_DEN) |= (Z_PIN);
-	//Initialize the analog pin that will be read from
-	ADC_MultiInit(1);
-	//	Initialize the port line to read the accelerometer input
-	HWREG(GPIO_PORTE_BASE+GPIO_O_DIR) &= ~Z_PIN;
+	//Load the bucket calibration
+	TiltCal_Init();
+	//Start sampling the accelerometer in blocks (through the ADC scheduler)
+	AccSampler_Init();
+	//Initialize the tilt filter, settled at the rest reading
+	LastTilt = TiltCal_Get()->RestTilt;
+	Q15Filter_Init( &TiltFilter, TILT_B0, TILT_B1, TILT_A1, LastTilt );
+	//the spike filters start at the first readings
+	AxisFiltersReady = false;
+	#if BENCH_TILT_FILTER
+	BenchmarkTiltFilter();
+	#endif
 	
 	//Set CurrentState to be InitWaterBucketService
 	CurrentState = InitWaterBucketService;
 	
 	//Post Event ES_Init to InitWaterBucketService queue (this service)
 	ThisEvent.EventType = ES_INIT;
-  if (ES_PostToService( MyPriority, ThisEvent) == true)
+  if (ES_QueueStatsPost( MyPriority, ThisEvent) == true)
   {  
     return true;
   }else
@@ -115,158 +193,279 @@ bool InitWaterService ( uint8_t Priority ) {
   }
 }//End of InitWaterService (return True)
 
-//RunWaterService (implements the state machine for Water Bucket Service)
-//The EventType field of ThisEvent will be one of: ES_INIT, ES_WATER, ES_NO_WATER, ES_CELEBRATION
-//Local Variables: NextState
-ES_Event RunWaterService(ES_Event ThisEvent) {
-//Set NextState to CurrentState
-	WaterBucketState_t NextState = CurrentState;
-//Based on the state of the CurrentState variable choose one of the following blocks of code:
-	switch (CurrentState) {
-//	CurrentState is InitWaterBucketService
-		case InitWaterBucketService :
-			//		if ThisEvent is ES_INIT
-			if (ThisEvent.EventType == ES_INIT) {
-				//Specify that we are not checking for water
-				Listen = false;
-				//Set NextState Wait4Flip1Done
-				NextState = Wait4Flip1Done;
-				#if DEBUG_WATER
-				printf("WB: Init water bucket\n\r\n");
-				#endif
-			}//		Endif
-		break;//End InitWaterBucketService block
-
-		//CurrentState is Wait4Flip1Done
-		case Wait4Flip1Done :
-			//if ThisEvent is ES_F1_DONE
-			if (ThisEvent.EventType == ES_F1_DONE) {
-				Listen = true;
-				//Set NextState Wait4Water
-				NextState = Wait4Water;
-			} //	End Wait4Flip1Done block
-			if (ThisEvent.EventType == ES_RESET) {
-				//Turn off motor
-				HWREG(GPIO_PORTC_BASE+(GPIO_O_DATA+ALL_BITS)) &= VIB_LO;	
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Set NextState InitWaterBucketService
-				NextState = InitWaterBucketService;
-			}
-		break;//End Wait4Flip1Done block
-
-		//	CurrentState is Wait4Water
-		case Wait4Water :
-			//if ThisEvent is ES_WATER
-			if (ThisEvent.EventType == ES_WATER) {
-				// if it's enough tilt for the vibration motor
-				if ( ( ThisEvent.EventParam <= MIN_TILT_CHANGE ) ){
-					// Turn on the vibration motor
-					HWREG(GPIO_PORTC_BASE+(GPIO_O_DATA+ALL_BITS)) |= VIB_HI;
-					#if DEBUG_WATER
-						printf("WB: Water!\n\r\n");
-					#endif
-				// else there isn't enough tilt	
-				} else {
-					// Turn off the vibration motor
-					HWREG(GPIO_PORTC_BASE+(GPIO_O_DATA+ALL_BITS)) &= VIB_LO;
-					#if DEBUG_WATER
-						printf("WB: No Water!\n\r\n");
-					#endif
-				}
-			}
-			
-			// if ThisEvent is ES_F2_DONE
-			else if (ThisEvent.EventType == ES_F2_DONE) {
-				// stop checking for water
-				Listen = false;
-				//Turn off the vibration motor
-				HWREG(GPIO_PORTC_BASE+(GPIO_O_DATA+ALL_BITS)) &= VIB_LO;				
-				//SetNextState DoneWatering
-				NextState = DoneWatering;
-			}
-			//	if ThisEvent is ES_RESET
-			else if (ThisEvent.EventType == ES_RESET) {
-				//Turn off motor
-				HWREG(GPIO_PORTC_BASE+(GPIO_O_DATA+ALL_BITS)) &= VIB_LO;	
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Set NextState InitWaterBucketService
-				NextState = InitWaterBucketService;
-			}
-		break; 	//End Wait4Water block
-
-		//	CurrentState is DoneWatering
-		case DoneWatering :
-			#if DEBUG_WATER
-				printf("WB: Done watering\n\r\n");
-			#endif
-			//if ThisEvent is ES_RESET
-			if ( ThisEvent.EventType == ES_RESET) {
-				// post an ES_DONE_INIT to the MainService
-				ES_Event Event2Post;
-				Event2Post.EventType = ES_DONE_INIT;
-				PostMainService( Event2Post );
-				//Set NextState InitWaterBucketService
-				NextState = InitWaterBucketService;
-			}
-		break; //	End DoneWatering
+//RunWaterService (hands ThisEvent to HandleWaterEvent by way of ES_QueueStatsRun)
+ES_Event RunWaterService ( ES_Event ThisEvent ) {
+	return ES_QueueStatsRun( MyPriority, ThisEvent, HandleWaterEvent, QueryState );
+}//End of RunWaterService
+
+//HandleWaterEvent (implements the state machine for Water Bucket Service)
+//The EventType field of ThisEvent will be one of: ES_INIT, ES_TILT_ENTER, ES_TILT_EXIT, ES_F1_DONE, ES_F2_DONE, ES_RESET
+static ES_Event HandleWaterEvent ( ES_Event ThisEvent ) {
+//If ThisEvent is ES_BROADCAST, replace it with the next event in the broadcast ring
+	if (ThisEvent.EventType == ES_BROADCAST) {
+		ThisEvent = ES_BroadcastFetch( MyPriority );
 	}
-	//	Set CurrentState to NextState
-	CurrentState = NextState;
+//Look ThisEvent up in the state table, it runs the action and gives us the
+//next state (ES_RESET is handled by the WaterRunning superstate)
+	CurrentState = (WaterBucketState_t)ES_FSM_Dispatch( &WaterMachine, CurrentState, ThisEvent );
 	//	Return ES_NO_EVENT
 	ThisEvent.EventType = ES_NO_EVENT;
 	return ThisEvent;
-}//End of RunWaterBucketService
+}//End of HandleWaterEvent
+
+//QueryState (the current state, for the trace kept by ES_QueueStatsRun)
+static uint8_t QueryState ( void ) {
+	return CurrentState;
+}//End of QueryState
 
 //Check4Water
 //Takes no parameters, returns True if an event posted
-//	Local ReturnVal = False, CurrentAccState
+//	Local ReturnVal = False, CurrentAccState, pBlock
 bool Check4Water ( void ) {
 	ES_Event ThisEvent;
 	bool ReturnVal = false;
-	//	Set CurrentAccState to state read from port pin
-	uint32_t CurrentAccState = AccToTilt();
+	const uint16_t *pBlock;
+	uint32_t CurrentAccState;
+	//	Nothing to do until the sampler has a full block
+	if ( !AccSampler_TakeBlock( &pBlock ) ) {
+		return ReturnVal;
+	}
+	//	Set CurrentAccState to the tilt over the block
+	CurrentAccState = AccToTilt( pBlock );
+	//	Remember it for calibrating
+	LastTilt = CurrentAccState;
 	#if DEBUG_ACC
 		printf("Acc val: %u\n\r\n", CurrentAccState);
 	#endif
 	if ( Listen ) { //if we are checking for water
-		
+		const TiltCal_t *pCal = TiltCal_Get();
 		ThisEvent.EventParam = CurrentAccState;
-		//PostEvent ES_WATER to water list
-		ThisEvent.EventType = ES_WATER;
-		ES_PostList04( ThisEvent );
+		//if the bucket just tipped past the water threshold
+		if ( !Tilted && ( CurrentAccState >= pCal->WaterThreshold ) ) {
+			//Broadcast ES_TILT_ENTER
+			Tilted = true;
+			ThisEvent.EventType = ES_TILT_ENTER;
+			ES_BroadcastPost( TILT_BROADCAST, ThisEvent );
+			ReturnVal = true;
+		//else if it came back up past the threshold and the hysteresis
+		} else if ( Tilted && ( CurrentAccState + TILT_HYSTERESIS <= pCal->WaterThreshold ) ) {
+			//Broadcast ES_TILT_EXIT
+			Tilted = false;
+			ThisEvent.EventType = ES_TILT_EXIT;
+			ES_BroadcastPost( TILT_BROADCAST, ThisEvent );
+			ReturnVal = true;
+		}
+		//if the tilt moved more than WATER_DELTA, or went in or out of rest
+		if ( SendNext || ( AbsDiff( CurrentAccState, LastSent ) > WATER_DELTA ) ||
+		     ( ( CurrentAccState <= pCal->StopThreshold ) != ( LastSent <= pCal->StopThreshold ) ) ) {
+			//PostEvent ES_WATER to the water mailbox (overwrites any unread sample)
+			LastSent = CurrentAccState;
+			SendNext = false;
+			ThisEvent.EventType = ES_WATER;
+			ES_MailboxPost( WATER_MAILBOX, ThisEvent );
+			ReturnVal = true;
+		}
 	}
 	//	Return ReturnVal
 	return ReturnVal;
 }//End of Check4Water
 
-//private TiltToDutyCycle
-//Returns the current tilt (Tilt), represented as an angle tan(z/x).
-static uint16_t AccToTilt ( void ) {
-	static double prevZVal = 2600;
-	uint16_t ReturnVal;
-	uint32_t ZArray[1];
-	double currZVal;
-	//Read the values for z from PE0;
-	ADC_MultiRead(ZArray);
-	currZVal = ZArray[0];
-	// filter signal
-	ReturnVal = (currZVal * 0.5) + (prevZVal * 0.5);
-	// save prev value
-	prevZVal = currZVal;
-	// return the filtered value
-	return ReturnVal;
-}//EndTiltToPWM
+//Check4CalibrationKey
+//Takes no parameters, returns True if an event posted
+//Keystrokes from the terminal come to us as ES_NEW_KEY, 'r' and 't' calibrate
+//the tilt and the state table ignores the rest
+bool Check4CalibrationKey ( void ) {
+	ES_Event ThisEvent;
+	//	Nothing to do until a key comes in
+	if ( !IsNewKeyReady() ) {
+		return false;
+	}
+	//	PostEvent ES_NEW_KEY with the key to this service
+	ThisEvent.EventType = ES_NEW_KEY;
+	ThisEvent.EventParam = GetNewKey();
+	PostWaterBucketService( ThisEvent );
+	return true;
+}//End of Check4CalibrationKey
+
+//private AbsDiff
+//Returns how far apart two tilts are
+static uint16_t AbsDiff ( uint16_t A, uint16_t B ) {
+	return ( A > B ) ? ( A - B ) : ( B - A );
+}//End AbsDiff
+
+//private AccToTilt
+//Returns the current tilt (Tilt) over a block of ACC_BLOCK_SIZE samples: the
+//angle of the bucket's axis (Z) from upright, in tenths of a degree (IntTrig),
+//whichever way round the bucket is turned.
+static uint16_t AccToTilt ( const uint16_t *pBlock ) {
+	int32_t Sum[ACC_AXES] = { 0, 0, 0 };
+	int32_t Axis[ACC_AXES];
+	uint8_t i, j;
+	//Start the spike filters settled at the first readings
+	if ( !AxisFiltersReady ) {
+		for ( j = 0; j < ACC_AXES; j++ ) {
+			SpikeFilter_Init( &AxisFilters[j], ACC_SLEW_MAX, pBlock[j] );
+		}
+		AxisFiltersReady = true;
+	}
+	//Take the spikes out of each axis and decimate the block to the average
+	//of each axis, less the zero g reading
+	for ( i = 0; i < ACC_BLOCK_SIZE; i++ ) {
+		for ( j = 0; j < ACC_AXES; j++ ) {
+			Sum[j] += SpikeFilter_Step( &AxisFilters[j], pBlock[i * ACC_AXES + j] );
+		}
+	}
+	for ( j = 0; j < ACC_AXES; j++ ) {
+		Axis[j] = Sum[j] / ACC_BLOCK_SIZE - ACC_ZERO_G;
+	}
+	//atan2 of the gravity across the bucket (X-Y) over the gravity along it (Z)
+	//and smooth it with the Q15 tilt filter (average of the last two tilts)
+	return (uint16_t)Q15Filter_Step( &TiltFilter,
+	       IntAtan2( IntHypot( Axis[ACC_X], Axis[ACC_Y] ), Axis[ACC_Z] ) );
+}//End AccToTilt
+
+#if BENCH_TILT_FILTER
+//private BenchmarkTiltFilter
+//Runs the same samples through the old double filter and the Q15 filter,
+//prints the cycles per sample of each and the largest difference. The
+//samples are tilts like AccToTilt feeds the filter, upright to 90 degrees over
+#define BENCH_SAMPLES 256
+static void BenchmarkTiltFilter ( void ) {
+	static uint16_t Samples[BENCH_SAMPLES];
+	static uint16_t DoubleOut[BENCH_SAMPLES];
+	static uint16_t FixedOut[BENCH_SAMPLES];
+	Q15Filter_t Filter;
+	uint16_t Start = TiltCal_Get()->RestTilt;
+	double prevTilt = Start;
+	double currTilt;
+	uint32_t Seed = 12345;
+	uint32_t DoubleCycles;
+	uint32_t FixedCycles;
+	uint16_t MaxDiff = 0;
+	uint16_t i;
+	//Make up tilts over the whole DEG(0) to DEG(90) range plus some noise
+	for ( i = 0; i < BENCH_SAMPLES; i++ ) {
+		Seed = Seed * 1103515245 + 12345;
+		Samples[i] = DEG(0) + ((uint32_t)i * (DEG(90) - DEG(0))) / BENCH_SAMPLES +
+		             ((Seed >> 16) % DEG(3));
+	}
+	//Time the old filter
+	DoubleCycles = ES_ProfileGetCycles();
+	for ( i = 0; i < BENCH_SAMPLES; i++ ) {
+		currTilt = Samples[i];
+		DoubleOut[i] = (currTilt * 0.5) + (prevTilt * 0.5);
+		prevTilt = currTilt;
+	}
+	DoubleCycles = ES_ProfileGetCycles() - DoubleCycles;
+	//Time the Q15 filter, settled at the rest tilt like the real one
+	Q15Filter_Init( &Filter, TILT_B0, TILT_B1, TILT_A1, Start );
+	FixedCycles = ES_ProfileGetCycles();
+	for ( i = 0; i < BENCH_SAMPLES; i++ ) {
+		FixedOut[i] = (uint16_t)Q15Filter_Step( &Filter, Samples[i] );
+	}
+	FixedCycles = ES_ProfileGetCycles() - FixedCycles;
+	//Compare the outputs
+	for ( i = 0; i < BENCH_SAMPLES; i++ ) {
+		uint16_t Diff = (DoubleOut[i] > FixedOut[i]) ? DoubleOut[i] - FixedOut[i]
+		                                             : FixedOut[i] - DoubleOut[i];
+		if ( Diff > MaxDiff ) {
+			MaxDiff = Diff;
+		}
+	}
+	printf("WB: tilt filter, double %lu cycles/sample, Q15 %lu cycles/sample, max diff %u LSB\n\r",
+	       (unsigned long)(DoubleCycles / BENCH_SAMPLES),
+	       (unsigned long)(FixedCycles / BENCH_SAMPLES), MaxDiff);
+}//End BenchmarkTiltFilter
+#endif
+
+//private StopListening
+//InitWaterBucketService on ES_INIT
+static void StopListening ( ES_Event ThisEvent ) {
+	//Specify that we are not checking for water
+	Listen = false;
+	#if DEBUG_WATER
+	printf("WB: Init water bucket\n\r\n");
+	#endif
+}//End StopListening
+
+//private StartListening
+//Wait4Flip1Done on ES_F1_DONE
+static void StartListening ( ES_Event ThisEvent ) {
+	//Start checking for water, from level and with the first sample going out
+	Tilted = false;
+	SendNext = true;
+	Listen = true;
+}//End StartListening
+
+//private StartVibrating
+//Wait4Water on ES_TILT_ENTER, the bucket tipped far enough to pour
+static void StartVibrating ( ES_Event ThisEvent ) {
+	// Turn on the vibration motor
+	HWREG(GPIO_PORTC_BASE+(GPIO_O_DATA+ALL_BITS)) |= VIB_HI;
+	#if DEBUG_WATER
+		printf("WB: Water!\n\r\n");
+	#endif
+}//End StartVibrating
+
+//private StopVibrating
+//Wait4Water on ES_TILT_EXIT, the bucket came back up
+static void StopVibrating ( ES_Event ThisEvent ) {
+	// Turn off the vibration motor
+	HWREG(GPIO_PORTC_BASE+(GPIO_O_DATA+ALL_BITS)) &= VIB_LO;
+	#if DEBUG_WATER
+		printf("WB: No Water!\n\r\n");
+	#endif
+}//End StopVibrating
+
+//private StopWatering
+//Wait4Water on ES_F2_DONE
+static void StopWatering ( ES_Event ThisEvent ) {
+	// stop checking for water
+	Listen = false;
+	//Turn off the vibration motor
+	HWREG(GPIO_PORTC_BASE+(GPIO_O_DATA+ALL_BITS)) &= VIB_LO;
+	#if DEBUG_WATER
+		printf("WB: Done watering\n\r\n");
+	#endif
+}//End StopWatering
+
+//private ResetWater
+//WaterRunning on ES_RESET
+static void ResetWater ( ES_Event ThisEvent ) {
+	ES_Event Event2Post;
+	//Turn off motor
+	HWREG(GPIO_PORTC_BASE+(GPIO_O_DATA+ALL_BITS)) &= VIB_LO;	
+	// post an ES_DONE_INIT to the MainService
+	Event2Post.EventType = ES_DONE_INIT;
+	PostMainService( Event2Post );
+}//End ResetWater
+
+//private CalibrateRest
+//WaterRunning on ES_NEW_KEY 'r', with the bucket upright
+static void CalibrateRest ( ES_Event ThisEvent ) {
+	//Record the latest tilt as the rest reading
+	if ( !TiltCal_RecordRest( LastTilt ) ) {
+		#if DEBUG_WATER
+		printf("WB: rest reading %u not saved\n\r", LastTilt);
+		#endif
+	}
+}//End CalibrateRest
+
+//private CalibrateFullTilt
+//WaterRunning on ES_NEW_KEY 't', with the bucket tipped all the way
+static void CalibrateFullTilt ( ES_Event ThisEvent ) {
+	//Record the latest tilt as the full tilt reading
+	if ( !TiltCal_RecordFullTilt( LastTilt ) ) {
+		#if DEBUG_WATER
+		printf("WB: full tilt reading %u not saved\n\r", LastTilt);
+		#endif
+	}
+}//End CalibrateFullTilt
 
 //PostWaterBucketService
 bool PostWaterBucketService ( ES_Event ThisEvent ) {
 //Post Event to ES_SERVICES
-	return ES_PostToService( MyPriority, ThisEvent);
+	return ES_QueueStatsPost( MyPriority, ThisEvent);
 }
 
 
@@ -23,5 +23,6 @@ WaterBucketState_t QueryWaterService ( void );
 
 //Event checkers
 bool Check4Water ( void );
+bool Check4CalibrationKey ( void );
 
 #endif /* WATER_BUCKET_H */
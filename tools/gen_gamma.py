@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""Generate the LED gamma table, LEDGamma.h and LEDGamma.c.
+
+The table turns an animator level (0 to 255, perceptually even steps) into
+the LED PWM pulse width in the 0.8uS ticks of PWM8_TIVA_SetPulseWidth. At
+the LEDs' 1000Hz that is 1250 ticks a period, much finer than the 0 to 99
+of PWM8_TIVA_SetDuty, and full brightness is capped at the maximum safe
+duty. Run it from anywhere after changing a setting and commit the output:
+
+    python tools/gen_gamma.py
+    python tools/gen_gamma.py --gamma 2.5 --max-duty 70
+
+LEDService.c checks the frequency and the cap against its own defines.
+"""
+
+import argparse
+import os
+
+HEADER = """\
+/****************************************************************************
+
+  Header file for LEDGamma (perceptual LED level to PWM pulse width)
+
+  Generated by tools/gen_gamma.py {args}
+  Do not edit, run the script again instead.
+
+ ****************************************************************************/
+
+#ifndef LEDGamma_H
+#define LEDGamma_H
+
+#include "ES_Types.h"
+
+// the PWM the table was made for
+#define LED_GAMMA_PWM_FREQ {freq}
+#define LED_GAMMA_PULSE_NS {tick_ns}
+// pulse ticks in a PWM period
+#define LED_GAMMA_PERIOD {period}
+// the table's top entry is this duty, in percent
+#define LED_GAMMA_MAX_DUTY {max_duty}
+#define LED_GAMMA_LEVELS {levels}
+
+// pulse width for each level, in ticks of LED_GAMMA_PULSE_NS
+extern const uint16_t LEDGamma[LED_GAMMA_LEVELS];
+
+#endif /* LEDGamma_H */
+"""
+
+SOURCE = """\
+/****************************************************************************
+ Module
+   LEDGamma.c
+
+ Description
+   Pulse width for each LED level, gamma {gamma}, 0 to {max_pulse} ticks
+   ({max_duty}% of {period}).
+
+ Notes
+   Generated by tools/gen_gamma.py {args}
+   Do not edit, run the script again instead.
+****************************************************************************/
+#include "LEDGamma.h"
+
+const uint16_t LEDGamma[LED_GAMMA_LEVELS] = {{
+{rows}
+}};
+"""
+
+
+def table(levels, gamma, max_pulse):
+    """Pulse widths for levels 0 to levels-1, only 0 is off, never falling."""
+    out = []
+    for level in range(levels):
+        pulse = int(round(max_pulse * (level / (levels - 1)) ** gamma))
+        if level > 0:
+            pulse = max(pulse, 1, out[-1])
+        out.append(pulse)
+    return out
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--gamma', type=float, default=2.2)
+    parser.add_argument('--levels', type=int, default=256)
+    parser.add_argument('--freq', type=int, default=1000,
+                        help='LED PWM frequency, Hz')
+    parser.add_argument('--tick-ns', type=int, default=800,
+                        help='PWM8_TIVA_SetPulseWidth tick, nS')
+    parser.add_argument('--max-duty', type=int, default=70,
+                        help='full brightness duty, percent (MAX_SAFE_PWM_DUTY)')
+    parser.add_argument('--out', default=os.path.join(
+        os.path.dirname(os.path.abspath(__file__)), os.pardir))
+    opts = parser.parse_args()
+
+    period = 1000000000 // (opts.freq * opts.tick_ns)
+    max_pulse = period * opts.max_duty // 100
+    values = table(opts.levels, opts.gamma, max_pulse)
+    args = '--gamma {} --levels {} --freq {} --tick-ns {} --max-duty {}'.format(
+        opts.gamma, opts.levels, opts.freq, opts.tick_ns, opts.max_duty)
+
+    rows = []
+    for start in range(0, len(values), 12):
+        chunk = values[start:start + 12]
+        rows.append('\t' + ', '.join('%4d' % v for v in chunk) + ',')
+    rows[-1] = rows[-1].rstrip(',')
+
+    fields = dict(args=args, freq=opts.freq, tick_ns=opts.tick_ns,
+                  period=period, max_duty=opts.max_duty, levels=opts.levels,
+                  gamma=opts.gamma, max_pulse=max_pulse, rows='\n'.join(rows))
+    # the sources use DOS line endings
+    for name, text in (('LEDGamma.h', HEADER), ('LEDGamma.c', SOURCE)):
+        with open(os.path.join(opts.out, name), 'w', newline='\r\n') as f:
+            f.write(text.format(**fields))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,99 @@
+/****************************************************************************
+ Module
+   spike_bench.c
+
+ Description
+   Host benchmark of SpikeFilter_Step. Build it once per window size from
+   the repository root, with the framework's include directory for
+   ES_Types.h, and run it:
+
+     cc -O2 -DSPIKE_WINDOW=3 -I. -I<framework>/include tools/spike_bench.c SpikeFilter.c -o spike3
+     cc -O2 -DSPIKE_WINDOW=5 -I. -I<framework>/include tools/spike_bench.c SpikeFilter.c -o spike5
+     cc -O2 -DSPIKE_WINDOW=7 -I. -I<framework>/include tools/spike_bench.c SpikeFilter.c -o spike7
+
+ Notes
+   Cycles come from the time stamp counter on x86, elsewhere the time per
+   sample is printed in nS. The readings are made up the same way as the
+   tilt filter benchmark in WaterBucketService.c, with a spike every 50
+   samples, and the benchmark checks that no spike gets through.
+****************************************************************************/
+/*----------------------------- Include Files -----------------------------*/
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "SpikeFilter.h"
+
+/*----------------------------- Module Defines ----------------------------*/
+#define NUM_SAMPLES 4096
+#define NUM_RUNS    1000
+#define SPIKE_EVERY 50
+#define SPIKE_SIZE  1500
+#define MAX_STEP    32
+
+/*---------------------------- Module Variables ---------------------------*/
+static int32_t Samples[NUM_SAMPLES];
+static volatile int32_t Sink;
+
+/*------------------------------ Module Code ------------------------------*/
+static unsigned long long Now ( void )
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec Time;
+	clock_gettime( CLOCK_MONOTONIC, &Time );
+	return (unsigned long long)Time.tv_sec * 1000000000ull + Time.tv_nsec;
+#endif
+}
+
+int main ( void )
+{
+	SpikeFilter_t Filter;
+	unsigned long long Start, Best = ~0ull;
+	uint32_t Seed = 12345;
+	int32_t MaxOut = 0;
+	int Run, i;
+
+	//readings over the whole 1800 to 2600 range, some noise and spikes
+	for ( i = 0; i < NUM_SAMPLES; i++ ) {
+		Seed = Seed * 1103515245 + 12345;
+		Samples[i] = 1800 + (i * 800) / NUM_SAMPLES + ((Seed >> 16) % 64);
+		if ( (i % SPIKE_EVERY) == SPIKE_EVERY - 1 ) {
+			Samples[i] += SPIKE_SIZE;
+		}
+	}
+
+	//best of the runs, so the time is the filter's and not the host's
+	for ( Run = 0; Run < NUM_RUNS; Run++ ) {
+		SpikeFilter_Init( &Filter, MAX_STEP, Samples[0] );
+		Start = Now();
+		for ( i = 0; i < NUM_SAMPLES; i++ ) {
+			Sink = SpikeFilter_Step( &Filter, Samples[i] );
+		}
+		Start = Now() - Start;
+		if ( Start < Best ) {
+			Best = Start;
+		}
+	}
+
+	//nothing near a spike should come out
+	SpikeFilter_Init( &Filter, MAX_STEP, Samples[0] );
+	for ( i = 0; i < NUM_SAMPLES; i++ ) {
+		int32_t Out = SpikeFilter_Step( &Filter, Samples[i] );
+		if ( Out > MaxOut ) {
+			MaxOut = Out;
+		}
+	}
+
+#if defined(__x86_64__) || defined(__i386__)
+	printf("SPIKE_WINDOW %d: %.1f cycles/sample", SPIKE_WINDOW, (double)Best / NUM_SAMPLES);
+#else
+	printf("SPIKE_WINDOW %d: %.1f nS/sample", SPIKE_WINDOW, (double)Best / NUM_SAMPLES);
+#endif
+	printf(", largest output %ld%s\n", (long)MaxOut,
+	       (MaxOut > 2600 + 64) ? " (SPIKE GOT THROUGH)" : "");
+	return (MaxOut > 2600 + 64);
+}
@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""Decode an ES_Trace dump into a timeline.
+
+Save the serial output that contains the dump (everything between the
+"TRACE <n>" and "END TRACE" lines printed by ES_TraceDump) to a file, then
+
+    python tools/trace_decode.py dump.txt
+
+The event, service, state and soft timer names are read from ES_Configure.h
+and the service headers, so the tool keeps up with the source as it changes.
+Use --src if the source is not in the parent directory of this script.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+# ES_TraceKind_t in ES_Trace.h
+POST, REJECT, DEQUEUE, FETCH, STATE, TIMER, SPIN = range(1, 8)
+KIND_NAMES = {POST: 'post', REJECT: 'REJECT', DEQUEUE: 'run', FETCH: 'fetch',
+              STATE: 'state', TIMER: 'timer', SPIN: 'spin'}
+NO_SERVICE = 0xff
+
+
+def strip_comments(text):
+    text = re.sub(r'/\*.*?\*/', '', text, flags=re.S)
+    return re.sub(r'//[^\n]*', '', text)
+
+
+def parse_enum(body):
+    """Names of a C enum body in order of value, as a {value: name} dict."""
+    names = {}
+    value = -1
+    for item in body.split(','):
+        item = item.strip()
+        if not item:
+            continue
+        if '=' in item:
+            name, expr = [part.strip() for part in item.split('=', 1)]
+            value = int(expr, 0)
+        else:
+            name = item
+            value += 1
+        names[value] = name
+    return names
+
+
+def find_enum(text, type_name=None):
+    """The typedef enum called type_name, or the first one in text."""
+    for match in re.finditer(r'typedef\s+enum\s*\{(.*?)\}\s*(\w+)\s*;', text, re.S):
+        if type_name is None or match.group(2) == type_name:
+            return parse_enum(match.group(1))
+    return {}
+
+
+def load_names(src):
+    with open(os.path.join(src, 'ES_Configure.h')) as f:
+        config = strip_comments(f.read())
+    defines = dict(re.findall(r'#define\s+(\w+)[ \t]+((?:[^\n\\]|\\\n)*)', config))
+
+    events = find_enum(config, 'ES_EventTyp_t')
+
+    num_services = int(defines['NUM_SERVICES'])
+    services = {}
+    states = {}
+    for n in range(num_services):
+        run = defines.get('SERV_%d_RUN' % n, 'Service%d' % n).strip()
+        services[n] = run[3:] if run.startswith('Run') else run
+        header = defines.get('SERV_%d_HEADER' % n, '').strip().strip('"')
+        path = os.path.join(src, header)
+        if header and os.path.exists(path):
+            with open(path) as f:
+                states[n] = find_enum(strip_comments(f.read()))
+
+    # soft timers are numbered in SOFT_TIMER_LIST order from 16
+    timers = {}
+    number = 16
+    for part in defines.get('SOFT_TIMER_LIST', '').replace('\\', ' ').split():
+        for name in re.findall(r'SOFT_TIMER\(\s*(\w+)', defines.get(part, '')):
+            timers[number] = name
+            number += 1
+    return events, services, states, timers
+
+
+def read_dump(path):
+    """The records of the last complete dump in the file."""
+    records = None
+    dumps = []
+    with open(path, errors='replace') as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith('TRACE'):
+                records = []
+            elif line == 'END TRACE':
+                if records is not None:
+                    dumps.append(records)
+                records = None
+            elif records is not None and line:
+                fields = [int(x, 16) for x in line.split()]
+                if len(fields) == 5:
+                    records.append(fields)
+    if not dumps:
+        sys.exit('%s: no complete TRACE ... END TRACE dump found' % path)
+    return dumps[-1]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('dump', help='serial log containing an ES_TraceDump')
+    parser.add_argument('--src', default=os.path.join(os.path.dirname(
+        os.path.abspath(__file__)), os.pardir),
+        help='directory with ES_Configure.h and the service headers')
+    args = parser.parse_args()
+
+    events, services, states, timers = load_names(args.src)
+    records = read_dump(args.dump)
+
+    def event_name(kind_type, param):
+        name = events.get(kind_type, 'event%d' % kind_type)
+        if name == 'ES_TIMEOUT' and param in timers:
+            return '%s(%s)' % (name, timers[param])
+        return '%s(%d)' % (name, param)
+
+    def state_name(service, value):
+        return states.get(service, {}).get(value, str(value))
+
+    # the time is 16 bit ms, unwrap it so the timeline keeps counting up
+    start = None
+    last = 0
+    offset = 0
+    for time, kind, service, kind_type, param in records:
+        if start is None:
+            start = time
+            last = time
+        if time < last:
+            offset += 0x10000
+        last = time
+        elapsed = time + offset - start
+
+        who = 'timers' if service == NO_SERVICE else \
+            services.get(service, 'service%d' % service)
+        if kind == STATE:
+            what = '%s -> %s' % (state_name(service, kind_type),
+                                 state_name(service, param))
+        elif kind == TIMER:
+            what = '%s expired, %d ms late' % (
+                timers.get(kind_type, 'timer%d' % kind_type), param)
+        elif kind == SPIN:
+            error = param - 0x10000 if param & 0x8000 else param
+            what = 'revolution %d ms, %+d ms off target' % (kind_type, error)
+        else:
+            what = event_name(kind_type, param)
+        print('%8d ms  %-6s %-22s %s' % (elapsed, KIND_NAMES.get(kind, '?%d' % kind),
+                                         who, what))
+
+
+if __name__ == '__main__':
+    main()